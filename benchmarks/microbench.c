@@ -0,0 +1,518 @@
+/*
+   File: microbench.c
+   Author: Daniel Gonçalves
+   Date: 2026-10-18
+   Description: Microbenchmarks of the hot kernels of the simulator. Each kernel is timed in isolation, on a synthetic environment (walls, pillars, exits and pedestrians inserted with a fixed seed), after warm-up repetitions. The inputs changed by a kernel are restored before each repetition, outside the timed region. The median and the percentiles of the repetitions are reported. Built and run by varas_microbench.sh.
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<stdint.h>
+#include<stdbool.h>
+
+#include"../headers/cell.h"
+#include"../headers/exit.h"
+#include"../headers/grid.h"
+#include"../headers/profile.h"
+#include"../headers/pedestrian.h"
+#include"../headers/initialization.h"
+#include"../headers/cli_processing.h"
+#include"../headers/shared_resources.h"
+
+#define MICROBENCH_ENVIRONMENT "microbench_environment.txt" // Written in the environments directory by the load_environment kernel.
+#define PILLAR_SPACING 16 // Lines and columns between the 2 x 2 pillars of the synthetic environment.
+#define SLOW_KERNEL_DIVISOR 10 // The floor field kernels run --repetitions / SLOW_KERNEL_DIVISOR times (at least 3).
+
+enum Item_Kind {ITEMS_PEDESTRIANS, ITEMS_CELLS};
+
+typedef struct{
+    const char *name;
+    enum Item_Kind item_kind; // Items processed by a repetition, for the time per item.
+    bool is_slow;
+    void (*prepare)(); // Restores the inputs of the kernel before each repetition (not timed). May be NULL.
+    Function_Status (*run)();
+}Kernel;
+
+typedef struct{
+    int lines;
+    int columns;
+    int num_pedestrians;
+    int num_exits;
+    int repetitions;
+    int warm_up;
+    int seed;
+    const char *kernel_filter; // Only the kernels whose name contains this string are run.
+    const char *csv_filename; // The results are also appended to this file, or NULL.
+}Microbench_Options;
+
+static Microbench_Options options = {256, 256, 3000, 4, 50, 5, 1, NULL, NULL};
+
+static struct pedestrian *pedestrian_snapshot = NULL; // States of the pedestrians after their movements were evaluated.
+static Double_Grid merge_destination = NULL;
+static volatile long kernel_sink = 0; // Keeps the results of the kernels from being discarded.
+
+static Function_Status parse_options(int argc, char **argv);
+static Function_Status build_synthetic_inputs();
+static Function_Status write_environment_file();
+static void restore_pedestrians();
+static void restore_merge_destination();
+static Function_Status run_find_smallest_cell();
+static Function_Status run_iterative_floor_field();
+static Function_Status run_dijkstra_floor_field();
+static Function_Status run_floor_field_merge();
+static Function_Status run_identify_conflicts();
+static Function_Status run_block_X_movement();
+static Function_Status run_update_position_grid();
+static Function_Status run_load_environment();
+static Function_Status time_kernel(const Kernel *kernel, FILE *csv_file);
+static int compare_durations(const void *first, const void *second);
+static double get_percentile(uint64_t *sorted_durations, int num_durations, double percentile);
+
+static const Kernel kernels[] = {
+    {"find_smallest_cell", ITEMS_PEDESTRIANS, false, NULL, run_find_smallest_cell},
+    {"exit_floor_field_iterative", ITEMS_CELLS, true, NULL, run_iterative_floor_field},
+    {"exit_floor_field_dijkstra", ITEMS_CELLS, true, NULL, run_dijkstra_floor_field},
+    {"floor_field_merge", ITEMS_CELLS, false, restore_merge_destination, run_floor_field_merge},
+    {"identify_pedestrian_conflicts", ITEMS_PEDESTRIANS, false, NULL, run_identify_conflicts},
+    {"block_X_movement", ITEMS_PEDESTRIANS, false, restore_pedestrians, run_block_X_movement},
+    {"update_pedestrian_position_grid", ITEMS_PEDESTRIANS, false, NULL, run_update_position_grid},
+    {"load_environment", ITEMS_CELLS, false, NULL, run_load_environment}
+};
+
+int main(int argc, char **argv)
+{
+    if(parse_options(argc, argv) == FAILURE)
+        return END_PROGRAM;
+
+    if(build_synthetic_inputs() == FAILURE)
+        return END_PROGRAM;
+
+    FILE *csv_file = NULL;
+    if(options.csv_filename != NULL)
+    {
+        csv_file = fopen(options.csv_filename, "a");
+        if(csv_file == NULL)
+        {
+            fprintf(stderr, "It was not possible to open the CSV file: %s.\n", options.csv_filename);
+            return END_PROGRAM;
+        }
+    }
+
+    printf("Microbenchmarks on a %d x %d environment, with %d pedestrians and %d exits (seed %d).\n", options.lines, options.columns,
+           pedestrian_set.num_pedestrians, exits_set.num_exits, options.seed);
+    printf("%-32s %6s %12s %12s %12s %12s %12s %12s\n", "kernel", "reps", "median (us)", "p10 (us)", "p90 (us)", "p99 (us)", "min (us)", "ns/item");
+
+    for(size_t kernel_index = 0; kernel_index < sizeof(kernels) / sizeof(Kernel); kernel_index++)
+    {
+        if(options.kernel_filter != NULL && strstr(kernels[kernel_index].name, options.kernel_filter) == NULL)
+            continue;
+
+        if(time_kernel(&kernels[kernel_index], csv_file) == FAILURE)
+        {
+            fprintf(stderr, "The kernel %s failed.\n", kernels[kernel_index].name);
+            return END_PROGRAM;
+        }
+    }
+
+    if(csv_file != NULL)
+        fclose(csv_file);
+
+    free(pedestrian_snapshot);
+    deallocate_grid((void **) merge_destination, cli_args.global_line_number);
+    deallocate_timestep_structures();
+    deallocate_pedestrians();
+    deallocate_exits();
+    deallocate_grid((void **) environment_only_grid, cli_args.global_line_number);
+    deallocate_grid((void **) pedestrian_position_grid, cli_args.global_line_number);
+    deallocate_grid((void **) heatmap_grid, cli_args.global_line_number);
+
+    return END_PROGRAM;
+}
+
+/* ---------------- ---------------- ---------------- ---------------- ---------------- */
+/* ---------------- ---------------- STATIC FUNCTIONS ---------------- ---------------- */
+/* ---------------- ---------------- ---------------- ---------------- ---------------- */
+
+/**
+ * Reads the options of the microbenchmarks, given as --name=value.
+ *
+ * @param argc Number of arguments.
+ * @param argv Arguments of the program.
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+*/
+static Function_Status parse_options(int argc, char **argv)
+{
+    for(int argument_index = 1; argument_index < argc; argument_index++)
+    {
+        char *argument = argv[argument_index];
+        char *value = strchr(argument, '=');
+        if(value == NULL)
+        {
+            fprintf(stderr, "Invalid argument: %s. The options are given as --name=value.\n", argument);
+            return FAILURE;
+        }
+        value++;
+
+        if(strncmp(argument, "--lines=", 8) == 0)
+            options.lines = atoi(value);
+        else if(strncmp(argument, "--columns=", 10) == 0)
+            options.columns = atoi(value);
+        else if(strncmp(argument, "--pedestrians=", 14) == 0)
+            options.num_pedestrians = atoi(value);
+        else if(strncmp(argument, "--exits=", 8) == 0)
+            options.num_exits = atoi(value);
+        else if(strncmp(argument, "--repetitions=", 14) == 0)
+            options.repetitions = atoi(value);
+        else if(strncmp(argument, "--warm-up=", 10) == 0)
+            options.warm_up = atoi(value);
+        else if(strncmp(argument, "--seed=", 7) == 0)
+            options.seed = atoi(value);
+        else if(strncmp(argument, "--kernel=", 9) == 0)
+            options.kernel_filter = value;
+        else if(strncmp(argument, "--csv=", 6) == 0)
+            options.csv_filename = value;
+        else
+        {
+            fprintf(stderr, "Unknown option: %s.\n", argument);
+            return FAILURE;
+        }
+    }
+
+    if(options.lines < 8 || options.columns < 8 || options.repetitions < 1 || options.warm_up < 0 || options.num_exits < 1)
+    {
+        fprintf(stderr, "The environment must have at least 8 x 8 cells and one exit, with at least one repetition.\n");
+        return FAILURE;
+    }
+
+    // Exits of 2 cells, alternating between the top and bottom walls, must fit between the corners.
+    if(options.num_exits > options.columns - 4)
+    {
+        fprintf(stderr, "At most %d exits fit in an environment with %d columns.\n", options.columns - 4, options.columns);
+        return FAILURE;
+    }
+
+    // The pedestrians are inserted at random, so a free cell must be easy to find.
+    long floor_cells = (long) (options.lines - 2) * (options.columns - 2);
+    if(options.num_pedestrians < 1 || options.num_pedestrians > floor_cells / 2)
+    {
+        fprintf(stderr, "The number of pedestrians must be between 1 and %ld (half of the floor cells).\n", floor_cells / 2);
+        return FAILURE;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * Creates the synthetic environment (walls at the edges and 2 x 2 pillars every PILLAR_SPACING cells), its exits (2 cells each,
+ * spread over the top and bottom walls) and the pedestrians, whose movements are evaluated once, so every kernel gets the
+ * inputs it would get during a timestep.
+ *
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+*/
+static Function_Status build_synthetic_inputs()
+{
+    cli_args.global_line_number = options.lines;
+    cli_args.global_column_number = options.columns;
+    cli_args.environment_origin = AUTOMATIC_CREATED;
+    cli_args.exit_fields_mode = EXIT_FIELDS_KEEP; // The floor field of each exit is recalculated and merged by the kernels.
+    cli_args.total_num_pedestrians = options.num_pedestrians;
+    cli_args.seed = options.seed;
+
+    if(generate_environment() == FAILURE)
+        return FAILURE;
+
+    for(int i = PILLAR_SPACING / 2; i < options.lines - 2; i += PILLAR_SPACING)
+    {
+        for(int h = PILLAR_SPACING / 2; h < options.columns - 2; h += PILLAR_SPACING)
+        {
+            environment_only_grid[i][h] = environment_only_grid[i][h + 1] = CELL_WALL;
+            environment_only_grid[i + 1][h] = environment_only_grid[i + 1][h + 1] = CELL_WALL;
+        }
+    }
+
+    int top_exits = (options.num_exits + 1) / 2;
+    for(int exit_index = 0; exit_index < options.num_exits; exit_index++)
+    {
+        int wall = exit_index % 2;
+        int wall_exits = wall == 0 ? top_exits : options.num_exits - top_exits;
+        int line = wall == 0 ? 0 : options.lines - 1;
+        int column = (exit_index / 2 + 1) * options.columns / (wall_exits + 1);
+        column = column < 1 ? 1 : column > options.columns - 3 ? options.columns - 3 : column;
+
+        if(add_new_exit((Location){line, column}) == FAILURE)
+            return FAILURE;
+        if(expand_exit(exits_set.list[exits_set.num_exits - 1], (Location){line, column + 1}) == FAILURE)
+            return FAILURE;
+    }
+
+    if(calculate_final_floor_field() != SUCCESS)
+    {
+        fprintf(stderr, "The floor field of the synthetic environment could not be calculated.\n");
+        return FAILURE;
+    }
+
+    srand(options.seed);
+    if(insert_pedestrians_at_random(options.num_pedestrians) == FAILURE)
+        return FAILURE;
+
+    evaluate_pedestrians_movements();
+    determine_pedestrians_in_panic();
+
+    pedestrian_snapshot = malloc(sizeof(struct pedestrian) * pedestrian_set.num_pedestrians);
+    merge_destination = allocate_double_grid(options.lines, options.columns);
+    if(pedestrian_snapshot == NULL || merge_destination == NULL)
+    {
+        fprintf(stderr, "Failure in the allocation of the inputs of the microbenchmarks.\n");
+        return FAILURE;
+    }
+
+    for(int p_index = 0; p_index < pedestrian_set.num_pedestrians; p_index++)
+        pedestrian_snapshot[p_index] = *pedestrian_set.list[p_index];
+
+    return write_environment_file();
+}
+
+/**
+ * Writes the synthetic environment, with its exits and pedestrians, to the environments directory, to be read by the
+ * load_environment kernel.
+ *
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+*/
+static Function_Status write_environment_file()
+{
+    char complete_path[300];
+    sprintf(complete_path, "environments/%s", MICROBENCH_ENVIRONMENT);
+
+    FILE *environment_file = fopen(complete_path, "w");
+    if(environment_file == NULL)
+    {
+        fprintf(stderr, "It was not possible to write the environment file of the microbenchmarks.\n");
+        return FAILURE;
+    }
+
+    fprintf(environment_file, "%d %d\n", options.lines, options.columns);
+    for(int i = 0; i < options.lines; i++)
+    {
+        for(int h = 0; h < options.columns; h++)
+        {
+            char symbol = environment_only_grid[i][h] == CELL_WALL ? '#' : pedestrian_position_grid[i][h] > 0 ? 'p' : '.';
+            if(exits_set.cell_types[i][h] == CELL_EXIT)
+                symbol = '_';
+            fputc(symbol, environment_file);
+        }
+        fputc('\n', environment_file);
+    }
+
+    fclose(environment_file);
+
+    return SUCCESS;
+}
+
+/**
+ * Restores the pedestrians to their states after the evaluation of the movements, and the seed of the random draws.
+*/
+static void restore_pedestrians()
+{
+    for(int p_index = 0; p_index < pedestrian_set.num_pedestrians; p_index++)
+        *pedestrian_set.list[p_index] = pedestrian_snapshot[p_index];
+
+    srand(options.seed);
+}
+
+/**
+ * Restores the destination of the merge to the floor field of the first exit.
+*/
+static void restore_merge_destination()
+{
+    copy_double_grid(merge_destination, exits_set.list[0]->floor_field);
+}
+
+/**
+ * Chooses the target cell of every pedestrian, as evaluate_pedestrians_movements does.
+*/
+static Function_Status run_find_smallest_cell()
+{
+    long sum = 0;
+    for(int p_index = 0; p_index < pedestrian_set.num_pedestrians; p_index++)
+    {
+        Cell target = find_smallest_cell(pedestrian_set.list[p_index]->current, ! cli_args.always_move_to_lowest);
+        sum += target.coordinates.lin + target.coordinates.col;
+    }
+    kernel_sink += sum;
+
+    return SUCCESS;
+}
+
+/**
+ * Calculates the floor field of the first exit with the iterative solver.
+*/
+static Function_Status run_iterative_floor_field()
+{
+    cli_args.floor_field_solver = SOLVER_ITERATIVE;
+    return recalculate_exit_floor_field(exits_set.list[0]) == SUCCESS ? SUCCESS : FAILURE;
+}
+
+/**
+ * Calculates the floor field of the first exit with the Dijkstra solver.
+*/
+static Function_Status run_dijkstra_floor_field()
+{
+    cli_args.floor_field_solver = SOLVER_DIJKSTRA;
+    return recalculate_exit_floor_field(exits_set.list[0]) == SUCCESS ? SUCCESS : FAILURE;
+}
+
+/**
+ * Merges the floor field of the last exit into the floor field of the first one, as calculate_final_floor_field does.
+*/
+static Function_Status run_floor_field_merge()
+{
+    return merge_minimum_double_grid(merge_destination, exits_set.list[exits_set.num_exits - 1]->floor_field);
+}
+
+/**
+ * Finds the cells targeted by more than one pedestrian. The pedestrians aren't changed, so no restore is needed.
+*/
+static Function_Status run_identify_conflicts()
+{
+    Cell_Conflict pedestrian_conflicts = NULL;
+    int num_conflicts = 0;
+
+    if(identify_pedestrian_conflicts(&pedestrian_conflicts, &num_conflicts) == FAILURE)
+        return FAILURE;
+    kernel_sink += num_conflicts;
+
+    return SUCCESS;
+}
+
+/**
+ * Solves the X movements between adjacent pedestrians.
+*/
+static Function_Status run_block_X_movement()
+{
+    return block_X_movement();
+}
+
+/**
+ * Writes the positions of all pedestrians in the pedestrian_position_grid (and in the heatmap_grid).
+*/
+static Function_Status run_update_position_grid()
+{
+    update_pedestrian_position_grid();
+    return SUCCESS;
+}
+
+/**
+ * Reads the environment file written by write_environment_file (only its structure), including the allocation of the grids.
+ * The grids of the synthetic environment are kept aside and the ones created by the load are released.
+*/
+static Function_Status run_load_environment()
+{
+    Byte_Grid synthetic_environment = environment_only_grid;
+    Int_Grid synthetic_positions = pedestrian_position_grid;
+    Int_Grid synthetic_heatmap = heatmap_grid;
+
+    cli_args.environment_origin = ONLY_STRUCTURE;
+    strcpy(cli_args.environment_filename, MICROBENCH_ENVIRONMENT);
+
+    Function_Status returned_status = load_environment();
+
+    // The release is timed too, but it is small next to the parsing.
+    deallocate_grid((void **) environment_only_grid, cli_args.global_line_number);
+    deallocate_grid((void **) pedestrian_position_grid, cli_args.global_line_number);
+    deallocate_grid((void **) heatmap_grid, cli_args.global_line_number);
+
+    environment_only_grid = synthetic_environment;
+    pedestrian_position_grid = synthetic_positions;
+    heatmap_grid = synthetic_heatmap;
+    cli_args.environment_origin = AUTOMATIC_CREATED;
+
+    return returned_status;
+}
+
+/**
+ * Runs the warm-up and the timed repetitions of a kernel, and prints the distribution of their durations.
+ *
+ * @param kernel Kernel to be timed.
+ * @param csv_file File where a line with the results is appended, or NULL.
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+*/
+static Function_Status time_kernel(const Kernel *kernel, FILE *csv_file)
+{
+    int repetitions = options.repetitions;
+    int warm_up = options.warm_up;
+    if(kernel->is_slow)
+    {
+        repetitions = repetitions / SLOW_KERNEL_DIVISOR < 3 ? 3 : repetitions / SLOW_KERNEL_DIVISOR;
+        warm_up = warm_up > 0 ? 1 : 0;
+    }
+
+    uint64_t *durations = malloc(sizeof(uint64_t) * repetitions);
+    if(durations == NULL)
+        return FAILURE;
+
+    for(int repetition = -warm_up; repetition < repetitions; repetition++)
+    {
+        if(kernel->prepare != NULL)
+            kernel->prepare();
+
+        uint64_t start = read_profile_clock();
+        Function_Status returned_status = kernel->run();
+        uint64_t end = read_profile_clock();
+
+        if(returned_status == FAILURE)
+        {
+            free(durations);
+            return FAILURE;
+        }
+
+        if(repetition >= 0)
+            durations[repetition] = end - start;
+    }
+
+    restore_pedestrians(); // The next kernel gets the original inputs.
+    qsort(durations, repetitions, sizeof(uint64_t), compare_durations);
+
+    long items = kernel->item_kind == ITEMS_PEDESTRIANS ? pedestrian_set.num_pedestrians : (long) options.lines * options.columns;
+    double median = get_percentile(durations, repetitions, 50);
+
+    printf("%-32s %6d %12.1lf %12.1lf %12.1lf %12.1lf %12.1lf %12.2lf\n", kernel->name, repetitions, median / 1e3,
+           get_percentile(durations, repetitions, 10) / 1e3, get_percentile(durations, repetitions, 90) / 1e3,
+           get_percentile(durations, repetitions, 99) / 1e3, durations[0] / 1e3, median / items);
+
+    if(csv_file != NULL)
+        fprintf(csv_file, "%s,%d,%d,%d,%d,%d,%.1lf,%.1lf,%.1lf,%.1lf,%.1lf,%.3lf\n", kernel->name, options.lines, options.columns,
+                pedestrian_set.num_pedestrians, exits_set.num_exits, repetitions, median / 1e3, get_percentile(durations, repetitions, 10) / 1e3,
+                get_percentile(durations, repetitions, 90) / 1e3, get_percentile(durations, repetitions, 99) / 1e3, durations[0] / 1e3, median / items);
+
+    free(durations);
+
+    return SUCCESS;
+}
+
+/**
+ * Compares two durations, for qsort.
+*/
+static int compare_durations(const void *first, const void *second)
+{
+    uint64_t first_duration = *(const uint64_t *) first, second_duration = *(const uint64_t *) second;
+    return (first_duration > second_duration) - (first_duration < second_duration);
+}
+
+/**
+ * Calculates a percentile of the durations, interpolating between the two closest ranks.
+ *
+ * @param sorted_durations Durations, in ascending order.
+ * @param num_durations Number of durations.
+ * @param percentile Percentile, between 0 and 100.
+ * @return The percentile, in nanoseconds.
+*/
+static double get_percentile(uint64_t *sorted_durations, int num_durations, double percentile)
+{
+    double rank = percentile / 100 * (num_durations - 1);
+    int lower = (int) rank;
+    if(lower >= num_durations - 1)
+        return sorted_durations[num_durations - 1];
+
+    return sorted_durations[lower] + (rank - lower) * ((double) sorted_durations[lower + 1] - sorted_durations[lower]);
+}
@@ -0,0 +1,28 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include<stddef.h>
+
+#include"memory.h"
+
+typedef struct arena_block Arena_Block;
+
+// Bump allocator made of a chain of blocks. Resetting it makes all its memory available again in O(1), without calling the
+// allocator, so structures rebuilt at every simulation set or simulation don't churn malloc and free.
+typedef struct{
+    Arena_Block *first;
+    Arena_Block *current; // Block where the next allocation is tried. The blocks after it are reused before new ones are created.
+    void *last_allocation; // Can grow in place in arena_reallocate.
+    enum Memory_Subsystem subsystem; // Subsystem to which the blocks are attributed by the memory report.
+}Arena;
+
+void *arena_allocate(Arena *arena, size_t size);
+void *arena_allocate_zeroed(Arena *arena, size_t size);
+void *arena_reallocate(Arena *arena, void *old_allocation, size_t old_size, size_t new_size);
+void reset_arena(Arena *arena);
+void deallocate_arena(Arena *arena);
+
+extern Arena set_arena;
+extern Arena replica_arena;
+
+#endif
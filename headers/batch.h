@@ -0,0 +1,12 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include<stdio.h>
+
+#include"shared_resources.h"
+
+#define MAX_BATCH_LANES 64
+
+Function_Status run_batched_simulations(FILE *output_file);
+
+#endif
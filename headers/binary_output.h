@@ -0,0 +1,42 @@
+#ifndef BINARY_OUTPUT_H
+#define BINARY_OUTPUT_H
+
+#include<stdio.h>
+#include<stdbool.h>
+
+#include"shared_resources.h"
+
+/* Binary output (--output-format 4), in the byte order of the machine. Every field is a 32-bit integer, unless noted.
+   Header: BINARY_MAGIC (8 bytes), BINARY_VERSION, flags (Binary_Flags), lines, columns, simulations per set, length of the
+   command, the command as printed in the header of the text outputs (without a terminating null character) and the hash of
+   the environment structure (64 bits, FNV-1a over the cell types, line by line).
+   Then, one record per simulation set: BINARY_RECORD_SET, position of the set in the auxiliary file (1 without one), 1 if an
+   exit is inaccessible (0 otherwise), number of exits, the width of each exit followed by the line and column of its cells,
+   number of replicas (0 for inaccessible sets), the timesteps of each replica and, for accessible sets, the heatmap (visits
+   of each cell, summed over the replicas, line by line) in blocks of HEATMAP_BLOCK_CELLS cells (the last block may be
+   shorter). Each block has its Block_Encoding, the number of integers that follow and the integers: the visits of each cell
+   (BLOCK_RAW) or pairs of run length and visits of the cells of the run (BLOCK_RUNS). */
+
+#define BINARY_MAGIC "VARASBIN"
+#define BINARY_MAGIC_LENGTH 8
+#define BINARY_VERSION 1
+#define BINARY_RECORD_SET 1
+#define HEATMAP_BLOCK_CELLS 4096
+
+enum Binary_Flags {
+    BINARY_COMPRESSED = 1, // Heatmap blocks are stored as runs when it makes them smaller (--compress-output).
+    BINARY_SIMULATION_SET_INFO = 2, // --simulation-set-info was given.
+    BINARY_SINGLE_EXIT_FLAG = 4 // --single-exit-flag was given.
+};
+
+enum Block_Encoding {
+    BLOCK_RAW = 0,
+    BLOCK_RUNS
+};
+
+Function_Status start_binary_output(FILE *output_file);
+void record_binary_timesteps(int timesteps);
+Function_Status write_binary_set(FILE *output_file, int set_position, bool is_inaccessible);
+void finish_binary_output();
+
+#endif
@@ -16,5 +16,6 @@ typedef struct cell_list{
 }cell_list;
 
 Cell find_smallest_cell(Location ped_coordinates, bool unoccupied_only);
+int get_floor_field_neighborhood(Location center, double floor_field_values[3][3]);
 
 #endif
\ No newline at end of file
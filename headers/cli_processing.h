@@ -11,8 +11,21 @@ typedef struct{
     char environment_filename[150];
     char output_filename[150];
     char auxiliary_filename[150];
+    char grid_directory[150];
+    char profile_filename[150]; // Empty when the profile report is written to stderr.
+    char work_counters_filename[150]; // Empty when the work counters are written to stderr.
+    char trace_filename[150];
+    char telemetry_filename[150]; // Empty when the telemetry is written to stderr.
+    char status_filename[150];
+    char mem_report_filename[150]; // Empty when the memory report is written to stderr.
+    char saved_environment_filename[150];
     enum Output_Format output_format;
     enum Environment_Origin environment_origin;
+    enum Environment_Layout environment_layout;
+    enum Floor_Field_Solver floor_field_solver;
+    enum Grid_Backend grid_backend;
+    enum Grid_Layout grid_layout;
+    enum Exit_Fields_Mode exit_fields_mode;
     bool write_to_file;
     bool show_debug_information;
     bool show_simulation_set_info;
@@ -22,12 +35,30 @@ typedef struct{
     bool allow_X_movement;
     bool single_exit_flag;
     bool varas_fig7;
+    bool profile;
+    bool perf_counters;
+    bool work_counters;
+    bool trace;
+    bool telemetry;
+    bool mem_report;
+    bool mem_report_sets;
+    bool save_environment;
+    bool compress_output;
     int global_line_number;
     int global_column_number;
     int num_simulations;
     int total_num_pedestrians;
     int seed;
+    int layout_seed;
+    int batch_lanes;
+    int num_threads;
+    int first_set; // Range of simulation sets of the auxiliary file run with --sets, starting at 1 (0 when all sets are run).
+    int last_set;
+    int reorder_interval; // Timesteps between reorders of the pedestrians in the parallel engine.
+    int trace_interval; // Timesteps between the timesteps whose phases are written to the trace.
     double diagonal;
+    double obstacle_density; // Probability of each cell being an obstacle in --env-layout 4.
+    double telemetry_interval; // Seconds between the refreshes of the telemetry.
 } Command_Line_Args;
 
 error_t parser_function(int key, char *arg, struct argp_state *state);
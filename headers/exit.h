@@ -4,22 +4,43 @@
 #include"shared_resources.h"
 #include"grid.h"
 
+enum Run_Kind {RUN_WALLS, RUN_UNREACHABLE, RUN_VALUES};
+
+// Floor field of an exit compressed in runs (in line by line order) of walls, unreachable cells or cells with values. 
+// Only the cells of RUN_VALUES runs are stored, quantized to single precision.
+typedef struct{
+    int num_runs;
+    int *run_lengths;
+    unsigned char *run_kinds; // enum Run_Kind of each run.
+    long num_values;
+    float *values;
+}Compressed_Floor_Field;
+
 struct exit {
     int width; // in contiguous cells
     Location *coordinates; // cells that form up the exit
-    Double_Grid floor_field;
+    Double_Grid floor_field; // Distances to the exit (INFINITY in walls and 0.0 in unreachable cells). NULL after the merge, unless --exit-fields is 1 (keep).
+    Compressed_Floor_Field *compressed_floor_field; // Only with --exit-fields 3 (compress).
 };
 typedef struct exit * Exit;
 
 typedef struct{
     Double_Grid final_floor_field; // Floor field obtained by combining the floor fields of each door
-    Exit *list;
+    Tiled_Double_Grid *tiled_final_floor_field; // Copy of final_floor_field read by the neighborhood scans with --grid-layout 2.
+    Byte_Grid cell_types; // enum Cell_Type of each cell: the environment_only_grid with the exits. Rebuilt for each simulation set.
+    Byte_Grid movement_masks; // Neighbors each pedestrian can step to from each cell (see build_movement_masks). Rebuilt with cell_types.
+    Exit *list; // Allocated in the set_arena.
     int num_exits;
+    int capacity; // Number of positions allocated in list. Grows geometrically.
 } Exits_Set;
 
 Function_Status add_new_exit(Location exit_coordinates);
 Function_Status expand_exit(Exit original_exit, Location new_coordinates);
 Function_Status calculate_final_floor_field();
+Function_Status recalculate_exit_floor_field(Exit current_exit);
+Function_Status check_exits_accessibility();
+Function_Status get_exit_floor_field(Exit current_exit, Double_Grid destination);
+void reset_exits();
 void deallocate_exits();
 
 extern Exits_Set exits_set;
@@ -2,23 +2,105 @@
 #define GRID_H
 
 #include<stdbool.h>
+#include<stddef.h>
 
 #include"shared_resources.h"
 
 typedef int ** Int_Grid;
 typedef double ** Double_Grid;
+typedef unsigned char ** Byte_Grid;
+
+// Classification of each cell, stored in one byte per cell. Floor fields hold only distances.
+enum Cell_Type {
+    CELL_FLOOR = 0,
+    CELL_WALL, // Walls and obstacles.
+    CELL_EXIT,
+    CELL_CURRENT_EXIT // Cells of the exit whose floor field is being calculated. The other exits are obstacles for it.
+};
+
+#define CELL_TYPE_BIT(type) (1 << (type)) // Used to build the masks of the cell types that block a diagonal.
+#define MOVEMENT_OBSTACLES CELL_TYPE_BIT(CELL_WALL) // Cell types that block the diagonals of the pedestrians.
+#define MOVEMENT_TARGETS (CELL_TYPE_BIT(CELL_FLOOR) | CELL_TYPE_BIT(CELL_EXIT)) // Cell types where the pedestrians can step.
+
+#define NUM_DIRECTIONS 8 // Neighbors of a cell, in the scanning order of find_smallest_cell (line by line, skipping the cell itself).
+
+#define TILE_SIDE 8 // Number of cells in each side of the square tiles of a Tiled_Double_Grid.
+
+// Grid stored in TILE_SIDE x TILE_SIDE tiles, in line-major order of tiles. The cells of each tile are in Morton (Z) order, so 
+// cells close in the environment are close in memory in both directions.
+typedef struct{
+    double *cells;
+    int line_number;
+    int column_number;
+    int tiles_per_line; // Number of tiles needed to cover a line of the grid.
+}Tiled_Double_Grid;
 
 Int_Grid allocate_integer_grid(int line_number, int column_number);
 Double_Grid allocate_double_grid(int line_number, int column_number);
+Int_Grid allocate_cold_integer_grid(int line_number, int column_number);
+Byte_Grid allocate_byte_grid(int line_number, int column_number);
+Byte_Grid allocate_cold_byte_grid(int line_number, int column_number);
+Double_Grid allocate_cold_double_grid(int line_number, int column_number);
+void release_grid_pages(void **grid);
+void account_grid_memory(long num_bytes);
+void reset_peak_grid_memory();
+size_t get_peak_grid_memory();
 Function_Status reset_integer_grid(Int_Grid integer_grid, int line_number, int column_number);
 Function_Status reset_double_grid(Double_Grid double_grid, int line_number, int column_number);
 Function_Status copy_double_grid(Double_Grid destination, Double_Grid source);
-bool is_diagonal_valid(Location origin_cell, Location target_cell, Double_Grid floor_field);
+Function_Status merge_minimum_double_grid(Double_Grid destination, Double_Grid source);
+Tiled_Double_Grid *allocate_tiled_double_grid(int line_number, int column_number);
+Function_Status copy_to_tiled_double_grid(Tiled_Double_Grid *destination, Double_Grid source);
+void deallocate_tiled_double_grid(Tiled_Double_Grid *tiled_grid);
+bool is_diagonal_valid(Location origin_cell, Location coordinate_modifier, Byte_Grid cell_types, int blocking_types);
+unsigned char calculate_movement_mask(Byte_Grid cell_types, Location cell, int target_types, int blocking_types);
+void build_movement_masks(Byte_Grid movement_masks, Byte_Grid cell_types, int target_types, int blocking_types);
 bool is_within_grid_lines(int line_coordinate);
 bool is_within_grid_columns(int column_coordinate);
 void deallocate_grid(void **grid, int line_number);
 
-extern Int_Grid environment_only_grid;
+/**
+ * Returns the bit of a neighbor in the movement masks built by build_movement_masks.
+ * 
+ * @param line_modifier Line of the neighbor relative to the cell (-1, 0 or 1).
+ * @param column_modifier Column of the neighbor relative to the cell (-1, 0 or 1). Not 0 if line_modifier is 0.
+ * @return The bit of the neighbor, in the order of NUM_DIRECTIONS.
+*/
+static inline int get_direction_bit(int line_modifier, int column_modifier)
+{
+    int direction = (line_modifier + 1) * 3 + column_modifier + 1;
+
+    return 1 << (direction > 4 ? direction - 1 : direction);
+}
+
+/**
+ * Spreads the bits of a coordinate inside a tile, so that they can be interleaved with the bits of the other coordinate.
+ * 
+ * @param coordinate A coordinate between 0 and TILE_SIDE - 1.
+ * @return The coordinate with a zero bit inserted before each of its bits.
+*/
+static inline int spread_tile_bits(int coordinate)
+{
+    return (coordinate & 1) | ((coordinate & 2) << 1) | ((coordinate & 4) << 2);
+}
+
+/**
+ * Returns a cell of a tiled grid.
+ * 
+ * @param tiled_grid A Tiled_Double_Grid.
+ * @param line Line of the cell.
+ * @param column Column of the cell.
+ * @return The value of the cell.
+*/
+static inline double get_tiled_cell(const Tiled_Double_Grid *tiled_grid, int line, int column)
+{
+    size_t tile = (size_t) ((unsigned) line / TILE_SIDE) * tiled_grid->tiles_per_line + (unsigned) column / TILE_SIDE;
+    int cell_in_tile = spread_tile_bits((unsigned) column % TILE_SIDE) | (spread_tile_bits((unsigned) line % TILE_SIDE) << 1);
+
+    return tiled_grid->cells[tile * TILE_SIDE * TILE_SIDE + cell_in_tile];
+}
+
+extern Byte_Grid environment_only_grid;
 extern Int_Grid pedestrian_position_grid;
 extern Int_Grid heatmap_grid;
 
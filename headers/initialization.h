@@ -11,4 +11,6 @@ Function_Status generate_environment();
 int extract_simulation_set_quantity(FILE *auxiliary_file);
 Function_Status get_next_simulation_set(FILE *auxiliary_file, int *exit_number);
 
+extern const char *output_path;
+
 #endif
\ No newline at end of file
@@ -0,0 +1,8 @@
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include"shared_resources.h"
+
+Function_Status generate_layout();
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include<stddef.h>
+
+#include"shared_resources.h"
+
+// Part of the program to which an allocation is attributed by the memory report.
+enum Memory_Subsystem {
+    MEMORY_GRID, // Grids and their line pointers.
+    MEMORY_EXIT, // Exits, the floor field solvers and the set arena (which also holds the lanes of --batch).
+    MEMORY_PEDESTRIAN, // Pedestrians (the replica arena) and their list.
+    MEMORY_CONFLICT, // Conflict lists and the lists and buffers of the X movement checks.
+    MEMORY_ENGINE, // Orderings and packed copies of the pedestrians kept by the parallel engine.
+    MEMORY_OUTPUT, // Reports kept until the end of the run.
+    NUM_MEMORY_SUBSYSTEMS
+};
+
+typedef struct{
+    long calls; // Calls to the allocator (malloc, calloc, realloc, free, mmap and munmap).
+    size_t allocated_bytes; // Bytes allocated over the whole run.
+    size_t live_bytes;
+    size_t peak_bytes; // Largest live_bytes of the run.
+    size_t set_peak_bytes; // Largest live_bytes of the current simulation set.
+}Memory_Counters;
+
+void *tracked_malloc(enum Memory_Subsystem subsystem, size_t size);
+void *tracked_calloc(enum Memory_Subsystem subsystem, size_t count, size_t size);
+void *tracked_realloc(enum Memory_Subsystem subsystem, void *allocation, size_t size);
+void tracked_free(void *allocation);
+void record_allocation(enum Memory_Subsystem subsystem, size_t size);
+void record_deallocation(enum Memory_Subsystem subsystem, size_t size);
+void begin_memory_set();
+void end_memory_set();
+long get_allocator_calls();
+Function_Status print_memory_report();
+
+extern Memory_Counters memory_counters[NUM_MEMORY_SUBSYSTEMS];
+extern Memory_Counters memory_total; // Counters of all subsystems together (its peak is the peak of the sum).
+
+#endif
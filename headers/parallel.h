@@ -0,0 +1,14 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include<stdio.h>
+
+#include"shared_resources.h"
+
+#define MAX_THREADS 256
+
+Function_Status start_parallel_engine();
+Function_Status run_parallel_timesteps(FILE *output_file, int simulation_number, int *number_timesteps);
+void stop_parallel_engine();
+
+#endif
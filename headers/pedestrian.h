@@ -3,6 +3,8 @@
 
 #include"shared_resources.h"
 
+#define PANIC_PROBABILITY 0.05
+
 typedef struct cell_conflict * Cell_Conflict;
 
 enum Pedestrian_State {LEAVING, GOT_OUT, STOPPED, MOVING};
@@ -20,23 +22,28 @@ typedef struct pedestrian * Pedestrian;
 typedef struct{
     Pedestrian *list;
     int num_pedestrians;
+    int capacity; // Number of positions allocated in list. Grows geometrically.
 } Pedestrian_Set;
 
 Function_Status insert_pedestrians_at_random(int qtd);
 Function_Status add_new_pedestrian(Location pedestrian_coordinates);
+void clear_pedestrian_set();
 void deallocate_pedestrians();
 int determine_pedestrians_in_panic();
 void evaluate_pedestrians_movements();
 Function_Status identify_pedestrian_conflicts(Cell_Conflict *pedestrian_conflicts, int *num_conflicts);
 Function_Status solve_pedestrian_conflicts(Cell_Conflict pedestrian_conflicts, int num_conflicts);
 void print_pedestrian_conflict_information(Cell_Conflict pedestrian_conflicts, int num_conflicts);
-void block_X_movement();
+Function_Status block_X_movement();
+bool are_movements_crossing(Location first_current, Location first_target, Location second_current, Location second_target);
 void apply_pedestrian_movement();
 void update_pedestrian_position_grid();
 bool is_environment_empty();
+int count_pedestrians_in_environment();
 void reset_pedestrian_state();
 void reset_pedestrian_panic();
 void reset_pedestrians_structures();
+void deallocate_timestep_structures();
 
 extern Pedestrian_Set pedestrian_set;
 
@@ -11,5 +11,6 @@ void print_double_grid(Double_Grid double_grid);
 void print_simulation_set_information(FILE *output_stream);
 void print_execution_status(int set_index, int set_quantity);
 void print_placeholder(FILE *stream, int placeholder);
+void print_timesteps(FILE *output_stream, int timesteps);
 
 #endif
@@ -0,0 +1,150 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include<stdio.h>
+#include<stdint.h>
+#include<stdbool.h>
+#include<time.h>
+
+#include"parallel.h"
+#include"cli_processing.h"
+#include"shared_resources.h"
+
+enum Profile_Phase {
+    PHASE_FLOOR_FIELD,
+    PHASE_PEDESTRIAN_INSERTION,
+    PHASE_EVALUATE_MOVEMENTS,
+    PHASE_PANIC,
+    PHASE_X_MOVEMENT,
+    PHASE_CONFLICTS,
+    PHASE_APPLY_MOVEMENT,
+    PHASE_UPDATE_POSITION_GRID,
+    PHASE_RESETS,
+    PHASE_PEDESTRIAN_ORDERING,
+    PHASE_OUTPUT,
+    NUM_PROFILE_PHASES
+};
+
+enum Perf_Counter {
+    COUNTER_CYCLES,
+    COUNTER_INSTRUCTIONS,
+    COUNTER_CACHE_MISSES,
+    COUNTER_BRANCH_MISSES,
+    NUM_PERF_COUNTERS
+};
+
+// Hardware counters of a thread, opened with perf_event_open as a single group, so they are always scheduled together.
+typedef struct{
+    int leader_fd; // -1 when none of the counters could be opened.
+    int num_events;
+    int fds[NUM_PERF_COUNTERS];
+    enum Perf_Counter events[NUM_PERF_COUNTERS]; // Counter of each event of the group, in the order they are read.
+}Perf_Group;
+
+enum Work_Counter {
+    WORK_FIELD_PASSES, // Sweeps of the grid by the iterative solver (one per exit with the Dijkstra solver).
+    WORK_CELLS_RELAXED, // Floor field values lowered by the solvers.
+    WORK_NEIGHBOR_CANDIDATES, // Reachable neighbor cells examined while choosing the target cells.
+    WORK_CONFLICTS, // Cells targeted by more than one pedestrian.
+    WORK_X_MOVEMENT_CHECKS, // Pairs of adjacent pedestrians whose paths were tested for crossing.
+    WORK_RANDOM_DRAWS,
+    WORK_CELLS_RESET, // Grid cells cleared, by whole grid resets or by the cleanup of the targeted cells.
+    NUM_WORK_COUNTERS
+};
+
+// Work done by the engines, in units that don't depend on the hardware or on the load of the machine.
+typedef struct{
+    long counts[NUM_WORK_COUNTERS];
+}Work_Counters;
+
+// Time and counters of a simulation set, from the start of its floor field calculation until its output is printed.
+typedef struct{
+    uint64_t nanoseconds;
+    uint64_t counters[NUM_PERF_COUNTERS];
+    Work_Counters work;
+}Set_Profile;
+
+// Time spent in each phase of the program, accumulated over the whole run.
+typedef struct{
+    uint64_t phase_start[NUM_PROFILE_PHASES]; // Clock reading of the last PROFILE_BEGIN of each phase.
+    uint64_t nanoseconds[NUM_PROFILE_PHASES];
+    long calls[NUM_PROFILE_PHASES];
+    long timesteps; // Timesteps of all simulations (each replica of --batch counts separately).
+    long pedestrian_steps; // Sum, over all timesteps, of the pedestrians in the environment at the beginning of the timestep.
+    uint64_t run_start;
+    bool counters_enabled; // True with --perf-counters, if at least one counter could be opened.
+    int counter_error; // errno of the first counter that couldn't be opened.
+    bool counter_available[NUM_PERF_COUNTERS];
+    uint64_t counter_start[NUM_PROFILE_PHASES][NUM_PERF_COUNTERS];
+    uint64_t counters[NUM_PROFILE_PHASES][NUM_PERF_COUNTERS];
+    int num_counter_threads;
+    Perf_Group counter_groups[MAX_THREADS]; // Indexed by the thread index of the parallel engine (0 is the main thread).
+    uint64_t parallel_nanoseconds; // Time spent in the timesteps of the parallel engine.
+    uint64_t thread_idle_nanoseconds[MAX_THREADS]; // Time each thread of the parallel engine waited at the barriers between phases.
+    uint64_t set_start;
+    uint64_t set_counter_start[NUM_PERF_COUNTERS];
+    Work_Counters set_work_start;
+    Set_Profile *sets;
+    int num_sets;
+    int sets_capacity;
+}Profile;
+
+void start_profile();
+void open_perf_counters(int thread_index);
+void read_perf_counters(uint64_t values[NUM_PERF_COUNTERS]);
+void add_work_counters(Work_Counters *total, Work_Counters *partial);
+void begin_profile_set();
+void end_profile_set();
+Function_Status print_profile_report();
+void print_profile_status(FILE *status_file, const Work_Counters *pending_work);
+
+extern Profile profile;
+extern Work_Counters work_counters; // Counted by the main thread. The threads of the parallel engine count in their stripes.
+
+/**
+ * Reads the monotonic clock, which is served by the vDSO (without a system call) on Linux.
+ *
+ * @return The current time, in nanoseconds.
+*/
+static inline uint64_t read_profile_clock()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t) now.tv_sec * 1000000000UL + (uint64_t) now.tv_nsec;
+}
+
+/**
+ * Adds to the given totals the counters elapsed since the given start values.
+ *
+ * @param totals Totals of a phase or of a simulation set.
+ * @param start Counters read at the beginning of the phase or simulation set.
+*/
+static inline void accumulate_perf_counters(uint64_t totals[NUM_PERF_COUNTERS], const uint64_t start[NUM_PERF_COUNTERS])
+{
+    uint64_t now[NUM_PERF_COUNTERS];
+    read_perf_counters(now);
+
+    for(int counter = 0; counter < NUM_PERF_COUNTERS; counter++)
+    {
+        if(now[counter] > start[counter]) // Multiplexed counters are scaled estimates, which may go back slightly.
+            totals[counter] += now[counter] - start[counter];
+    }
+}
+
+// The timers cost a branch when --profile isn't given. Compiling with -DVARAS_NO_PROFILE removes them and the work counters entirely.
+#ifdef VARAS_NO_PROFILE
+#define COUNT_WORK(counters, counter, amount) ((void) sizeof((counters).counts[counter] += (amount)))
+#define PROFILE_BEGIN(phase) do{}while(0)
+#define PROFILE_END(phase) do{}while(0)
+#define PROFILE_COUNT_TIMESTEPS(num_timesteps, num_pedestrians) do{ (void) sizeof(num_timesteps); (void) sizeof(num_pedestrians); }while(0)
+#else
+// The work counters are always incremented (an addition is cheaper than testing --work-counters).
+#define COUNT_WORK(counters, counter, amount) ((counters).counts[counter] += (amount))
+#define PROFILE_BEGIN(phase) do{ if(cli_args.profile){ if(profile.counters_enabled) read_perf_counters(profile.counter_start[phase]); profile.phase_start[phase] = read_profile_clock(); } }while(0)
+#define PROFILE_END(phase) do{ if(cli_args.profile){ profile.nanoseconds[phase] += read_profile_clock() - profile.phase_start[phase]; profile.calls[phase]++; if(profile.counters_enabled) accumulate_perf_counters(profile.counters[phase], profile.counter_start[phase]); } }while(0)
+// The arguments are only evaluated with --profile.
+#define PROFILE_COUNT_TIMESTEPS(num_timesteps, num_pedestrians) do{ if(cli_args.profile){ profile.timesteps += (num_timesteps); profile.pedestrian_steps += (num_pedestrians); } }while(0)
+#endif
+
+#endif
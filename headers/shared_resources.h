@@ -6,7 +6,9 @@
 enum Output_Format {
     OUTPUT_VISUALIZATION = 1, 
     OUTPUT_TIMESTEPS_COUNT, 
-    OUTPUT_HEATMAP
+    OUTPUT_HEATMAP, 
+    OUTPUT_BINARY,
+    OUTPUT_STATISTICS
 };
 
 enum Environment_Origin {
@@ -17,6 +19,36 @@ enum Environment_Origin {
     AUTOMATIC_CREATED
 };
 
+enum Environment_Layout {
+    ENVIRONMENT_EMPTY = 1, 
+    ENVIRONMENT_CLASSROOMS, 
+    ENVIRONMENT_CORRIDORS, 
+    ENVIRONMENT_OBSTACLES, 
+    ENVIRONMENT_MAZE
+};
+
+enum Floor_Field_Solver {
+    SOLVER_ITERATIVE = 1, 
+    SOLVER_DIJKSTRA
+};
+
+enum Grid_Backend {
+    BACKEND_HEAP = 1, 
+    BACKEND_HUGE_PAGES, 
+    BACKEND_FILE
+};
+
+enum Grid_Layout {
+    LAYOUT_LINES = 1, 
+    LAYOUT_TILED
+};
+
+enum Exit_Fields_Mode {
+    EXIT_FIELDS_KEEP = 1, 
+    EXIT_FIELDS_DROP, 
+    EXIT_FIELDS_COMPRESS
+};
+
 typedef enum Function_Status {
     FAILURE = 0, 
     END_PROGRAM = 0,
@@ -29,8 +61,7 @@ typedef struct{
     int col;
 }Location;
 
-#define EXIT_VALUE 1
-#define WALL_VALUE 1000
+#define EXIT_VALUE 1 // Floor field value of the exit cells, from which the distances are propagated.
 
 bool origin_uses_auxiliary_data();
 bool origin_uses_static_pedestrians();
@@ -0,0 +1,37 @@
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+#include<stdio.h>
+
+#define P2_MARKERS 5
+#define EXACT_QUANTILE_SAMPLES 100 // Simulations kept per set, whose quantiles are exact. The P² estimators start from them.
+#define NUM_QUANTILES 3 // Quantiles estimated for each simulation set, given by quantile_probabilities.
+
+// P² estimator (Jain and Chlamtac, 1985) of a quantile: five markers whose heights follow the minimum, the quantiles p/2, p and
+// (1 + p)/2, and the maximum of the samples, adjusted with a parabolic formula as samples arrive. Uses constant memory.
+typedef struct{
+    double probability;
+    double heights[P2_MARKERS];
+    double positions[P2_MARKERS];
+    double desired_positions[P2_MARKERS];
+    double increments[P2_MARKERS];
+}P2_Estimator;
+
+// Statistics of the timesteps of the simulations of a simulation set, updated one simulation at a time.
+typedef struct{
+    long count;
+    double mean; // Welford's running mean and sum of squared differences from the mean.
+    double squared_differences;
+    int minimum;
+    int maximum;
+    double first_samples[EXACT_QUANTILE_SAMPLES];
+    P2_Estimator quantiles[NUM_QUANTILES];
+}Set_Statistics;
+
+void begin_set_statistics();
+void add_statistics_sample(int timesteps);
+void print_statistics_header(FILE *output_stream);
+void print_set_statistics(FILE *output_stream);
+void print_inaccessible_set_statistics(FILE *output_stream);
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef STATUS_H
+#define STATUS_H
+
+#include<stdint.h>
+#include<signal.h>
+
+#include"profile.h"
+#include"shared_resources.h"
+
+// Position of the run, kept up to date by the main loop so a status file can be written at any timestep.
+typedef struct{
+    const char *activity; // "floor field", "simulation" or "output".
+    int set_index; // Starting at 0.
+    int set_quantity;
+    int simulation; // Index of the simulation in its set (of the first replica of the batch with --batch).
+    int num_replicas; // Replicas run in lockstep (1 without --batch).
+    int seed; // Seed of the simulation (of the first replica of the batch with --batch).
+    uint64_t start;
+}Run_Status;
+
+Function_Status install_status_handler();
+void write_status_file(int timestep, long pedestrians_remaining, const Work_Counters *pending_work);
+
+extern Run_Status run_status;
+extern volatile sig_atomic_t status_requested; // Set by the SIGUSR1 handler, cleared when the status file is written.
+
+// The arguments are only evaluated after a SIGUSR1. pending_work holds work counters not yet added to work_counters, or NULL.
+#define STATUS_CHECKPOINT(timestep, pedestrians_remaining, pending_work) do{ if(status_requested) write_status_file((timestep), (pedestrians_remaining), (pending_work)); }while(0)
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include<stdio.h>
+#include<stdint.h>
+#include<stdbool.h>
+
+#include"cli_processing.h"
+#include"shared_resources.h"
+
+#define TELEMETRY_RATE_SMOOTHING 0.3 // Weight of the last interval in the moving average of the progress rate.
+
+// Progress of the run, reported every --telemetry-interval seconds.
+typedef struct{
+    FILE *stream;
+    bool is_terminal; // The line is rewritten in place, instead of a new line being printed at each refresh.
+    int set_quantity;
+    long sets;
+    long replicas;
+    long replicas_in_set; // Replicas of the current simulation set already finalized.
+    long pedestrian_steps;
+    uint64_t start;
+    uint64_t next_report;
+    uint64_t last_report;
+    long last_sets; // Counts at the last refresh.
+    long last_replicas;
+    long last_pedestrian_steps;
+    double last_progress; // Fraction of the run done at the last refresh.
+    double progress_rate; // Moving average of the fraction of the run done per second.
+}Telemetry;
+
+Function_Status start_telemetry(int set_quantity);
+void update_telemetry();
+void finish_telemetry();
+
+extern Telemetry telemetry;
+
+// The arguments are only evaluated with --telemetry.
+#define TELEMETRY_TIMESTEP(num_pedestrians) do{ if(cli_args.telemetry){ telemetry.pedestrian_steps += (num_pedestrians); update_telemetry(); } }while(0)
+#define TELEMETRY_REPLICAS(num_replicas) do{ if(cli_args.telemetry){ telemetry.replicas += (num_replicas); telemetry.replicas_in_set += (num_replicas); update_telemetry(); } }while(0)
+#define TELEMETRY_SET() do{ if(cli_args.telemetry){ telemetry.sets++; telemetry.replicas_in_set = 0; update_telemetry(); } }while(0)
+#define TELEMETRY_TICK() do{ if(cli_args.telemetry) update_telemetry(); }while(0)
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include<stdint.h>
+#include<stdbool.h>
+
+#include"profile.h"
+#include"cli_processing.h"
+#include"shared_resources.h"
+
+#define TRACE_EVENT_LIMIT 1000000 // Events written to a trace file at most (about 150 MB). Later events are dropped.
+
+Function_Status start_trace();
+void write_trace_span(const char *name, const char *category, int thread_index, uint64_t start, const char *argument_name, long argument_value);
+void name_trace_thread(int thread_index);
+void finish_trace();
+
+extern long trace_events; // Events already written (or claimed by a thread about to write them).
+
+/**
+ * Reads the clock for the beginning of a span of the trace.
+ *
+ * @return The current time, in nanoseconds, or 0 without --trace.
+*/
+static inline uint64_t trace_clock()
+{
+    return cli_args.trace ? read_profile_clock() : 0;
+}
+
+/**
+ * Verifies if the phases of the given timestep are written to the trace (one every --trace-interval timesteps).
+ *
+ * @param timestep Index of the timestep, starting at 0.
+ * @return bool, where True indicates that the timestep is sampled and False otherwise.
+*/
+static inline bool is_traced_timestep(int timestep)
+{
+    return cli_args.trace && cli_args.trace_interval > 0 && timestep % cli_args.trace_interval == 0;
+}
+
+#endif
@@ -0,0 +1,162 @@
+/* 
+   File: arena.c
+   Author: Daniel Gonçalves
+   Date: 2026-10-17
+   Description: This module contains the arenas used for structures whose lifetime is a simulation set (exits, compressed floor fields and the batched engine) or a single simulation (pedestrians). The blocks of each arena are attributed to a subsystem by the memory report.
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<stdint.h>
+#include<stdalign.h>
+
+#include"../headers/arena.h"
+
+#define ARENA_BLOCK_SIZE (64 * 1024) // Minimum usable size of a block, in bytes.
+
+struct arena_block{
+    Arena_Block *next;
+    size_t size; // Usable bytes in data.
+    size_t used;
+    max_align_t data[]; // Every allocation is aligned to alignof(max_align_t), as with malloc.
+};
+
+Arena set_arena = {NULL, NULL, NULL, MEMORY_EXIT}; // Reset when the exits of a simulation set are deallocated.
+Arena replica_arena = {NULL, NULL, NULL, MEMORY_PEDESTRIAN}; // Reset when the pedestrians of a simulation are deallocated.
+
+/**
+ * Allocates memory from the given arena. The memory is only released when the arena is reset or deallocated.
+ * 
+ * @param arena Arena from which the memory will be allocated.
+ * @param size Number of bytes to allocate.
+ * @return A NULL pointer, on error, or a pointer aligned as the ones returned by malloc.
+*/
+void *arena_allocate(Arena *arena, size_t size)
+{
+    size = (size + alignof(max_align_t) - 1) / alignof(max_align_t) * alignof(max_align_t);
+    if(size == 0)
+        size = alignof(max_align_t);
+
+    Arena_Block *block = arena->current;
+    while(block != NULL && block->size - block->used < size)
+    {
+        block = block->next;
+        if(block != NULL)
+            block->used = 0; // Blocks after the current one still hold the allocations made before the last reset.
+    }
+
+    if(block == NULL)
+    {
+        size_t block_size = size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE;
+        block = tracked_malloc(arena->subsystem, sizeof(Arena_Block) + block_size);
+        if(block == NULL)
+        {
+            fprintf(stderr, "Failure to allocate a block of %zu bytes for an arena.\n", block_size);
+            return NULL;
+        }
+
+        block->size = block_size;
+        block->used = 0;
+
+        // The new block is placed after the current one, so the smaller blocks that didn't fit are still reused after a reset.
+        if(arena->current == NULL)
+        {
+            block->next = arena->first;
+            arena->first = block;
+        }
+        else
+        {
+            block->next = arena->current->next;
+            arena->current->next = block;
+        }
+    }
+
+    arena->current = block;
+
+    void *allocation = (char *) block->data + block->used;
+    block->used += size;
+    arena->last_allocation = allocation;
+
+    return allocation;
+}
+
+/**
+ * Allocates zeroed memory from the given arena, as calloc.
+ * 
+ * @param arena Arena from which the memory will be allocated.
+ * @param size Number of bytes to allocate.
+ * @return A NULL pointer, on error, or a pointer to the zeroed memory.
+*/
+void *arena_allocate_zeroed(Arena *arena, size_t size)
+{
+    void *allocation = arena_allocate(arena, size);
+    if(allocation != NULL)
+        memset(allocation, 0, size);
+
+    return allocation;
+}
+
+/**
+ * Resizes an allocation of the given arena, as realloc. The last allocation of the arena grows in place when its block has 
+ * room for it. Otherwise, a new allocation receives the contents and the old one is only released by the next reset.
+ * 
+ * @param arena Arena of the allocation.
+ * @param old_allocation Allocation to be resized, or NULL.
+ * @param old_size Size of the old allocation, in bytes.
+ * @param new_size New size, in bytes.
+ * @return A NULL pointer, on error, or the resized allocation.
+*/
+void *arena_reallocate(Arena *arena, void *old_allocation, size_t old_size, size_t new_size)
+{
+    if(old_allocation != NULL && old_allocation == arena->last_allocation)
+    {
+        Arena_Block *block = arena->current;
+        size_t offset = (char *) old_allocation - (char *) block->data;
+        size_t aligned_size = (new_size + alignof(max_align_t) - 1) / alignof(max_align_t) * alignof(max_align_t);
+
+        if(aligned_size <= block->size - offset)
+        {
+            block->used = offset + aligned_size;
+            return old_allocation;
+        }
+    }
+
+    void *new_allocation = arena_allocate(arena, new_size);
+    if(new_allocation != NULL && old_allocation != NULL)
+        memcpy(new_allocation, old_allocation, old_size < new_size ? old_size : new_size);
+
+    return new_allocation;
+}
+
+/**
+ * Makes all the memory of the arena available again, in O(1). The blocks are kept for the next allocations.
+ * 
+ * @param arena Arena to be reset.
+*/
+void reset_arena(Arena *arena)
+{
+    arena->current = arena->first;
+    if(arena->first != NULL)
+        arena->first->used = 0;
+
+    arena->last_allocation = NULL;
+}
+
+/**
+ * Deallocate all blocks of the arena.
+ * 
+ * @param arena Arena to be deallocated.
+*/
+void deallocate_arena(Arena *arena)
+{
+    Arena_Block *block = arena->first;
+    while(block != NULL)
+    {
+        Arena_Block *next = block->next;
+        tracked_free(block);
+        block = next;
+    }
+
+    *arena = (Arena) {NULL, NULL, NULL, arena->subsystem};
+}
@@ -0,0 +1,886 @@
+/*
+   File: batch.c
+   Author: Daniel Gonçalves
+   Date: 2026-10-17
+   Description: This module implements the batched simulation engine, which runs several simulations (replicas) of the same simulation set in lockstep. The state of the replicas is interleaved (replica-minor) so that neighbor minima, occupancy checks and panic draws are computed across replicas with SIMD instructions (AVX2, with a scalar fallback). Each replica has its own random number generator and finishes independently while the batch continues.
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<stdint.h>
+#include<stdbool.h>
+#include<limits.h>
+#include<math.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include<immintrin.h>
+#define HAS_AVX2_KERNEL
+#endif
+
+#include"../headers/batch.h"
+#include"../headers/exit.h"
+#include"../headers/grid.h"
+#include"../headers/arena.h"
+#include"../headers/trace.h"
+#include"../headers/status.h"
+#include"../headers/profile.h"
+#include"../headers/telemetry.h"
+#include"../headers/pedestrian.h"
+#include"../headers/printing_utilities.h"
+#include"../headers/binary_output.h"
+#include"../headers/statistics.h"
+#include"../headers/cli_processing.h"
+#include"../headers/shared_resources.h"
+
+#define CONFLICT_STRIDE 9 // Number of pedestrians followed by up to 8 pedestrian ids.
+
+typedef struct{
+    int num_lanes; // Number of replicas run in lockstep.
+    int num_pedestrians; // Number of pedestrians in each replica.
+    int num_cells;
+    int panic_threshold; // Draws (modulo 100) below this value put a pedestrian in panic.
+    int direction_offset[NUM_DIRECTIONS]; // Cell index offsets of the neighborhood, in the scanning order of find_smallest_cell.
+    double *floor_field; // Flat copy of exits_set.final_floor_field.
+    unsigned char *cell_types; // Flat copy of exits_set.cell_types.
+    int *movement_mask; // Bit d is set when the neighbor in the direction d can be reached from the cell.
+    int *position_grid; // [cell * num_lanes + lane]: id of the pedestrian in the cell or 0.
+    int *conflict_grid; // [cell * num_lanes + lane]: same encoding of the conflict_grid in identify_pedestrian_conflicts.
+    int *heatmap; // Flat heatmap accumulated by all lanes.
+    int *current; // [pedestrian * num_lanes + lane]: cell index where the pedestrian is.
+    int *target; // [pedestrian * num_lanes + lane]: cell index where the pedestrian wants to go.
+    int *state; // [pedestrian * num_lanes + lane]: enum Pedestrian_State.
+    int *in_panic; // [pedestrian * num_lanes + lane]
+    uint32_t *random_state; // [lane]: state of the xorshift32 generator of each replica.
+    int *remaining; // [lane]: pedestrians still in the environment.
+    int *timesteps; // [lane]
+    int *tie_mask; // [lane]: directions whose cells have the smallest floor field value for the current pedestrian.
+    int *conflict_list; // Conflicts of a single lane, CONFLICT_STRIDE integers each.
+    int *claimed_cells; // Cells written in the conflict_grid by a single lane.
+    int *scan_order; // Pedestrian indexes of a single lane, sorted by cell (line by line), for the X movement scan.
+    int *scan_buffer;
+    int *cell_count; // Counters of the sort by column and by line, with max(global_line_number, global_column_number) + 1 positions.
+    bool use_avx2;
+}Batch;
+
+static Batch batch;
+
+static const int direction_lin[NUM_DIRECTIONS] = {-1, -1, -1,  0, 0,  1, 1, 1};
+static const int direction_col[NUM_DIRECTIONS] = {-1,  0,  1, -1, 1, -1, 0, 1};
+
+static Function_Status allocate_batch();
+static void deallocate_batch();
+static void copy_cell_data();
+static void initialize_lanes(int first_seed, int lane_quantity);
+static void insert_lane_pedestrians_at_random(int lane);
+static bool is_any_lane_running();
+static void evaluate_lane_movements();
+static void find_lane_smallest_cell(int ped_index, int lane, bool unoccupied_only);
+static void find_lane_smallest_cells_scalar(int ped_index, bool unoccupied_only);
+#ifdef HAS_AVX2_KERNEL
+static void find_lane_smallest_cells_avx2(int ped_index, bool unoccupied_only);
+#endif
+static void determine_lanes_in_panic();
+static void block_lane_X_movement();
+static int sort_lane_pedestrians_by_cell(int lane);
+static void solve_lane_conflicts();
+static void apply_lane_movement();
+static void reset_lane_states();
+static inline uint32_t next_lane_random(int lane);
+static uint32_t seed_lane_random(int seed);
+
+/**
+ * Runs all the simulations for the current simulation set in batches of cli_args.batch_lanes replicas, printing generated data if appropriate.
+ *
+ * @note Replicas use their own random number generator (seeded with the same seeds used by run_simulations), so results are
+ * statistically equivalent, but not identical, to the ones obtained without --batch.
+ *
+ * @param output_file Stream where the output data will be written.
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+*/
+Function_Status run_batched_simulations(FILE *output_file)
+{
+    if(allocate_batch() == FAILURE)
+        return FAILURE;
+
+    copy_cell_data();
+
+    for(int first_simulation = 0; first_simulation < cli_args.num_simulations; first_simulation += batch.num_lanes)
+    {
+        int lane_quantity = cli_args.num_simulations - first_simulation;
+        if(lane_quantity > batch.num_lanes)
+            lane_quantity = batch.num_lanes;
+
+        uint64_t replicas_trace_start = trace_clock(); // The replicas of a batch start together and end independently.
+        run_status.simulation = first_simulation;
+        run_status.num_replicas = lane_quantity;
+        run_status.seed = cli_args.seed + first_simulation;
+        PROFILE_BEGIN(PHASE_PEDESTRIAN_INSERTION);
+        initialize_lanes(cli_args.seed + first_simulation, lane_quantity);
+        PROFILE_END(PHASE_PEDESTRIAN_INSERTION);
+
+        for(int timestep = 0; is_any_lane_running(); timestep++)
+        {
+            uint64_t timestep_trace_start = is_traced_timestep(timestep) ? trace_clock() : 0;
+            bool was_running[MAX_BATCH_LANES];
+            int running_lanes = 0;
+            long pedestrians_in_environment = 0;
+            for(int lane = 0; lane < batch.num_lanes; lane++)
+            {
+                was_running[lane] = batch.remaining[lane] > 0;
+                running_lanes += was_running[lane];
+                pedestrians_in_environment += batch.remaining[lane];
+            }
+            PROFILE_COUNT_TIMESTEPS(running_lanes, pedestrians_in_environment);
+            TELEMETRY_TIMESTEP(pedestrians_in_environment);
+            STATUS_CHECKPOINT(timestep, pedestrians_in_environment, NULL);
+
+            PROFILE_BEGIN(PHASE_EVALUATE_MOVEMENTS);
+            evaluate_lane_movements();
+            PROFILE_END(PHASE_EVALUATE_MOVEMENTS);
+
+            PROFILE_BEGIN(PHASE_PANIC);
+            determine_lanes_in_panic();
+            PROFILE_END(PHASE_PANIC);
+
+            if(!cli_args.allow_X_movement)
+            {
+                PROFILE_BEGIN(PHASE_X_MOVEMENT);
+                block_lane_X_movement();
+                PROFILE_END(PHASE_X_MOVEMENT);
+            }
+
+            PROFILE_BEGIN(PHASE_CONFLICTS);
+            solve_lane_conflicts();
+            PROFILE_END(PHASE_CONFLICTS);
+
+            PROFILE_BEGIN(PHASE_APPLY_MOVEMENT);
+            apply_lane_movement();
+            PROFILE_END(PHASE_APPLY_MOVEMENT);
+
+            PROFILE_BEGIN(PHASE_RESETS);
+            reset_lane_states();
+            PROFILE_END(PHASE_RESETS);
+
+            if(timestep_trace_start != 0)
+                write_trace_span("timestep", "timestep", 0, timestep_trace_start, "timestep", timestep + 1);
+
+            for(int lane = 0; lane < batch.num_lanes; lane++)
+            {
+                if(was_running[lane])
+                    batch.timesteps[lane]++; // Replicas that already finished keep their timestep count.
+
+                if(was_running[lane] && batch.remaining[lane] == 0)
+                {
+                    write_trace_span("simulation", "replica", 0, replicas_trace_start, "seed", cli_args.seed + first_simulation + lane);
+                    TELEMETRY_REPLICAS(1);
+                }
+            }
+        }
+
+        PROFILE_BEGIN(PHASE_OUTPUT);
+        uint64_t output_trace_start = trace_clock();
+        if(cli_args.output_format == OUTPUT_TIMESTEPS_COUNT)
+        {
+            for(int lane = 0; lane < lane_quantity; lane++)
+                print_timesteps(output_file, batch.timesteps[lane]);
+        }
+        else if(cli_args.output_format == OUTPUT_BINARY)
+        {
+            for(int lane = 0; lane < lane_quantity; lane++)
+                record_binary_timesteps(batch.timesteps[lane]);
+        }
+        else if(cli_args.output_format == OUTPUT_STATISTICS)
+        {
+            for(int lane = 0; lane < lane_quantity; lane++)
+                add_statistics_sample(batch.timesteps[lane]);
+        }
+        write_trace_span("output", "output", 0, output_trace_start, NULL, 0);
+        PROFILE_END(PHASE_OUTPUT);
+    }
+
+    for(int cell = 0; cell < batch.num_cells; cell++)
+        heatmap_grid[cell / cli_args.global_column_number][cell % cli_args.global_column_number] += batch.heatmap[cell];
+
+    cli_args.seed += cli_args.num_simulations;
+
+    deallocate_batch();
+
+    return SUCCESS;
+}
+
+/* ---------------- ---------------- ---------------- ---------------- ---------------- */
+/* ---------------- ---------------- STATIC FUNCTIONS ---------------- ---------------- */
+/* ---------------- ---------------- ---------------- ---------------- ---------------- */
+
+/**
+ * Allocates the interleaved structures used by the batched engine for the current simulation set.
+ *
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+*/
+static Function_Status allocate_batch()
+{
+    int line_number = cli_args.global_line_number;
+    int column_number = cli_args.global_column_number;
+
+    batch.num_lanes = cli_args.batch_lanes;
+    batch.num_cells = line_number * column_number;
+    batch.num_pedestrians = origin_uses_static_pedestrians() ? pedestrian_set.num_pedestrians : cli_args.total_num_pedestrians;
+
+    if((long) batch.num_cells * batch.num_lanes > INT_MAX || (long) batch.num_pedestrians * batch.num_lanes > INT_MAX)
+    {
+        fprintf(stderr, "The environment or the number of pedestrians is too large for %d lanes in the batched engine.\n", batch.num_lanes);
+        return FAILURE;
+    }
+
+    size_t cell_lanes = (size_t) batch.num_cells * batch.num_lanes;
+    size_t pedestrian_lanes = (size_t) batch.num_pedestrians * batch.num_lanes;
+
+    // Released with the set_arena when the exits of the simulation set are reset.
+    batch.floor_field = arena_allocate(&set_arena, sizeof(double) * batch.num_cells);
+    batch.cell_types = arena_allocate(&set_arena, sizeof(unsigned char) * batch.num_cells);
+    batch.movement_mask = arena_allocate(&set_arena, sizeof(int) * batch.num_cells);
+    batch.position_grid = arena_allocate_zeroed(&set_arena, sizeof(int) * cell_lanes);
+    batch.conflict_grid = arena_allocate_zeroed(&set_arena, sizeof(int) * cell_lanes);
+    batch.heatmap = arena_allocate_zeroed(&set_arena, sizeof(int) * batch.num_cells);
+    batch.current = arena_allocate_zeroed(&set_arena, sizeof(int) * pedestrian_lanes);
+    batch.target = arena_allocate_zeroed(&set_arena, sizeof(int) * pedestrian_lanes);
+    batch.state = arena_allocate_zeroed(&set_arena, sizeof(int) * pedestrian_lanes);
+    batch.in_panic = arena_allocate_zeroed(&set_arena, sizeof(int) * pedestrian_lanes);
+    batch.random_state = arena_allocate_zeroed(&set_arena, sizeof(uint32_t) * batch.num_lanes);
+    batch.remaining = arena_allocate_zeroed(&set_arena, sizeof(int) * batch.num_lanes);
+    batch.timesteps = arena_allocate_zeroed(&set_arena, sizeof(int) * batch.num_lanes);
+    batch.tie_mask = arena_allocate_zeroed(&set_arena, sizeof(int) * batch.num_lanes);
+    batch.conflict_list = arena_allocate(&set_arena, sizeof(int) * CONFLICT_STRIDE * (batch.num_pedestrians / 2 + 1));
+    batch.claimed_cells = arena_allocate(&set_arena, sizeof(int) * (batch.num_pedestrians + 1));
+    batch.scan_order = arena_allocate(&set_arena, sizeof(int) * (batch.num_pedestrians + 1));
+    batch.scan_buffer = arena_allocate(&set_arena, sizeof(int) * (batch.num_pedestrians + 1));
+    batch.cell_count = arena_allocate(&set_arena, sizeof(int) * ((line_number > column_number ? line_number : column_number) + 1));
+
+    if(batch.floor_field == NULL || batch.cell_types == NULL || batch.movement_mask == NULL || batch.position_grid == NULL || batch.conflict_grid == NULL ||
+       batch.heatmap == NULL || batch.current == NULL || batch.target == NULL || batch.state == NULL || batch.in_panic == NULL ||
+       batch.random_state == NULL || batch.remaining == NULL || batch.timesteps == NULL || batch.tie_mask == NULL ||
+       batch.conflict_list == NULL || batch.claimed_cells == NULL || batch.scan_order == NULL || batch.scan_buffer == NULL ||
+       batch.cell_count == NULL)
+    {
+        fprintf(stderr, "Failure during the allocation of the batched engine structures.\n");
+        deallocate_batch();
+        return FAILURE;
+    }
+
+    for(int d = 0; d < NUM_DIRECTIONS; d++)
+        batch.direction_offset[d] = direction_lin[d] * column_number + direction_col[d];
+
+    // Same condition used by determine_pedestrians_in_panic: (rand() % 100 + 1) / 100.0 <= PANIC_PROBABILITY.
+    batch.panic_threshold = 0;
+    for(int value = 1; value <= 100; value++)
+    {
+        if(value / 100.0 <= PANIC_PROBABILITY)
+            batch.panic_threshold = value;
+    }
+
+#ifdef HAS_AVX2_KERNEL
+    batch.use_avx2 = __builtin_cpu_supports("avx2");
+#else
+    batch.use_avx2 = false;
+#endif
+
+    return SUCCESS;
+}
+
+/**
+ * Forgets all structures of the batched engine. Their memory belongs to the set_arena and is released when it is reset.
+*/
+static void deallocate_batch()
+{
+    memset(&batch, 0, sizeof(Batch));
+}
+
+/**
+ * Copies the final floor field, the cell types and the movement masks to flat buffers. The masks hold the checks of 
+ * find_smallest_cell that do not depend on the pedestrians: grid limits, walls and diagonals.
+*/
+static void copy_cell_data()
+{
+    for(int i = 0; i < cli_args.global_line_number; i++)
+    {
+        for(int h = 0; h < cli_args.global_column_number; h++)
+        {
+            int cell = i * cli_args.global_column_number + h;
+            batch.floor_field[cell] = exits_set.final_floor_field[i][h];
+            batch.cell_types[cell] = exits_set.cell_types[i][h];
+            batch.movement_mask[cell] = exits_set.movement_masks[i][h]; // Same bit order: direction_lin and direction_col.
+        }
+    }
+}
+
+/**
+ * Places the pedestrians of each lane and resets the per-lane structures. Lanes beyond lane_quantity are left empty.
+ *
+ * @param first_seed Seed of the first lane. The following lanes use the subsequent seeds.
+ * @param lane_quantity Number of lanes that will hold a simulation.
+*/
+static void initialize_lanes(int first_seed, int lane_quantity)
+{
+    int num_lanes = batch.num_lanes;
+
+    memset(batch.position_grid, 0, sizeof(int) * batch.num_cells * num_lanes);
+    COUNT_WORK(work_counters, WORK_CELLS_RESET, (long) batch.num_cells * num_lanes);
+
+    for(int lane = 0; lane < num_lanes; lane++)
+    {
+        batch.random_state[lane] = seed_lane_random(first_seed + lane);
+        batch.timesteps[lane] = 0;
+        batch.remaining[lane] = lane < lane_quantity ? batch.num_pedestrians : 0;
+
+        for(int p_index = 0; p_index < batch.num_pedestrians; p_index++)
+        {
+            int index = p_index * num_lanes + lane;
+
+            batch.state[index] = lane < lane_quantity ? MOVING : GOT_OUT;
+            batch.in_panic[index] = false;
+            batch.current[index] = batch.target[index] = 0;
+        }
+
+        if(lane >= lane_quantity)
+            continue;
+
+        if(origin_uses_static_pedestrians())
+        {
+            for(int p_index = 0; p_index < batch.num_pedestrians; p_index++)
+            {
+                Location origin = pedestrian_set.list[p_index]->origin;
+                int cell = origin.lin * cli_args.global_column_number + origin.col;
+
+                batch.current[p_index * num_lanes + lane] = cell;
+                batch.position_grid[cell * num_lanes + lane] = p_index + 1;
+            }
+        }
+        else
+            insert_lane_pedestrians_at_random(lane);
+    }
+}
+
+/**
+ * Inserts the pedestrians of the given lane at random locations, following the rules of insert_pedestrians_at_random.
+ *
+ * @param lane Lane where the pedestrians will be inserted.
+*/
+static void insert_lane_pedestrians_at_random(int lane)
+{
+    int num_lanes = batch.num_lanes;
+
+    for(int p_index = 0; p_index < batch.num_pedestrians;)
+    {
+        int line = next_lane_random(lane) % (uint32_t) (cli_args.global_line_number - 1) + 1;
+        int column = next_lane_random(lane) % (uint32_t) (cli_args.global_column_number - 1) + 1;
+        int cell = line * cli_args.global_column_number + column;
+
+        if(cli_args.varas_fig7 == true)
+        {
+            if(column == 1 || column == 2)
+                continue;
+        }
+
+        if(batch.position_grid[cell * num_lanes + lane] != 0 || batch.cell_types[cell] != CELL_FLOOR)
+            continue;
+
+        batch.current[p_index * num_lanes + lane] = cell;
+        batch.position_grid[cell * num_lanes + lane] = p_index + 1;
+        batch.heatmap[cell]++;
+
+        p_index++;
+    }
+}
+
+/**
+ * Verifies if at least one lane still has pedestrians in the environment.
+ *
+ * @return bool, where True indicates that the batch must continue and False otherwise.
+*/
+static bool is_any_lane_running()
+{
+    for(int lane = 0; lane < batch.num_lanes; lane++)
+    {
+        if(batch.remaining[lane] > 0)
+            return true;
+    }
+
+    return false;
+}
+
+/**
+ * Determines the destination cell for each pedestrian of each lane, in the same way of evaluate_pedestrians_movements.
+*/
+static void evaluate_lane_movements()
+{
+    int num_lanes = batch.num_lanes;
+    bool unoccupied_only = ! cli_args.always_move_to_lowest;
+
+    for(int p_index = 0; p_index < batch.num_pedestrians; p_index++)
+    {
+#ifdef HAS_AVX2_KERNEL
+        if(batch.use_avx2)
+            find_lane_smallest_cells_avx2(p_index, unoccupied_only);
+        else
+#endif
+            find_lane_smallest_cells_scalar(p_index, unoccupied_only);
+
+        for(int lane = 0; lane < num_lanes; lane++)
+        {
+            int index = p_index * num_lanes + lane;
+
+            if(batch.state[index] != MOVING || batch.in_panic[index])
+                continue;
+
+            COUNT_WORK(work_counters, WORK_NEIGHBOR_CANDIDATES, __builtin_popcount(batch.movement_mask[batch.current[index]]));
+
+            int ties = batch.tie_mask[lane];
+            if(ties == 0)
+            {
+                batch.state[index] = STOPPED; // There isn't a valid cell to move.
+                continue;
+            }
+
+            int drawn_cell = next_lane_random(lane) % (uint32_t) __builtin_popcount(ties);
+            for(; drawn_cell > 0; drawn_cell--)
+                ties &= ties - 1; // Cells with the same value keep the scanning order, as in the stable sort of find_smallest_cell.
+
+            int destination = batch.current[index] + batch.direction_offset[__builtin_ctz(ties)];
+
+            if(batch.position_grid[destination * num_lanes + lane] == 0)
+                batch.target[index] = destination;
+            else
+                batch.state[index] = STOPPED; // Only if the sorted cell is not occupied.
+        }
+    }
+}
+
+/**
+ * Finds, for a single lane, the directions of the neighbors with the smallest floor field value around the given pedestrian.
+ * The result is stored in batch.tie_mask[lane].
+ *
+ * @param ped_index Index of the pedestrian.
+ * @param lane Lane of the pedestrian.
+ * @param unoccupied_only A boolean indicating whether to consider only cells not occupied by a pedestrian (True) or not (False).
+*/
+static void find_lane_smallest_cell(int ped_index, int lane, bool unoccupied_only)
+{
+    int num_lanes = batch.num_lanes;
+    int cell = batch.current[ped_index * num_lanes + lane];
+    int mask = batch.movement_mask[cell];
+    double values[NUM_DIRECTIONS];
+    double smallest = INFINITY;
+
+    for(int d = 0; d < NUM_DIRECTIONS; d++)
+    {
+        int neighbor = cell + batch.direction_offset[d];
+
+        if(unoccupied_only && batch.position_grid[neighbor * num_lanes + lane] > 0)
+            mask &= ~(1 << d);
+
+        if((mask & (1 << d)) == 0)
+            continue;
+
+        values[d] = batch.floor_field[neighbor];
+        if(values[d] < smallest)
+            smallest = values[d];
+    }
+
+    int ties = 0;
+    for(int d = 0; d < NUM_DIRECTIONS; d++)
+    {
+        if((mask & (1 << d)) && values[d] == smallest)
+            ties |= 1 << d;
+    }
+
+    batch.tie_mask[lane] = ties;
+}
+
+/**
+ * Scalar fallback of find_lane_smallest_cells_avx2.
+ *
+ * @param ped_index Index of the pedestrian.
+ * @param unoccupied_only A boolean indicating whether to consider only cells not occupied by a pedestrian (True) or not (False).
+*/
+static void find_lane_smallest_cells_scalar(int ped_index, bool unoccupied_only)
+{
+    for(int lane = 0; lane < batch.num_lanes; lane++)
+        find_lane_smallest_cell(ped_index, lane, unoccupied_only);
+}
+
+#ifdef HAS_AVX2_KERNEL
+/**
+ * Finds, for every lane, the directions of the neighbors with the smallest floor field value around the given pedestrian.
+ * Four lanes are processed at once: cell values and occupancy are gathered for each direction, and the minimum is computed
+ * across lanes. The result is stored in batch.tie_mask.
+ *
+ * @param ped_index Index of the pedestrian.
+ * @param unoccupied_only A boolean indicating whether to consider only cells not occupied by a pedestrian (True) or not (False).
+*/
+__attribute__((target("avx2")))
+static void find_lane_smallest_cells_avx2(int ped_index, bool unoccupied_only)
+{
+    int num_lanes = batch.num_lanes;
+    const int *current = batch.current + (size_t) ped_index * num_lanes;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i lane_count = _mm_set1_epi32(num_lanes);
+    const __m256d infinity = _mm256_set1_pd(INFINITY);
+    int lane = 0;
+
+    for(; lane + 4 <= num_lanes; lane += 4)
+    {
+        __m128i cell = _mm_loadu_si128((const __m128i *) (current + lane));
+        __m128i mask = _mm_i32gather_epi32(batch.movement_mask, cell, 4);
+        __m128i lanes = _mm_add_epi32(_mm_setr_epi32(0, 1, 2, 3), _mm_set1_epi32(lane));
+        __m256d values[NUM_DIRECTIONS];
+        __m256d valid[NUM_DIRECTIONS];
+        __m256d smallest = infinity;
+
+        for(int d = 0; d < NUM_DIRECTIONS; d++)
+        {
+            __m128i bit = _mm_set1_epi32(1 << d);
+            __m128i is_valid = _mm_cmpeq_epi32(_mm_and_si128(mask, bit), bit);
+            __m128i neighbor = _mm_add_epi32(cell, _mm_set1_epi32(batch.direction_offset[d]));
+
+            if(unoccupied_only)
+            {
+                __m128i position_index = _mm_add_epi32(_mm_mullo_epi32(neighbor, lane_count), lanes);
+                __m128i occupant = _mm_mask_i32gather_epi32(zero, batch.position_grid, position_index, is_valid, 4);
+                is_valid = _mm_andnot_si128(_mm_cmpgt_epi32(occupant, zero), is_valid);
+            }
+
+            valid[d] = _mm256_castsi256_pd(_mm256_cvtepi32_epi64(is_valid));
+            values[d] = _mm256_mask_i32gather_pd(infinity, batch.floor_field, neighbor, valid[d], 8);
+            smallest = _mm256_min_pd(smallest, values[d]);
+        }
+
+        int ties[4] = {0, 0, 0, 0};
+        for(int d = 0; d < NUM_DIRECTIONS; d++)
+        {
+            int equal = _mm256_movemask_pd(_mm256_and_pd(_mm256_cmp_pd(values[d], smallest, _CMP_EQ_OQ), valid[d]));
+
+            for(int i = 0; i < 4; i++)
+                ties[i] |= ((equal >> i) & 1) << d;
+        }
+
+        for(int i = 0; i < 4; i++)
+            batch.tie_mask[lane + i] = ties[i];
+    }
+
+    for(; lane < num_lanes; lane++)
+        find_lane_smallest_cell(ped_index, lane, unoccupied_only);
+}
+#endif
+
+/**
+ * For each pedestrian of each lane, determines if they will enter a panic state with a probability defined by PANIC_PROBABILITY.
+ *
+ * @note The loop over the lanes is branchless, so that the draws of all replicas are vectorized by the compiler.
+*/
+static void determine_lanes_in_panic()
+{
+    int num_lanes = batch.num_lanes;
+    uint32_t threshold = batch.panic_threshold;
+    long draws = 0;
+
+    for(int p_index = 0; p_index < batch.num_pedestrians; p_index++)
+    {
+        int *state = batch.state + p_index * num_lanes;
+        int *in_panic = batch.in_panic + p_index * num_lanes;
+
+        for(int lane = 0; lane < num_lanes; lane++)
+        {
+            uint32_t x = batch.random_state[lane];
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+
+            int is_inside = state[lane] != GOT_OUT;
+            batch.random_state[lane] = is_inside ? x : batch.random_state[lane];
+            in_panic[lane] = is_inside & (x % 100 < threshold);
+            draws += is_inside;
+        }
+    }
+
+    COUNT_WORK(work_counters, WORK_RANDOM_DRAWS, draws);
+}
+
+/**
+ * Finds adjacent pedestrians whose movement paths cross (X movement) in each lane, resolving it in the same way of block_X_movement.
+ *
+ * @note Only the cells occupied by the pedestrians of each running lane are visited, in the order of a line by line scan of the
+ * grid, so the draws of each lane are made in the same order as in a full scan.
+*/
+static void block_lane_X_movement()
+{
+    int num_lanes = batch.num_lanes;
+    int column_number = cli_args.global_column_number;
+
+    for(int lane = 0; lane < num_lanes; lane++)
+    {
+        if(batch.remaining[lane] == 0)
+            continue;
+
+        int num_scanned = sort_lane_pedestrians_by_cell(lane);
+
+        for(int scan_index = 0; scan_index < num_scanned; scan_index++)
+        {
+            int first = batch.scan_order[scan_index] * num_lanes + lane;
+            if(batch.state[first] != MOVING || batch.in_panic[first])
+                continue;
+
+            int cell = batch.current[first];
+            int neighbors[2] = {cell + 1, cell + column_number}; // [i][h + 1] and [i + 1][h]
+
+            for(int n = 0; n < 2; n++)
+            {
+                int second_id = batch.position_grid[neighbors[n] * num_lanes + lane];
+                if(second_id == 0)
+                    continue;
+
+                int second = (second_id - 1) * num_lanes + lane;
+                if(batch.state[first] != MOVING || batch.state[second] != MOVING || batch.in_panic[second])
+                    continue;
+
+                Location first_current = {batch.current[first] / column_number, batch.current[first] % column_number};
+                Location first_target = {batch.target[first] / column_number, batch.target[first] % column_number};
+                Location second_current = {batch.current[second] / column_number, batch.current[second] % column_number};
+                Location second_target = {batch.target[second] / column_number, batch.target[second] % column_number};
+
+                COUNT_WORK(work_counters, WORK_X_MOVEMENT_CHECKS, 1);
+                if(are_movements_crossing(first_current, first_target, second_current, second_target))
+                {
+                    if(next_lane_random(lane) % 100 < 50)
+                        batch.state[second] = STOPPED;
+                    else
+                        batch.state[first] = STOPPED;
+
+                    break;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Sorts the indexes of the pedestrians of a lane located inside the environment (not at its boundaries) by line and then by
+ * column, storing them at batch.scan_order, in the same way of sort_pedestrians_by_cell: two passes of counting sort (by column
+ * and then, stable, by line).
+ *
+ * @param lane The lane.
+ * @return The number of pedestrians stored in scan_order.
+*/
+static int sort_lane_pedestrians_by_cell(int lane)
+{
+    int num_lanes = batch.num_lanes;
+    int line_number = cli_args.global_line_number, column_number = cli_args.global_column_number;
+    int *order = batch.scan_order, *buffer = batch.scan_buffer, *count = batch.cell_count;
+    int num_scanned = 0;
+
+    // First pass: by column. The boundaries of the environment are not scanned (only exits can hold pedestrians there).
+    for(int h = 0; h <= column_number; h++)
+        count[h] = 0;
+
+    for(int p_index = 0; p_index < batch.num_pedestrians; p_index++)
+    {
+        int index = p_index * num_lanes + lane;
+        int lin = batch.current[index] / column_number, col = batch.current[index] % column_number;
+
+        if(batch.state[index] == GOT_OUT || lin < 1 || lin >= line_number - 1 || col < 1 || col >= column_number - 1)
+            continue;
+
+        count[col + 1]++;
+        num_scanned++;
+    }
+
+    for(int h = 0; h < column_number; h++)
+        count[h + 1] += count[h];
+
+    for(int p_index = 0; p_index < batch.num_pedestrians; p_index++)
+    {
+        int index = p_index * num_lanes + lane;
+        int lin = batch.current[index] / column_number, col = batch.current[index] % column_number;
+
+        if(batch.state[index] == GOT_OUT || lin < 1 || lin >= line_number - 1 || col < 1 || col >= column_number - 1)
+            continue;
+
+        buffer[count[col]++] = p_index;
+    }
+
+    // Second pass: by line, keeping the column order of the first pass.
+    for(int i = 0; i <= line_number; i++)
+        count[i] = 0;
+
+    for(int scan_index = 0; scan_index < num_scanned; scan_index++)
+        count[batch.current[buffer[scan_index] * num_lanes + lane] / column_number + 1]++;
+
+    for(int i = 0; i < line_number; i++)
+        count[i + 1] += count[i];
+
+    for(int scan_index = 0; scan_index < num_scanned; scan_index++)
+        order[count[batch.current[buffer[scan_index] * num_lanes + lane] / column_number]++] = buffer[scan_index];
+
+    return num_scanned;
+}
+
+/**
+ * Identifies and solves the conflicts of each lane, in the same way of identify_pedestrian_conflicts and solve_pedestrian_conflicts.
+*/
+static void solve_lane_conflicts()
+{
+    int num_lanes = batch.num_lanes;
+
+    for(int lane = 0; lane < num_lanes; lane++)
+    {
+        int num_conflicts = 0;
+        int num_claimed = 0;
+
+        for(int p_index = 0; p_index < batch.num_pedestrians; p_index++)
+        {
+            int index = p_index * num_lanes + lane;
+
+            if(batch.state[index] != MOVING || batch.in_panic[index])
+                continue;
+
+            int *target_cell = &(batch.conflict_grid[batch.target[index] * num_lanes + lane]);
+
+            if(*target_cell == 0)
+            {
+                *target_cell = p_index + 1;
+                batch.claimed_cells[num_claimed++] = batch.target[index];
+                continue;
+            }
+
+            if(*target_cell > 0)
+            {
+                int *conflict = batch.conflict_list + num_conflicts * CONFLICT_STRIDE;
+                conflict[0] = 2;
+                conflict[1] = *target_cell;
+                conflict[2] = p_index + 1;
+
+                num_conflicts++;
+                *target_cell = num_conflicts * -1;
+                continue;
+            }
+
+            int *conflict = batch.conflict_list + ((*target_cell * -1) - 1) * CONFLICT_STRIDE;
+            conflict[1 + conflict[0]] = p_index + 1;
+            conflict[0]++;
+        }
+
+        for(int conflict_index = 0; conflict_index < num_conflicts; conflict_index++)
+        {
+            int *conflict = batch.conflict_list + conflict_index * CONFLICT_STRIDE;
+            int random_result = next_lane_random(lane) % (uint32_t) conflict[0];
+
+            for(int p_index = 0; p_index < conflict[0]; p_index++)
+            {
+                if(p_index != random_result)
+                    batch.state[(conflict[1 + p_index] - 1) * num_lanes + lane] = STOPPED;
+            }
+        }
+
+        for(int claimed_index = 0; claimed_index < num_claimed; claimed_index++)
+            batch.conflict_grid[batch.claimed_cells[claimed_index] * num_lanes + lane] = 0;
+
+        COUNT_WORK(work_counters, WORK_CONFLICTS, num_conflicts);
+        COUNT_WORK(work_counters, WORK_CELLS_RESET, num_claimed);
+    }
+}
+
+/**
+ * Moves the pedestrians of each lane, in the same way of apply_pedestrian_movement, and keeps the position grid of each lane
+ * up to date.
+*/
+static void apply_lane_movement()
+{
+    int num_lanes = batch.num_lanes;
+
+    for(int p_index = 0; p_index < batch.num_pedestrians; p_index++)
+    {
+        for(int lane = 0; lane < num_lanes; lane++)
+        {
+            int index = p_index * num_lanes + lane;
+            int state = batch.state[index];
+
+            if(batch.in_panic[index] || state == GOT_OUT || state == STOPPED)
+                continue;
+
+            if(state == MOVING)
+            {
+                // Targets are always empty at the beginning of the timestep, so the order of the updates does not matter.
+                batch.position_grid[batch.current[index] * num_lanes + lane] = 0;
+                batch.current[index] = batch.target[index];
+                batch.position_grid[batch.current[index] * num_lanes + lane] = p_index + 1;
+
+                if(batch.cell_types[batch.current[index]] == CELL_EXIT)
+                    state = cli_args.immediate_exit ? GOT_OUT : LEAVING;
+            }
+            else if(state == LEAVING)
+                state = GOT_OUT;
+
+            if(state == GOT_OUT)
+            {
+                batch.position_grid[batch.current[index] * num_lanes + lane] = 0;
+                batch.remaining[lane]--;
+            }
+
+            batch.state[index] = state;
+        }
+    }
+}
+
+/**
+ * Updates the heatmap with the pedestrians still in the environment and resets their state and panic flag,
+ * as done by update_pedestrian_position_grid, reset_pedestrian_state and reset_pedestrian_panic.
+*/
+static void reset_lane_states()
+{
+    size_t pedestrian_lanes = (size_t) batch.num_pedestrians * batch.num_lanes;
+
+    for(size_t index = 0; index < pedestrian_lanes; index++)
+    {
+        if(batch.state[index] == GOT_OUT)
+            continue;
+
+        batch.heatmap[batch.current[index]]++;
+        batch.in_panic[index] = false;
+
+        if(batch.state[index] != LEAVING)
+            batch.state[index] = MOVING;
+    }
+}
+
+/**
+ * Draws the next number of the xorshift32 generator of the given lane.
+ *
+ * @param lane Lane whose generator will be used.
+ * @return A pseudo-random 32-bit unsigned integer.
+*/
+static inline uint32_t next_lane_random(int lane)
+{
+    uint32_t x = batch.random_state[lane];
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+
+    COUNT_WORK(work_counters, WORK_RANDOM_DRAWS, 1);
+    return batch.random_state[lane] = x;
+}
+
+/**
+ * Derives the initial state of a lane generator from a seed, spreading close seeds apart.
+ *
+ * @param seed Seed of the simulation held by the lane.
+ * @return A non-zero initial state for the xorshift32 generator.
+*/
+static uint32_t seed_lane_random(int seed)
+{
+    uint32_t z = (uint32_t) seed + 0x9E3779B9u;
+    z = (z ^ (z >> 16)) * 0x85EBCA6Bu;
+    z = (z ^ (z >> 13)) * 0xC2B2AE35u;
+    z ^= z >> 16;
+
+    return z != 0 ? z : 0x6D2B79F5u; // xorshift32 never leaves the zero state.
+}
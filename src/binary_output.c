@@ -0,0 +1,224 @@
+/*
+   File: binary_output.c
+   Author: Daniel Gonçalves
+   Date: 2026-10-18
+   Description: This module writes the binary output (--output-format 4): the timesteps of every replica and the heatmap of every simulation set, as fixed-width integers, with the heatmaps optionally compressed in runs (--compress-output). The layout is described in binary_output.h, and tools/varas_reader.c converts the files back to the text outputs or to CSV.
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<stdint.h>
+#include<stdbool.h>
+
+#include"../headers/exit.h"
+#include"../headers/grid.h"
+#include"../headers/memory.h"
+#include"../headers/binary_output.h"
+#include"../headers/cli_processing.h"
+
+static int32_t *replica_timesteps = NULL; // Timesteps of the replicas of the current simulation set.
+static int num_recorded_replicas = 0;
+static int32_t encoded_block[2 * HEATMAP_BLOCK_CELLS];
+
+static void write_integer(FILE *output_file, int32_t value);
+static void write_heatmap(FILE *output_file);
+static uint64_t hash_environment();
+
+/**
+ * Writes the header of the binary output and allocates the list of timesteps of the replicas.
+ *
+ * @param output_file Stream where the output data will be written.
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+*/
+Function_Status start_binary_output(FILE *output_file)
+{
+    replica_timesteps = tracked_malloc(MEMORY_OUTPUT, sizeof(int32_t) * cli_args.num_simulations);
+    if(replica_timesteps == NULL)
+    {
+        fprintf(stderr, "Failure in the allocation of the timesteps of the binary output.\n");
+        return FAILURE;
+    }
+    num_recorded_replicas = 0;
+
+    char command[sizeof(cli_args.full_command) + 16];
+    int command_length = snprintf(command, sizeof(command), "./varas.sh%s", cli_args.full_command);
+    int flags = (cli_args.compress_output ? BINARY_COMPRESSED : 0) | (cli_args.show_simulation_set_info ? BINARY_SIMULATION_SET_INFO : 0) |
+                (cli_args.single_exit_flag ? BINARY_SINGLE_EXIT_FLAG : 0);
+    uint64_t environment_hash = hash_environment();
+
+    fwrite(BINARY_MAGIC, 1, BINARY_MAGIC_LENGTH, output_file);
+    write_integer(output_file, BINARY_VERSION);
+    write_integer(output_file, flags);
+    write_integer(output_file, cli_args.global_line_number);
+    write_integer(output_file, cli_args.global_column_number);
+    write_integer(output_file, cli_args.num_simulations);
+    write_integer(output_file, command_length);
+    fwrite(command, 1, command_length, output_file);
+    fwrite(&environment_hash, sizeof(uint64_t), 1, output_file);
+
+    if(ferror(output_file))
+    {
+        fprintf(stderr, "It was not possible to write the header of the binary output.\n");
+        return FAILURE;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * Keeps the number of timesteps of a replica of the current simulation set, to be written with the set.
+ *
+ * @param timesteps Number of timesteps required for the termination of the simulation.
+*/
+void record_binary_timesteps(int timesteps)
+{
+    if(num_recorded_replicas < cli_args.num_simulations)
+        replica_timesteps[num_recorded_replicas++] = timesteps;
+}
+
+/**
+ * Writes the record of the current simulation set: its exits, the timesteps recorded for its replicas and, if its exits are
+ * accessible, the heatmap.
+ *
+ * @param output_file Stream where the output data will be written.
+ * @param set_position Position of the simulation set in the auxiliary file, starting at 1 (1 without an auxiliary file).
+ * @param is_inaccessible Whether an exit of the simulation set is inaccessible, in which case no simulation was run.
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+*/
+Function_Status write_binary_set(FILE *output_file, int set_position, bool is_inaccessible)
+{
+    write_integer(output_file, BINARY_RECORD_SET);
+    write_integer(output_file, set_position);
+    write_integer(output_file, is_inaccessible);
+
+    write_integer(output_file, exits_set.num_exits);
+    for(int exit_index = 0; exit_index < exits_set.num_exits; exit_index++)
+    {
+        Exit current_exit = exits_set.list[exit_index];
+        write_integer(output_file, current_exit->width);
+        for(int cell_index = 0; cell_index < current_exit->width; cell_index++)
+        {
+            write_integer(output_file, current_exit->coordinates[cell_index].lin);
+            write_integer(output_file, current_exit->coordinates[cell_index].col);
+        }
+    }
+
+    int num_replicas = is_inaccessible ? 0 : num_recorded_replicas;
+    write_integer(output_file, num_replicas);
+    fwrite(replica_timesteps, sizeof(int32_t), num_replicas, output_file);
+    num_recorded_replicas = 0;
+
+    if(! is_inaccessible)
+        write_heatmap(output_file);
+
+    if(ferror(output_file))
+    {
+        fprintf(stderr, "It was not possible to write the simulation set to the binary output.\n");
+        return FAILURE;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * Deallocates the list of timesteps of the replicas.
+*/
+void finish_binary_output()
+{
+    tracked_free(replica_timesteps);
+    replica_timesteps = NULL;
+}
+
+/* ---------------- ---------------- ---------------- ---------------- ---------------- */
+/* ---------------- ---------------- STATIC FUNCTIONS ---------------- ---------------- */
+/* ---------------- ---------------- ---------------- ---------------- ---------------- */
+
+/**
+ * Writes a 32-bit integer to the binary output.
+ *
+ * @param output_file Stream where the output data will be written.
+ * @param value Integer to be written.
+*/
+static void write_integer(FILE *output_file, int32_t value)
+{
+    fwrite(&value, sizeof(int32_t), 1, output_file);
+}
+
+/**
+ * Writes the heatmap grid in blocks of HEATMAP_BLOCK_CELLS cells. With --compress-output, a block is stored as runs of cells
+ * with the same number of visits if that takes fewer integers than storing every cell.
+ *
+ * @param output_file Stream where the output data will be written.
+*/
+static void write_heatmap(FILE *output_file)
+{
+    long num_cells = (long) cli_args.global_line_number * cli_args.global_column_number;
+
+    for(long first_cell = 0; first_cell < num_cells; first_cell += HEATMAP_BLOCK_CELLS)
+    {
+        int block_cells = num_cells - first_cell < HEATMAP_BLOCK_CELLS ? num_cells - first_cell : HEATMAP_BLOCK_CELLS;
+        int num_integers = 0;
+        enum Block_Encoding encoding = BLOCK_RAW;
+
+        if(cli_args.compress_output)
+        {
+            encoding = BLOCK_RUNS;
+            for(int cell = 0; cell < block_cells; cell++)
+            {
+                long cell_index = first_cell + cell;
+                int visits = heatmap_grid[cell_index / cli_args.global_column_number][cell_index % cli_args.global_column_number];
+
+                if(num_integers > 0 && encoded_block[num_integers - 1] == visits)
+                    encoded_block[num_integers - 2]++;
+                else if(num_integers + 2 > block_cells)
+                {
+                    encoding = BLOCK_RAW; // The runs would be larger than the cells.
+                    break;
+                }
+                else
+                {
+                    encoded_block[num_integers++] = 1;
+                    encoded_block[num_integers++] = visits;
+                }
+            }
+        }
+
+        if(encoding == BLOCK_RAW)
+        {
+            for(int cell = 0; cell < block_cells; cell++)
+            {
+                long cell_index = first_cell + cell;
+                encoded_block[cell] = heatmap_grid[cell_index / cli_args.global_column_number][cell_index % cli_args.global_column_number];
+            }
+            num_integers = block_cells;
+        }
+
+        write_integer(output_file, encoding);
+        write_integer(output_file, num_integers);
+        fwrite(encoded_block, sizeof(int32_t), num_integers, output_file);
+    }
+}
+
+/**
+ * Calculates the FNV-1a hash of the environment structure, over its dimensions and the cell types of the environment grid.
+ *
+ * @return The 64-bit hash.
+*/
+static uint64_t hash_environment()
+{
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    int dimensions[2] = {cli_args.global_line_number, cli_args.global_column_number};
+    unsigned char *bytes = (unsigned char *) dimensions;
+
+    for(size_t byte = 0; byte < sizeof(dimensions); byte++)
+        hash = (hash ^ bytes[byte]) * 0x100000001B3ULL;
+
+    for(int i = 0; i < cli_args.global_line_number; i++)
+    {
+        for(int h = 0; h < cli_args.global_column_number; h++)
+            hash = (hash ^ environment_only_grid[i][h]) * 0x100000001B3ULL;
+    }
+
+    return hash;
+}
@@ -11,6 +11,8 @@
 #include"../headers/cell.h"
 #include"../headers/exit.h"
 #include"../headers/grid.h"
+#include"../headers/profile.h"
+#include"../headers/cli_processing.h"
 #include"../headers/shared_resources.h"
 
 static void sort_cell_list(cell_list neighborhood);
@@ -31,9 +33,12 @@ static void sort_cell_list(cell_list neighborhood);
 */
 Cell find_smallest_cell(Location ped_coordinates, bool unoccupied_only)
 {
-    Double_Grid final_floor_field = exits_set.final_floor_field;
-    cell_list neighborhood = {0, NULL};
-    neighborhood.list = calloc(1, sizeof(Cell) * 8);
+    double floor_field_values[3][3];
+    Cell neighbor_cells[8]; // On the stack: this function runs once per pedestrian per timestep.
+    cell_list neighborhood = {0, neighbor_cells};
+
+    int movement_mask = get_floor_field_neighborhood(ped_coordinates, floor_field_values);
+    COUNT_WORK(work_counters, WORK_NEIGHBOR_CANDIDATES, __builtin_popcount(movement_mask));
 
     for(int j = -1; j < 2; j++)
     {
@@ -42,19 +47,10 @@ Cell find_smallest_cell(Location ped_coordinates, bool unoccupied_only)
             if(j == 0 && k == 0)
                 continue; // The Cell in the given coordinates.
 
-            if(is_within_grid_lines(ped_coordinates.lin + j) == false || is_within_grid_columns(ped_coordinates.col + k) == false)
-                continue;
-
-            double cell_value = final_floor_field[ped_coordinates.lin + j][ped_coordinates.col + k];
+            if(! (movement_mask & get_direction_bit(j, k)))
+                continue; // Outside of the grid, a wall or a blocked diagonal: it's impossible to reach the cell.
 
-            if(cell_value == WALL_VALUE)
-                continue;
-
-            if(j != 0 && k != 0)
-            {
-                if( is_diagonal_valid(ped_coordinates,(Location){j,k},final_floor_field) == false)
-                    continue; // It's impossible to reach the cell.
-            }
+            double cell_value = floor_field_values[1 + j][1 + k];
 
             if(unoccupied_only && pedestrian_position_grid[ped_coordinates.lin + j][ped_coordinates.col + k] > 0)
                 continue; // Pedestrian in the cell.
@@ -82,17 +78,59 @@ Cell find_smallest_cell(Location ped_coordinates, bool unoccupied_only)
         }
 
         int drawn_cell = rand() % same_value;
+        COUNT_WORK(work_counters, WORK_RANDOM_DRAWS, 1);
 
         if(pedestrian_position_grid[neighborhood.list[drawn_cell].coordinates.lin][neighborhood.list[drawn_cell].coordinates.col] == 0)
             destination_cell = neighborhood.list[drawn_cell]; 
             // Only if the sorted cell is not occupied.
     }
 
-    free(neighborhood.list);
-
     return destination_cell;
 }
 
+/**
+ * Reads the final floor field values of the given cell and its neighbors, from the layout chosen with --grid-layout. 
+ * The values of the neighbors outside of the grid are not written.
+ * 
+ * @param center Coordinates of the cell in the center of the neighborhood.
+ * @param floor_field_values Matrix where the values will be stored. The center cell is at [1][1].
+ * @return The movement mask of the center cell: the bit of get_direction_bit is set for each neighbor that can be reached.
+*/
+int get_floor_field_neighborhood(Location center, double floor_field_values[3][3])
+{
+    bool is_interior = center.lin > 0 && center.lin < cli_args.global_line_number - 1 && 
+                       center.col > 0 && center.col < cli_args.global_column_number - 1;
+
+    if(is_interior && cli_args.grid_layout == LAYOUT_LINES)
+    {
+        for(int j = -1; j < 2; j++)
+        {
+            double *line = &exits_set.final_floor_field[center.lin + j][center.col - 1];
+            floor_field_values[1 + j][0] = line[0];
+            floor_field_values[1 + j][1] = line[1];
+            floor_field_values[1 + j][2] = line[2];
+        }
+
+        return exits_set.movement_masks[center.lin][center.col];
+    }
+
+    for(int j = -1; j < 2; j++)
+    {
+        for(int k = -1; k < 2; k++)
+        {
+            if(is_within_grid_lines(center.lin + j) == false || is_within_grid_columns(center.col + k) == false)
+                continue;
+
+            if(cli_args.grid_layout == LAYOUT_TILED)
+                floor_field_values[1 + j][1 + k] = get_tiled_cell(exits_set.tiled_final_floor_field, center.lin + j, center.col + k);
+            else
+                floor_field_values[1 + j][1 + k] = exits_set.final_floor_field[center.lin + j][center.col + k];
+        }
+    }
+
+    return exits_set.movement_masks[center.lin][center.col];
+}
+
 /**
  * Sorts the given cell_list in ascending order.
  * 
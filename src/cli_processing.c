@@ -12,6 +12,8 @@
 #include<unistd.h>
 #include<stdbool.h>
 
+#include"../headers/batch.h"
+#include"../headers/parallel.h"
 #include"../headers/cli_processing.h"
 
 const char * argp_program_version = "Implementation of the Varas model for pedestrian evacuation using cellular automata.";
@@ -27,13 +29,40 @@ const char doc[] = "Varas - Simulates pedestrian evacuation using the Varas (200
 "\t\t3 - Environment structure and static pedestrians.\n"
 "\t\t4 - (default) Environment structure, static exits and static pedestrians.\n"
 "\tEnvironment auto created:\n"
-"\t\t5 - Environment structure will be a empty room with dimensions of LINES and COLUMNS (including the walls surrounding it).\n"
+"\t\t5 - Environment structure will be a empty room with dimensions of LINES and COLUMNS (including the walls surrounding it), or the layout chosen by --env-layout.\n"
 "Choices 1, 3 and 5 require the file provided by the --auxiliary-file option in order to include exits in the simulation.\n"
 "\n"
+"The --env-layout option specifies what is drawn inside the walls of an auto created environment. Except for the empty room, a corridor of one cell is kept along the walls, so exits can be placed anywhere on them, and cells that can't reach it become obstacles. The following choices are available:\n"
+"\t 1 - (default) Empty room.\n"
+"\t 2 - Classrooms of the varas_classroom_with_obstacles.txt environment, with doors on both sides, separated by corridors of 2 cells.\n"
+"\t 3 - Rows of rooms of random widths, each with a door to the corridors of 3 cells between the rows.\n"
+"\t 4 - Obstacles of one cell at random positions, with the density given by --obstacle-density.\n"
+"\t 5 - Maze with passages of one cell and an opening on each side.\n"
+"\n"
 "The --output-format option specifies which data generated by the simulations shall be written to the output stream. The following choices are available:\n"
 "\t 1 - (default) Visual print of the environment.\n"
 "\t 2 - Number of timesteps required for the termination of each simulation.\n"
 "\t 3 - Heatmap of the environment cells.\n"
+"\t 4 - Binary file with the number of timesteps of each simulation and the heatmap of each simulation set, which tools/varas_reader.c converts to the output formats 2 and 3 or to CSV. Requires an output file (-o).\n"
+"\t 5 - Statistics of the number of timesteps of the simulations of each simulation set, in a single line per set: number of simulations, mean, standard deviation, minimum, maximum and the estimated 50th, 90th and 99th percentiles.\n"
+"\n"
+"The --floor-field-solver option specifies how the static floor field of each exit is calculated. Both choices produce the same floor field:\n"
+"\t 1 - (default) Iterative sweeps over the whole grid, until no cell changes.\n"
+"\t 2 - Dijkstra algorithm, recommended for large environments.\n"
+"\n"
+"The --grid-backend option specifies where the cells of the grids are stored. The following choices are available:\n"
+"\t 1 - (default) Heap memory.\n"
+"\t 2 - Memory backed by transparent huge pages, when supported by the kernel.\n"
+"\t 3 - Huge pages for the grids used at every timestep and temporary files, in the directory given by --grid-directory, for the remaining grids (environment structure and floor field of each exit). Only the parts of these grids in use are kept in memory.\n"
+"\n"
+"The --grid-layout option specifies how the final floor field is stored for the neighborhood scans of the timesteps. Both choices produce the same results:\n"
+"\t 1 - (default) Line by line.\n"
+"\t 2 - In addition, a copy in tiles of 8 x 8 cells, with the cells of each tile in Morton (Z) order.\n"
+"\n"
+"The --exit-fields option specifies what happens to the floor field of each exit after it is merged into the final floor field, which is the only one used by the simulations:\n"
+"\t 1 - (default) Kept in full.\n"
+"\t 2 - Dropped.\n"
+"\t 3 - Kept compressed (runs of walls and unreachable cells, values in single precision).\n"
 "\n"
 "Unnecessary options for some --env-load-method are ignored.\n";
 
@@ -47,6 +76,30 @@ const char doc[] = "Varas - Simulates pedestrian evacuation using the Varas (200
 #define OPT_AVOID_CORNER_MOVEMENT 1006
 #define OPT_ALLOW_X_MOVEMENT 1007
 #define OPT_SINGLE_EXIT_FLAG 1008
+#define OPT_BATCH 1009
+#define OPT_THREADS 1010
+#define OPT_FLOOR_FIELD_SOLVER 1011
+#define OPT_GRID_BACKEND 1012
+#define OPT_GRID_DIRECTORY 1013
+#define OPT_EXIT_FIELDS 1014
+#define OPT_REORDER_INTERVAL 1015
+#define OPT_GRID_LAYOUT 1016
+#define OPT_PROFILE 1017
+#define OPT_PERF_COUNTERS 1018
+#define OPT_WORK_COUNTERS 1019
+#define OPT_TRACE 1020
+#define OPT_TRACE_INTERVAL 1021
+#define OPT_TELEMETRY 1022
+#define OPT_TELEMETRY_INTERVAL 1023
+#define OPT_STATUS_FILE 1024
+#define OPT_MEM_REPORT 1025
+#define OPT_MEM_REPORT_SETS 1026
+#define OPT_SETS 1027
+#define OPT_ENV_LAYOUT 1028
+#define OPT_OBSTACLE_DENSITY 1029
+#define OPT_LAYOUT_SEED 1030
+#define OPT_SAVE_ENV 1031
+#define OPT_COMPRESS_OUTPUT 1032
 #define OPT_VARAS_FIG7 2001
 
 struct argp_option options[] = {
@@ -62,6 +115,10 @@ struct argp_option options[] = {
     {"\nEnvironment Dimensions (required for auto created environments):\n",0,0,OPTION_DOC,0,5},
     {"lin", 'l', "LINES", 0, "Number of lines for the environment when it is being created.",6},
     {"col", 'c', "COLUMNS", 0, "Number of columns for the environment when it is being created."},
+    {"env-layout", OPT_ENV_LAYOUT, "LAYOUT", 0, "Layout drawn inside the environment when it is being created (default is 1, empty)."},
+    {"obstacle-density", OPT_OBSTACLE_DENSITY, "DENSITY", 0, "With --env-layout 4, probability of each cell being an obstacle (default is 0.2)."},
+    {"layout-seed", OPT_LAYOUT_SEED, "SEED", 0, "Seed of the random choices of --env-layout 3, 4 and 5 (default is 0). The layout doesn't depend on --seed."},
+    {"save-env", OPT_SAVE_ENV, "ENV-FILE", 0, "Writes the created environment to ENV-FILE (in the environments directory), which can then be loaded with --env-load-method 1."},
 
     {"\nSimulation Variables (optional):\n",0,0,OPTION_DOC,0,7},
     {"ped", 'p', "PEDESTRIANS", 0, "Number of pedestrians to be randomly placed in the environment (default is 1).",8},
@@ -77,9 +134,33 @@ struct argp_option options[] = {
     {"avoid-corner-movement",OPT_AVOID_CORNER_MOVEMENT,0,0, "Prevents movement in the corners of walls and obstacles. A single diagonal movement through the corner of a obstacle becomes three movements."},
     {"allow-x-movement",OPT_ALLOW_X_MOVEMENT,0,0, "The movement of pedestrians isn't restricted when X movements occur."},
     {"single-exit-flag", OPT_SINGLE_EXIT_FLAG, 0,0, "Prints a flag (#1) before the results for every simulation set that has only one exit."},
+    {"compress-output", OPT_COMPRESS_OUTPUT, 0, 0, "With --output-format 4, stores each block of the heatmaps as runs of cells with the same value, when that makes it smaller."},
     {"varas-fig7", OPT_VARAS_FIG7, 0, 0, "Doesn't allow any pedestrians to be randomly placed in the first two columns on the left of the environment, in accordance with the experiment in Fig. 7 of the Varas article."},
 
-    {"\nAdditional Information:\n",0,0,OPTION_DOC,0,11},
+    {"\nExecution Options (optional):\n",0,0,OPTION_DOC,0,11},
+    {"batch", OPT_BATCH, "LANES", 0, "Runs LANES simulations of each simulation set in lockstep, with SIMD across simulations (default is 0, disabled). Each simulation uses its own random number generator, so results differ from the non-batched execution. Not available with --output-format 1.",12},
+    {"threads", OPT_THREADS, "THREADS", 0, "Splits the environment into THREADS stripes of lines, whose timesteps are computed in parallel (default is 0, disabled). Random decisions depend only on the seed, the timestep and the pedestrian, so results are the same for any number of threads, but differ from the non-parallel execution. X movements are blocked in the order of a line by line scan, as in the non-parallel execution."},
+    {"reorder-interval", OPT_REORDER_INTERVAL, "TIMESTEPS", 0, "With --threads, every TIMESTEPS timesteps the pedestrians are ordered by their cell and their structures are copied in that order, so memory is walked in spatial order (default is 32, 0 disables it). Results are not affected."},
+    {"floor-field-solver", OPT_FLOOR_FIELD_SOLVER, "SOLVER", 0, "How the static floor field of each exit is calculated."},
+    {"grid-backend", OPT_GRID_BACKEND, "BACKEND", 0, "Where the cells of the grids are stored."},
+    {"grid-layout", OPT_GRID_LAYOUT, "LAYOUT", 0, "How the final floor field is stored for the neighborhood scans."},
+    {"grid-directory", OPT_GRID_DIRECTORY, "DIRECTORY", 0, "Directory for the grid files of --grid-backend 3 (default is /var/tmp)."},
+    {"exit-fields", OPT_EXIT_FIELDS, "MODE", 0, "What is kept of the floor field of each exit after the merge."},
+    {"sets", OPT_SETS, "FIRST-LAST", 0, "Runs only the simulation sets FIRST to LAST (starting at 1) of the auxiliary file. The simulations receive the seeds they would receive in a run over all sets, so the outputs of runs over consecutive ranges can be concatenated into the output of the whole run (e.g. to shard a run across processes)."},
+
+    {"\nDiagnostics (optional):\n",0,0,OPTION_DOC,0,13},
+    {"profile", OPT_PROFILE, "PROFILE-FILE", OPTION_ARG_OPTIONAL, "Measures the time of each phase (floor field, timestep phases and output) and prints a report at the end of the run, to stderr or to the file optionally provided (in the output directory).",14},
+    {"perf-counters", OPT_PERF_COUNTERS, 0, 0, "Also reads the hardware performance counters (cycles, instructions, cache misses and branch misses) of each phase and of each simulation set, reported with --profile (which it implies). Only the timers are reported if the counters are unavailable."},
+    {"work-counters", OPT_WORK_COUNTERS, "WORK-FILE", OPTION_ARG_OPTIONAL, "Prints the work done by the engines (field passes, cells relaxed, neighbor candidates, conflicts, X movement checks, random draws and cells reset) for each simulation set and for the whole run, to stderr or to the file optionally provided (in the output directory). The counts don't depend on the hardware."},
+    {"trace", OPT_TRACE, "TRACE-FILE", 0, "Writes the timeline of the run to TRACE-FILE (in the output directory) as trace-event JSON, for chrome://tracing or Perfetto: spans of each simulation set, simulation (replica), floor field calculation and output writing, and of the phases of the sampled timesteps, for each thread."},
+    {"trace-interval", OPT_TRACE_INTERVAL, "TIMESTEPS", 0, "With --trace, the phases of one timestep in every TIMESTEPS are written (default is 100, 0 writes none), which keeps the trace small for long simulations."},
+    {"telemetry", OPT_TELEMETRY, "TELEMETRY-FILE", OPTION_ARG_OPTIONAL, "Reports the progress of the run instead of the status line of each simulation set: simulation sets, replicas and pedestrian-steps per second, the estimated remaining time and the peak resident memory. Written to stderr (rewritten in place on a terminal, one line per refresh otherwise) or to the file optionally provided (in the output directory)."},
+    {"telemetry-interval", OPT_TELEMETRY_INTERVAL, "SECONDS", 0, "With --telemetry, seconds between refreshes of the report (default is 1)."},
+    {"status-file", OPT_STATUS_FILE, "STATUS-FILE", 0, "File (in the output directory) written when the program receives SIGUSR1, with the simulation set, simulation and timestep being run, the pedestrians remaining, the work counters and, with --profile, the time of each phase (default is status.txt)."},
+    {"mem-report", OPT_MEM_REPORT, "MEM-FILE", OPTION_ARG_OPTIONAL, "Prints the memory used by each subsystem (grid, exit, pedestrian, conflict, engine and output) at the end of the run: allocator calls and bytes allocated, live and at peak, with the peak resident memory of the process. Written to stderr or to the file optionally provided (in the output directory)."},
+    {"mem-report-sets", OPT_MEM_REPORT_SETS, 0, 0, "Also reports the peak memory of each subsystem in each simulation set (implies --mem-report)."},
+
+    {"\nAdditional Information:\n",0,0,OPTION_DOC,0,15},
     {0}
 };
 
@@ -90,8 +171,21 @@ Command_Line_Args cli_args = {
     .environment_filename="varas_queue.txt",
     .output_filename="",
     .auxiliary_filename="",
+    .grid_directory="/var/tmp",
+    .profile_filename="",
+    .work_counters_filename="",
+    .trace_filename="",
+    .telemetry_filename="",
+    .status_filename="status.txt",
+    .mem_report_filename="",
+    .saved_environment_filename="",
     .output_format = OUTPUT_VISUALIZATION,
     .environment_origin = STRUCTURE_DOORS_AND_PEDESTRIANS,
+    .environment_layout = ENVIRONMENT_EMPTY,
+    .floor_field_solver = SOLVER_ITERATIVE,
+    .grid_backend = BACKEND_HEAP,
+    .grid_layout = LAYOUT_LINES,
+    .exit_fields_mode = EXIT_FIELDS_KEEP,
     .write_to_file=false,
     .show_debug_information=false,
     .show_simulation_set_info=false,
@@ -101,12 +195,30 @@ Command_Line_Args cli_args = {
     .allow_X_movement = false,
     .single_exit_flag = false,
     .varas_fig7=false,
+    .profile=false,
+    .perf_counters=false,
+    .work_counters=false,
+    .trace=false,
+    .telemetry=false,
+    .mem_report=false,
+    .mem_report_sets=false,
+    .save_environment=false,
+    .compress_output=false,
     .global_line_number = 0,
     .global_column_number = 0,
     .num_simulations = 1, // A single simulation by default.
     .total_num_pedestrians = 1,
     .seed = 0,
-    .diagonal = 1.5
+    .layout_seed = 0,
+    .batch_lanes = 0,
+    .num_threads = 0,
+    .first_set = 0,
+    .last_set = 0,
+    .reorder_interval = 32,
+    .trace_interval = 100,
+    .diagonal = 1.5,
+    .obstacle_density = 0.2,
+    .telemetry_interval = 1.0
 };
 // When loading an environment global_line_number and global_column_number will no be obtained from the command line arguments. Besides, total_num_pedestrians will be automatic determined by the program on some environment origin formats.
 
@@ -136,7 +248,7 @@ error_t parser_function(int key, char *arg, struct argp_state *state)
             break;
         case 'O':
             int output_format = atoi(arg);
-            if(output_format < OUTPUT_VISUALIZATION || output_format > OUTPUT_HEATMAP)
+            if(output_format < OUTPUT_VISUALIZATION || output_format > OUTPUT_STATISTICS)
             {
                 fprintf(stderr, "Invalid output format.\n");
                 return EIO;
@@ -207,6 +319,40 @@ error_t parser_function(int key, char *arg, struct argp_state *state)
                 return EIO;
             }
             break;
+        case OPT_ENV_LAYOUT:
+            int environment_layout = atoi(arg);
+            if(environment_layout < ENVIRONMENT_EMPTY || environment_layout > ENVIRONMENT_MAZE)
+            {
+                fprintf(stderr, "Invalid environment layout.\n");
+                return EIO;
+            }
+            cli_args->environment_layout = (enum Environment_Layout) environment_layout;
+            break;
+        case OPT_OBSTACLE_DENSITY:
+            cli_args->obstacle_density = atof(arg);
+            if(cli_args->obstacle_density < 0 || cli_args->obstacle_density > 1)
+            {
+                fprintf(stderr, "The obstacle density must be between 0 and 1.\n");
+                return EIO;
+            }
+            break;
+        case OPT_LAYOUT_SEED:
+            cli_args->layout_seed = atoi(arg);
+            if(cli_args->layout_seed < 0)
+            {
+                fprintf(stderr, "The layout seed must be non-negative.\n");
+                return EIO;
+            }
+            break;
+        case OPT_SAVE_ENV:
+            if(strlen(arg) == 0 || strlen(arg) >= sizeof(cli_args->saved_environment_filename))
+            {
+                fprintf(stderr, "The name of the file where the environment is saved must have between 1 and %zu characters.\n", sizeof(cli_args->saved_environment_filename) - 1);
+                return EIO;
+            }
+            strcpy(cli_args->saved_environment_filename, arg);
+            cli_args->save_environment = true;
+            break;
         case OPT_DEBUG:
             cli_args->show_debug_information = true;
             break;
@@ -228,9 +374,176 @@ error_t parser_function(int key, char *arg, struct argp_state *state)
         case OPT_SINGLE_EXIT_FLAG:
             cli_args->single_exit_flag = true;
             break;
+        case OPT_COMPRESS_OUTPUT:
+            cli_args->compress_output = true;
+            break;
         case OPT_VARAS_FIG7:
             cli_args->varas_fig7 = true;
             break;
+        case OPT_BATCH:
+            cli_args->batch_lanes = atoi(arg);
+            if(cli_args->batch_lanes < 0 || cli_args->batch_lanes > MAX_BATCH_LANES)
+            {
+                fprintf(stderr, "The number of batch lanes must be between 0 and %d.\n", MAX_BATCH_LANES);
+                return EIO;
+            }
+            break;
+        case OPT_THREADS:
+            cli_args->num_threads = atoi(arg);
+            if(cli_args->num_threads < 0 || cli_args->num_threads > MAX_THREADS)
+            {
+                fprintf(stderr, "The number of threads must be between 0 and %d.\n", MAX_THREADS);
+                return EIO;
+            }
+            break;
+        case OPT_SETS:
+            if(sscanf(arg, "%d-%d", &(cli_args->first_set), &(cli_args->last_set)) != 2 || cli_args->first_set < 1 || cli_args->last_set < cli_args->first_set)
+            {
+                fprintf(stderr, "The range of simulation sets must be given as FIRST-LAST, with 1 <= FIRST <= LAST.\n");
+                return EIO;
+            }
+            break;
+        case OPT_REORDER_INTERVAL:
+            cli_args->reorder_interval = atoi(arg);
+            if(cli_args->reorder_interval < 0)
+            {
+                fprintf(stderr, "The reorder interval must be a non-negative number of timesteps.\n");
+                return EIO;
+            }
+            break;
+        case OPT_FLOOR_FIELD_SOLVER:
+            int floor_field_solver = atoi(arg);
+            if(floor_field_solver < SOLVER_ITERATIVE || floor_field_solver > SOLVER_DIJKSTRA)
+            {
+                fprintf(stderr, "Invalid floor field solver.\n");
+                return EIO;
+            }
+            cli_args->floor_field_solver = (enum Floor_Field_Solver) floor_field_solver;
+            break;
+        case OPT_GRID_BACKEND:
+            int grid_backend = atoi(arg);
+            if(grid_backend < BACKEND_HEAP || grid_backend > BACKEND_FILE)
+            {
+                fprintf(stderr, "Invalid grid backend.\n");
+                return EIO;
+            }
+            cli_args->grid_backend = (enum Grid_Backend) grid_backend;
+            break;
+        case OPT_GRID_LAYOUT:
+            int grid_layout = atoi(arg);
+            if(grid_layout < LAYOUT_LINES || grid_layout > LAYOUT_TILED)
+            {
+                fprintf(stderr, "Invalid grid layout.\n");
+                return EIO;
+            }
+            cli_args->grid_layout = (enum Grid_Layout) grid_layout;
+            break;
+        case OPT_EXIT_FIELDS:
+            int exit_fields_mode = atoi(arg);
+            if(exit_fields_mode < EXIT_FIELDS_KEEP || exit_fields_mode > EXIT_FIELDS_COMPRESS)
+            {
+                fprintf(stderr, "Invalid exit fields mode.\n");
+                return EIO;
+            }
+            cli_args->exit_fields_mode = (enum Exit_Fields_Mode) exit_fields_mode;
+            break;
+        case OPT_GRID_DIRECTORY:
+            if(strlen(arg) == 0 || strlen(arg) >= sizeof(cli_args->grid_directory))
+            {
+                fprintf(stderr, "The grid directory name must have between 1 and %zu characters.\n", sizeof(cli_args->grid_directory) - 1);
+                return EIO;
+            }
+            strcpy(cli_args->grid_directory, arg);
+            break;
+        case OPT_PROFILE:
+            if(arg != NULL)
+            {
+                if(strlen(arg) == 0 || strlen(arg) >= sizeof(cli_args->profile_filename))
+                {
+                    fprintf(stderr, "The profile file name must have between 1 and %zu characters.\n", sizeof(cli_args->profile_filename) - 1);
+                    return EIO;
+                }
+                strcpy(cli_args->profile_filename, arg);
+            }
+            cli_args->profile = true;
+            break;
+        case OPT_PERF_COUNTERS:
+            cli_args->perf_counters = true;
+            cli_args->profile = true;
+            break;
+        case OPT_WORK_COUNTERS:
+            if(arg != NULL)
+            {
+                if(strlen(arg) == 0 || strlen(arg) >= sizeof(cli_args->work_counters_filename))
+                {
+                    fprintf(stderr, "The work counters file name must have between 1 and %zu characters.\n", sizeof(cli_args->work_counters_filename) - 1);
+                    return EIO;
+                }
+                strcpy(cli_args->work_counters_filename, arg);
+            }
+            cli_args->work_counters = true;
+            break;
+        case OPT_TRACE:
+            if(strlen(arg) == 0 || strlen(arg) >= sizeof(cli_args->trace_filename))
+            {
+                fprintf(stderr, "The trace file name must have between 1 and %zu characters.\n", sizeof(cli_args->trace_filename) - 1);
+                return EIO;
+            }
+            strcpy(cli_args->trace_filename, arg);
+            cli_args->trace = true;
+            break;
+        case OPT_TRACE_INTERVAL:
+            cli_args->trace_interval = atoi(arg);
+            if(cli_args->trace_interval < 0)
+            {
+                fprintf(stderr, "The trace interval must be a non-negative number of timesteps.\n");
+                return EIO;
+            }
+            break;
+        case OPT_TELEMETRY:
+            if(arg != NULL)
+            {
+                if(strlen(arg) == 0 || strlen(arg) >= sizeof(cli_args->telemetry_filename))
+                {
+                    fprintf(stderr, "The telemetry file name must have between 1 and %zu characters.\n", sizeof(cli_args->telemetry_filename) - 1);
+                    return EIO;
+                }
+                strcpy(cli_args->telemetry_filename, arg);
+            }
+            cli_args->telemetry = true;
+            break;
+        case OPT_TELEMETRY_INTERVAL:
+            cli_args->telemetry_interval = atof(arg);
+            if(cli_args->telemetry_interval <= 0)
+            {
+                fprintf(stderr, "The telemetry interval must be a positive number of seconds.\n");
+                return EIO;
+            }
+            break;
+        case OPT_STATUS_FILE:
+            if(strlen(arg) == 0 || strlen(arg) >= sizeof(cli_args->status_filename))
+            {
+                fprintf(stderr, "The status file name must have between 1 and %zu characters.\n", sizeof(cli_args->status_filename) - 1);
+                return EIO;
+            }
+            strcpy(cli_args->status_filename, arg);
+            break;
+        case OPT_MEM_REPORT:
+            if(arg != NULL)
+            {
+                if(strlen(arg) == 0 || strlen(arg) >= sizeof(cli_args->mem_report_filename))
+                {
+                    fprintf(stderr, "The memory report file name must have between 1 and %zu characters.\n", sizeof(cli_args->mem_report_filename) - 1);
+                    return EIO;
+                }
+                strcpy(cli_args->mem_report_filename, arg);
+            }
+            cli_args->mem_report = true;
+            break;
+        case OPT_MEM_REPORT_SETS:
+            cli_args->mem_report_sets = true;
+            cli_args->mem_report = true;
+            break;
         case ARGP_KEY_ARG:
             fprintf(stderr, "No positional argument was expect, but %s was given.\n", arg);
             return EINVAL;
@@ -248,6 +561,12 @@ error_t parser_function(int key, char *arg, struct argp_state *state)
             {
                 if( strcmp(cli_args->auxiliary_filename,"") != 0)
                     strcpy(cli_args->auxiliary_filename,""); // when the auxiliary file is not needed.
+
+                if(cli_args->first_set > 0)
+                {
+                    fprintf(stderr, "--sets requires the simulation sets of an auxiliary file (--env-load-method 1, 3 or 5).\n");
+                    return EIO;
+                }
             }
 
             if(cli_args->environment_origin == AUTOMATIC_CREATED)
@@ -259,6 +578,24 @@ error_t parser_function(int key, char *arg, struct argp_state *state)
                 }
             }
 
+            if(cli_args->output_format == OUTPUT_BINARY && cli_args->write_to_file == false)
+            {
+                fprintf(stderr, "--output-format 4 requires an output file (-o).\n");
+                return EIO;
+            }
+
+            if(cli_args->batch_lanes > 0 && cli_args->output_format == OUTPUT_VISUALIZATION)
+            {
+                fprintf(stderr, "--batch is not available for the visual output format.\n");
+                return EIO;
+            }
+
+            if(cli_args->batch_lanes > 0 && cli_args->num_threads > 0)
+            {
+                fprintf(stderr, "--batch and --threads can't be used together.\n");
+                return EIO;
+            }
+
             break;
         default:
             return ARGP_ERR_UNKNOWN;
@@ -303,6 +640,9 @@ void extract_full_command(char *full_command, int key, char *arg)
         case OPT_SINGLE_EXIT_FLAG:
             sprintf(aux, " --single-exit-flag");
             break;
+        case OPT_COMPRESS_OUTPUT:
+            sprintf(aux, " --compress-output");
+            break;
         case OPT_VARAS_FIG7:
             sprintf(aux, " --varas-fig7");
             break;
@@ -312,6 +652,87 @@ void extract_full_command(char *full_command, int key, char *arg)
         case OPT_DIAGONAL:
             sprintf(aux, " --diagonal=%s", arg);
             break;
+        case OPT_ENV_LAYOUT:
+            sprintf(aux, " --env-layout=%s", arg);
+            break;
+        case OPT_OBSTACLE_DENSITY:
+            sprintf(aux, " --obstacle-density=%.30s", arg);
+            break;
+        case OPT_LAYOUT_SEED:
+            sprintf(aux, " --layout-seed=%s", arg);
+            break;
+        case OPT_SAVE_ENV:
+            sprintf(aux, " --save-env=%.130s", arg);
+            break;
+        case OPT_BATCH:
+            sprintf(aux, " --batch=%s", arg);
+            break;
+        case OPT_THREADS:
+            sprintf(aux, " --threads=%s", arg);
+            break;
+        case OPT_SETS:
+            sprintf(aux, " --sets=%.130s", arg);
+            break;
+        case OPT_REORDER_INTERVAL:
+            sprintf(aux, " --reorder-interval=%s", arg);
+            break;
+        case OPT_FLOOR_FIELD_SOLVER:
+            sprintf(aux, " --floor-field-solver=%s", arg);
+            break;
+        case OPT_GRID_BACKEND:
+            sprintf(aux, " --grid-backend=%s", arg);
+            break;
+        case OPT_GRID_LAYOUT:
+            sprintf(aux, " --grid-layout=%s", arg);
+            break;
+        case OPT_EXIT_FIELDS:
+            sprintf(aux, " --exit-fields=%s", arg);
+            break;
+        case OPT_GRID_DIRECTORY:
+            sprintf(aux, " --grid-directory=%.130s", arg);
+            break;
+        case OPT_PROFILE:
+            if(arg == NULL)
+                sprintf(aux, " --profile");
+            else
+                sprintf(aux, " --profile=%.130s", arg);
+            break;
+        case OPT_PERF_COUNTERS:
+            sprintf(aux, " --perf-counters");
+            break;
+        case OPT_WORK_COUNTERS:
+            if(arg == NULL)
+                sprintf(aux, " --work-counters");
+            else
+                sprintf(aux, " --work-counters=%.130s", arg);
+            break;
+        case OPT_TRACE:
+            sprintf(aux, " --trace=%.130s", arg);
+            break;
+        case OPT_TRACE_INTERVAL:
+            sprintf(aux, " --trace-interval=%s", arg);
+            break;
+        case OPT_TELEMETRY:
+            if(arg == NULL)
+                sprintf(aux, " --telemetry");
+            else
+                sprintf(aux, " --telemetry=%.130s", arg);
+            break;
+        case OPT_TELEMETRY_INTERVAL:
+            sprintf(aux, " --telemetry-interval=%.30s", arg);
+            break;
+        case OPT_STATUS_FILE:
+            sprintf(aux, " --status-file=%.130s", arg);
+            break;
+        case OPT_MEM_REPORT:
+            if(arg == NULL)
+                sprintf(aux, " --mem-report");
+            else
+                sprintf(aux, " --mem-report=%.130s", arg);
+            break;
+        case OPT_MEM_REPORT_SETS:
+            sprintf(aux, " --mem-report-sets");
+            break;
         case 'o':
         case 'O':
         case 'e':
@@ -5,21 +5,69 @@
    Description: This module contains declarations of structures to hold exit information and functions to create/expand exits, add exits to the exits set, and calculate the floor field.
 */
 
+#include<math.h>
 #include<stdio.h>
 #include<stdlib.h>
+#include<string.h>
+#include<stdint.h>
+#include<limits.h>
 #include<stdbool.h>
 
 #include"../headers/exit.h"
 #include"../headers/grid.h"
+#include"../headers/arena.h"
+#include"../headers/memory.h"
+#include"../headers/status.h"
+#include"../headers/profile.h"
+#include"../headers/telemetry.h"
 #include"../headers/cli_processing.h"
 #include"../headers/shared_resources.h"
 
-Exits_Set exits_set = {NULL, NULL, 0};
+typedef struct{
+    double value;
+    long cell; // Cell index: line * global_column_number + column.
+}Heap_Entry;
+
+// Binary min-heap with lazy deletion: a cell may be queued more than once, and only its first removal is used.
+// Its size depends on the cells at the border of the propagation, not on the whole grid.
+typedef struct{
+    Heap_Entry *entries;
+    long size;
+    long capacity;
+    uint64_t *settled; // One bit per cell, set when its final value is known.
+}Cell_Heap;
+
+// Exit floor fields released by previous exits or simulation sets. The grid dimensions never change, so they are reused.
+typedef struct{
+    Double_Grid *grids;
+    int num_grids;
+    int capacity;
+}Floor_Field_Pool;
+
+Exits_Set exits_set = {NULL, NULL, NULL, NULL, NULL, 0, 0};
+
+static Floor_Field_Pool floor_field_pool = {NULL, 0, 0};
+static Double_Grid auxiliary_grid = NULL; // Stores the values of the timestep t + 1 in the iterative propagation.
+static Cell_Heap floor_field_heap = {NULL, 0, 0, NULL};
+static Byte_Grid exit_field_masks = NULL; // Movement masks of the floor field propagation, for the exit marked as CELL_CURRENT_EXIT.
+
+#define EXIT_FIELD_OBSTACLES (CELL_TYPE_BIT(CELL_WALL) | CELL_TYPE_BIT(CELL_EXIT)) // The other exits are obstacles for the floor field of an exit.
+#define EXIT_FIELD_TARGETS CELL_TYPE_BIT(CELL_FLOOR) // The propagation never reaches the cells of the exit itself.
 
 static Exit create_new_exit(Location exit_coordinates);
+static Function_Status build_cell_types();
+static void mark_exit_cells(Exit current_exit, enum Cell_Type cell_type);
+static void update_exit_field_masks(Exit current_exit);
 static Function_Status calculate_exit_floor_field(Exit s);
 static void initialize_exit_floor_field(Exit current_exit);
 static bool is_exit_accessible(Exit s);
+static Function_Status propagate_floor_field_dijkstra(Double_Grid floor_field, double floor_field_rule[3][3]);
+static Function_Status compress_exit_floor_field(Exit current_exit);
+static long compressed_floor_field_size(Compressed_Floor_Field *compressed);
+static Function_Status push_cell(Cell_Heap *heap, long cell, double value);
+static Heap_Entry pop_smallest_cell(Cell_Heap *heap);
+static Double_Grid take_floor_field();
+static Function_Status return_floor_field(Double_Grid floor_field);
 
 /**
  * Adds a new exit to the exits set.
@@ -36,14 +84,20 @@ Function_Status add_new_exit(Location exit_coordinates)
         return FAILURE;
     }
 
-    exits_set.num_exits += 1;
-    exits_set.list = realloc(exits_set.list, sizeof(Exit) * exits_set.num_exits);
-    if(exits_set.list == NULL)
+    if(exits_set.num_exits == exits_set.capacity)
     {
-        fprintf(stderr, "Failure in the realloc of the exits_set list.\n");
-        return FAILURE;
-    }    
+        int new_capacity = exits_set.capacity == 0 ? 8 : exits_set.capacity * 2;
+        exits_set.list = arena_reallocate(&set_arena, exits_set.list, sizeof(Exit) * exits_set.capacity, sizeof(Exit) * new_capacity);
+        if(exits_set.list == NULL)
+        {
+            fprintf(stderr, "Failure in the realloc of the exits_set list.\n");
+            return FAILURE;
+        }
 
+        exits_set.capacity = new_capacity;
+    }
+
+    exits_set.num_exits += 1;
     exits_set.list[exits_set.num_exits - 1] = new_exit;
 
     return SUCCESS;
@@ -61,7 +115,8 @@ Function_Status expand_exit(Exit original_exit, Location new_coordinates)
     if(is_within_grid_lines(new_coordinates.lin) && is_within_grid_columns(new_coordinates.col))
     {
         original_exit->width += 1;
-        original_exit->coordinates = realloc(original_exit->coordinates, sizeof(Location) * original_exit->width);
+        original_exit->coordinates = arena_reallocate(&set_arena, original_exit->coordinates, 
+                                                      sizeof(Location) * (original_exit->width - 1), sizeof(Location) * original_exit->width);
         if(original_exit->coordinates == NULL)
             return FAILURE;
 
@@ -77,6 +132,9 @@ Function_Status expand_exit(Exit original_exit, Location new_coordinates)
 /**
  * Merge the floor_fields of all the exits in the exits_set. The result of this merge is stored at exits_set.final_floor_field.
  * 
+ * @note Each exit floor field is merged right after being calculated, so with --exit-fields 2 (drop) or 3 (compress) at most 
+ * two full floor fields exist at the same time, regardless of the number of exits.
+ * 
  * @return Function_Status: FAILURE (0), SUCCESS (1) or INACCESSIBLE_EXIT(2).
 */
 Function_Status calculate_final_floor_field()
@@ -87,36 +145,170 @@ Function_Status calculate_final_floor_field()
         return FAILURE;
     }
 
+    if(build_cell_types() == FAILURE)
+        return FAILURE;
+
+    if(exits_set.final_floor_field == NULL) // Kept across simulation sets.
+    {
+        exits_set.final_floor_field = allocate_double_grid(cli_args.global_line_number, cli_args.global_column_number);
+        if(exits_set.final_floor_field == NULL)
+        {
+            fprintf(stderr,"Failure during the allocation of the final_floor_field.\n");
+            return FAILURE;
+        }
+    }
+
     for(int exit_index = 0; exit_index < exits_set.num_exits; exit_index++)
     {
-        Function_Status returned_status = calculate_exit_floor_field(exits_set.list[exit_index]);
+        Exit current_exit = exits_set.list[exit_index];
+        mark_exit_cells(current_exit, CELL_CURRENT_EXIT);
+        update_exit_field_masks(current_exit);
+
+        Function_Status returned_status = calculate_exit_floor_field(current_exit);
         if(returned_status != SUCCESS )
             return returned_status;
+
+        if(exit_index == 0)
+            copy_double_grid(exits_set.final_floor_field, current_exit->floor_field); // uses the first exit as the base for the merging
+        else
+            merge_minimum_double_grid(exits_set.final_floor_field, current_exit->floor_field);
+
+        // The floor field of the exit isn't read during the timesteps.
+        if(cli_args.exit_fields_mode == EXIT_FIELDS_KEEP)
+            release_grid_pages((void **) current_exit->floor_field);
+        else
+        {
+            if(cli_args.exit_fields_mode == EXIT_FIELDS_COMPRESS && compress_exit_floor_field(current_exit) == FAILURE)
+                return FAILURE;
+
+            if(return_floor_field(current_exit->floor_field) == FAILURE)
+                return FAILURE;
+            current_exit->floor_field = NULL;
+        }
+
+        mark_exit_cells(current_exit, CELL_EXIT);
+        update_exit_field_masks(current_exit);
+    }
+
+    if(cli_args.grid_layout == LAYOUT_TILED)
+    {
+        if(exits_set.tiled_final_floor_field == NULL) // Kept across simulation sets.
+        {
+            exits_set.tiled_final_floor_field = allocate_tiled_double_grid(cli_args.global_line_number, cli_args.global_column_number);
+            if(exits_set.tiled_final_floor_field == NULL)
+                return FAILURE;
+        }
+
+        return copy_to_tiled_double_grid(exits_set.tiled_final_floor_field, exits_set.final_floor_field);
     }
 
-    exits_set.final_floor_field = allocate_double_grid(cli_args.global_line_number, cli_args.global_column_number);
-    if(exits_set.final_floor_field == NULL)
+    return SUCCESS;
+}
+
+/**
+ * Recalculates the floor field of a single exit of the exits_set, as done by calculate_final_floor_field for each exit, 
+ * without merging it. Used by the microbenchmarks to time the solvers in isolation.
+ * 
+ * @note The cell types of the simulation set must have been built by a previous call to calculate_final_floor_field.
+ * 
+ * @param current_exit Exit of the exits_set whose floor field will be recalculated.
+ * @return Function_Status: FAILURE (0), SUCCESS (1) or INACCESSIBLE_EXIT(2).
+*/
+Function_Status recalculate_exit_floor_field(Exit current_exit)
+{
+    if(exits_set.cell_types == NULL)
     {
-        fprintf(stderr,"Failure during the allocation of the final_floor_field.\n");
+        fprintf(stderr, "The cell types must be built by calculate_final_floor_field before calling 'recalculate_exit_floor_field'.\n");
         return FAILURE;
     }
 
-    if( reset_double_grid(exits_set.final_floor_field, cli_args.global_line_number, cli_args.global_column_number) == FAILURE)
+    mark_exit_cells(current_exit, CELL_CURRENT_EXIT);
+    update_exit_field_masks(current_exit);
+
+    Function_Status returned_status = calculate_exit_floor_field(current_exit);
+
+    mark_exit_cells(current_exit, CELL_EXIT);
+    update_exit_field_masks(current_exit);
+
+    return returned_status;
+}
+
+/**
+ * Verifies if every exit of the exits_set is accessible, as calculate_final_floor_field does, without calculating the floor fields.
+ * 
+ * @return Function_Status: FAILURE (0), SUCCESS (1) or INACCESSIBLE_EXIT(2).
+*/
+Function_Status check_exits_accessibility()
+{
+    if(exits_set.num_exits <= 0 || exits_set.list == NULL)
+    {
+        fprintf(stderr,"The number of exits (%d) is invalid or the exits list is NULL.\n", exits_set.num_exits);
         return FAILURE;
+    }
 
-    Double_Grid current_exit = exits_set.list[0]->floor_field;
-    copy_double_grid(exits_set.final_floor_field, current_exit); // uses the first exit as the base for the merging
-    
-    for(int exit_index = 1; exit_index < exits_set.num_exits; exit_index++)
+    if(build_cell_types() == FAILURE)
+        return FAILURE;
+
+    for(int exit_index = 0; exit_index < exits_set.num_exits; exit_index++)
     {
-        current_exit = exits_set.list[exit_index]->floor_field;
-        for(int i = 0; i < cli_args.global_line_number; i++)
+        Exit current_exit = exits_set.list[exit_index];
+        mark_exit_cells(current_exit, CELL_CURRENT_EXIT);
+        update_exit_field_masks(current_exit);
+
+        bool is_accessible = is_exit_accessible(current_exit);
+
+        mark_exit_cells(current_exit, CELL_EXIT);
+        update_exit_field_masks(current_exit);
+
+        if(is_accessible == false)
+            return INACCESSIBLE_EXIT;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * Writes the floor field of the given exit in the destination grid, decompressing it if necessary.
+ * 
+ * @note With --exit-fields 3 (compress), the values are the single precision approximations of the original ones.
+ * 
+ * @param current_exit Exit whose floor field was already calculated by calculate_final_floor_field.
+ * @param destination Double grid of global size, where the floor field will be written.
+ * @return Function_Status: FAILURE (0), if the floor field wasn't kept (--exit-fields 2), or SUCCESS (1).
+*/
+Function_Status get_exit_floor_field(Exit current_exit, Double_Grid destination)
+{
+    if(current_exit == NULL || destination == NULL)
+    {
+        fprintf(stderr, "A Null pointer was received in 'get_exit_floor_field'.\n");
+        return FAILURE;
+    }
+
+    if(current_exit->floor_field != NULL)
+        return copy_double_grid(destination, current_exit->floor_field);
+
+    Compressed_Floor_Field *compressed = current_exit->compressed_floor_field;
+    if(compressed == NULL)
+    {
+        fprintf(stderr, "The floor field of the exit was dropped after the merge (--exit-fields 2).\n");
+        return FAILURE;
+    }
+
+    int column_number = cli_args.global_column_number;
+    long cell = 0, value_index = 0;
+
+    for(int run_index = 0; run_index < compressed->num_runs; run_index++)
+    {
+        for(int run_cell = 0; run_cell < compressed->run_lengths[run_index]; run_cell++, cell++)
         {
-            for(int h = 0; h < cli_args.global_column_number; h++)
-            {
-                if(exits_set.final_floor_field[i][h] > current_exit[i][h])
-                    exits_set.final_floor_field[i][h] = current_exit[i][h];
-            }
+            double *destination_cell = &destination[cell / column_number][cell % column_number];
+
+            if(compressed->run_kinds[run_index] == RUN_WALLS)
+                *destination_cell = INFINITY;
+            else if(compressed->run_kinds[run_index] == RUN_UNREACHABLE)
+                *destination_cell = 0.0;
+            else
+                *destination_cell = compressed->values[value_index++];
         }
     }
 
@@ -124,26 +316,67 @@ Function_Status calculate_final_floor_field()
 }
 
 /**
- * Deallocate and reset the structures related to each exit and the exists set.
+ * Removes all exits of the exits set, at the end of a simulation set. The exits, their coordinates and compressed floor fields 
+ * are released by resetting the set_arena, and their floor fields are kept for the exits of the next simulation set.
+ * 
+ * @note Every allocation made from the set_arena is released, including the ones of the batched engine.
 */
-void deallocate_exits()
+void reset_exits()
 {
     for(int exit_index = 0; exit_index < exits_set.num_exits; exit_index++)
     {
         Exit current = exits_set.list[exit_index];
 
-        free(current->coordinates);
-        deallocate_grid((void **) current->floor_field, cli_args.global_line_number);
-        free(current);
+        if(current->floor_field != NULL)
+            return_floor_field(current->floor_field);
+
+        if(current->compressed_floor_field != NULL)
+            account_grid_memory(-compressed_floor_field_size(current->compressed_floor_field));
     }
 
-    free(exits_set.list);
     exits_set.list = NULL;
+    exits_set.num_exits = 0;
+    exits_set.capacity = 0;
+
+    reset_arena(&set_arena);
+}
+
+/**
+ * Deallocate and reset the structures related to each exit and the exists set.
+*/
+void deallocate_exits()
+{
+    reset_exits();
+
+    while(floor_field_pool.num_grids > 0)
+        deallocate_grid((void **) floor_field_pool.grids[--floor_field_pool.num_grids], cli_args.global_line_number);
+
+    tracked_free(floor_field_pool.grids);
+    floor_field_pool = (Floor_Field_Pool) {NULL, 0, 0};
 
     deallocate_grid((void **) exits_set.final_floor_field, cli_args.global_line_number);
     exits_set.final_floor_field = NULL;
 
-    exits_set.num_exits = 0;
+    deallocate_tiled_double_grid(exits_set.tiled_final_floor_field);
+    exits_set.tiled_final_floor_field = NULL;
+
+    deallocate_grid((void **) exits_set.cell_types, cli_args.global_line_number);
+    exits_set.cell_types = NULL;
+
+    deallocate_grid((void **) exits_set.movement_masks, cli_args.global_line_number);
+    exits_set.movement_masks = NULL;
+
+    deallocate_grid((void **) exit_field_masks, cli_args.global_line_number);
+    exit_field_masks = NULL;
+
+    deallocate_grid((void **) auxiliary_grid, cli_args.global_line_number);
+    auxiliary_grid = NULL;
+
+    tracked_free(floor_field_heap.entries);
+    tracked_free(floor_field_heap.settled);
+    floor_field_heap = (Cell_Heap) {NULL, 0, 0, NULL};
+
+    deallocate_arena(&set_arena);
 }
 
 /* ---------------- ---------------- ---------------- ---------------- ---------------- */
@@ -160,17 +393,18 @@ static Exit create_new_exit(Location exit_coordinates)
 {
     if(is_within_grid_lines(exit_coordinates.lin) && is_within_grid_columns(exit_coordinates.col))
     {
-        Exit new_exit = malloc(sizeof(struct exit));
+        Exit new_exit = arena_allocate(&set_arena, sizeof(struct exit));
         if(new_exit != NULL)
         {
-            new_exit->coordinates = malloc(sizeof(Location));
+            new_exit->coordinates = arena_allocate(&set_arena, sizeof(Location));
             if(new_exit->coordinates == NULL)
                 return NULL;
             
             new_exit->coordinates[0] = exit_coordinates;
             new_exit->width = 1;
 
-            new_exit->floor_field = allocate_double_grid(cli_args.global_line_number, cli_args.global_column_number);
+            new_exit->floor_field = NULL; // Allocated when the floor field is calculated.
+            new_exit->compressed_floor_field = NULL;
         }
 
         return new_exit;
@@ -179,6 +413,78 @@ static Exit create_new_exit(Location exit_coordinates)
     return NULL;
 }
 
+/**
+ * Builds exits_set.cell_types for the current simulation set, copying the environment_only_grid and marking the cells of 
+ * every exit as CELL_EXIT. The movement masks depend on the exits, so they are also built here: exits_set.movement_masks for 
+ * the pedestrians and exit_field_masks for the floor field propagation.
+ * 
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+*/
+static Function_Status build_cell_types()
+{
+    if(exits_set.cell_types == NULL) // Kept across simulation sets.
+    {
+        exits_set.cell_types = allocate_byte_grid(cli_args.global_line_number, cli_args.global_column_number);
+        exits_set.movement_masks = allocate_byte_grid(cli_args.global_line_number, cli_args.global_column_number);
+        exit_field_masks = allocate_byte_grid(cli_args.global_line_number, cli_args.global_column_number);
+        if(exits_set.cell_types == NULL || exits_set.movement_masks == NULL || exit_field_masks == NULL)
+        {
+            fprintf(stderr,"Failure during the allocation of the cell types and movement masks grids.\n");
+            return FAILURE;
+        }
+    }
+
+    for(int i = 0; i < cli_args.global_line_number; i++)
+        memcpy(exits_set.cell_types[i], environment_only_grid[i], sizeof(unsigned char) * cli_args.global_column_number);
+
+    for(int exit_index = 0; exit_index < exits_set.num_exits; exit_index++)
+        mark_exit_cells(exits_set.list[exit_index], CELL_EXIT);
+
+    build_movement_masks(exits_set.movement_masks, exits_set.cell_types, MOVEMENT_TARGETS, MOVEMENT_OBSTACLES);
+    build_movement_masks(exit_field_masks, exits_set.cell_types, EXIT_FIELD_TARGETS, EXIT_FIELD_OBSTACLES);
+
+    return SUCCESS;
+}
+
+/**
+ * Sets the cell type of all cells of the given exit.
+ * 
+ * @param current_exit Exit whose cells will be marked.
+ * @param cell_type CELL_CURRENT_EXIT while the floor field of the exit is calculated, or CELL_EXIT otherwise.
+*/
+static void mark_exit_cells(Exit current_exit, enum Cell_Type cell_type)
+{
+    for(int i = 0; i < current_exit->width; i++)
+    {
+        Location exit_cell = current_exit->coordinates[i];
+        exits_set.cell_types[exit_cell.lin][exit_cell.col] = cell_type;
+    }
+}
+
+/**
+ * Recalculates the exit_field_masks of the cells whose neighborhood contains a cell of the given exit, after the type of 
+ * its cells is changed by mark_exit_cells.
+ * 
+ * @param current_exit Exit whose cells were marked.
+*/
+static void update_exit_field_masks(Exit current_exit)
+{
+    for(int i = 0; i < current_exit->width; i++)
+    {
+        Location exit_cell = current_exit->coordinates[i];
+
+        for(int j = -1; j < 2; j++)
+        {
+            for(int k = -1; k < 2; k++)
+            {
+                Location cell = {exit_cell.lin + j, exit_cell.col + k};
+                if(is_within_grid_lines(cell.lin) && is_within_grid_columns(cell.col))
+                    exit_field_masks[cell.lin][cell.col] = calculate_movement_mask(exits_set.cell_types, cell, EXIT_FIELD_TARGETS, EXIT_FIELD_OBSTACLES);
+            }
+        }
+    }
+}
+
 /**
  * Calculates the floor field for the given exit.
  * 
@@ -198,19 +504,33 @@ static Function_Status calculate_exit_floor_field(Exit current_exit)
                      {       1.0,        0.0,        1.0       },
                      {cli_args.diagonal, 1.0, cli_args.diagonal}};
 
+    if(current_exit->floor_field == NULL)
+    {
+        current_exit->floor_field = take_floor_field();
+        if(current_exit->floor_field == NULL)
+        {
+            fprintf(stderr, "Failure to allocate the floor field of an exit.\n");
+            return FAILURE;
+        }
+    }
+
     initialize_exit_floor_field(current_exit);
 
     if(is_exit_accessible(current_exit) == false)
         return INACCESSIBLE_EXIT;
 
+    if(cli_args.floor_field_solver == SOLVER_DIJKSTRA)
+        return propagate_floor_field_dijkstra(current_exit->floor_field, floor_field_rule);
+
     Double_Grid floor_field = current_exit->floor_field;
-    Double_Grid auxiliary_grid = allocate_double_grid(cli_args.global_line_number,cli_args.global_column_number);
-    // stores the chances for the timestep t + 1
-    
-    if(auxiliary_grid == NULL)
+    if(auxiliary_grid == NULL) // Kept across exits and simulation sets.
     {
-        fprintf(stderr, "Failure to allocate the auxiliary_grid at calculate_exit_floor_field.\n");
-        return FAILURE;
+        auxiliary_grid = allocate_double_grid(cli_args.global_line_number,cli_args.global_column_number);
+        if(auxiliary_grid == NULL)
+        {
+            fprintf(stderr, "Failure to allocate the auxiliary_grid at calculate_exit_floor_field.\n");
+            return FAILURE;
+        }
     }
 
     copy_double_grid(auxiliary_grid, floor_field); // copies the base structure of the floor field
@@ -219,44 +539,36 @@ static Function_Status calculate_exit_floor_field(Exit current_exit)
     do
     {
         has_changed = false;
+        long relaxed_cells = 0;
         for(int i = 0; i < cli_args.global_line_number; i++)
         {
             for(int h = 0; h < cli_args.global_column_number; h++)
             {
                 double current_cell_value = floor_field[i][h];
+                int movement_mask = exit_field_masks[i][h]; // Zero for walls and the other exits.
 
-                if(current_cell_value == WALL_VALUE || current_cell_value == 0.0) // floor field calculations occur only on cells with values
+                if(movement_mask == 0 || current_cell_value == 0.0) // floor field calculations occur only on cells with values
                     continue;
 
                 for(int j = -1; j < 2; j++)
                 {
-                    if(! is_within_grid_lines(i + j))
-                        continue;
-                    
                     for(int k = -1; k < 2; k++)
                     {
-                        if(! is_within_grid_columns(h + k))
-                            continue;
-
-                        if(floor_field[i + j][h + k] == WALL_VALUE || floor_field[i + j][h + k] == EXIT_VALUE)
-                            continue;
-
-                        if(j != 0 && k != 0)
-                        {
-                            if(! is_diagonal_valid((Location){i,h},(Location){j,k},floor_field))
-                                continue;
-                        }
+                        if((j == 0 && k == 0) || ! (movement_mask & get_direction_bit(j, k)))
+                            continue; // Limits of the grid, walls, the other exits, the cells of this exit and blocked diagonals.
 
                         double adjacent_cell_value = current_cell_value + floor_field_rule[1 + j][1 + k];
                         if(auxiliary_grid[i + j][h + k] == 0.0)
                         {    
                             auxiliary_grid[i + j][h + k] = adjacent_cell_value;
                             has_changed = true;
+                            relaxed_cells++;
                         }
                         else if(adjacent_cell_value < auxiliary_grid[i + j][h + k])
                         {
                             auxiliary_grid[i + j][h + k] = adjacent_cell_value;
                             has_changed = true;
+                            relaxed_cells++;
                         }
                     }
                 }
@@ -264,42 +576,38 @@ static Function_Status calculate_exit_floor_field(Exit current_exit)
         }
         copy_double_grid(floor_field,auxiliary_grid); 
         // make sure floor_field now holds t + 1 timestep, allowing auxiliary_grid to hold t + 2 timestep.
+
+        COUNT_WORK(work_counters, WORK_FIELD_PASSES, 1);
+        COUNT_WORK(work_counters, WORK_CELLS_RELAXED, relaxed_cells);
+        TELEMETRY_TICK(); // Large environments may take many seconds to converge.
+        STATUS_CHECKPOINT(-1, -1, NULL);
     }
     while(has_changed);
 
-    deallocate_grid((void **) auxiliary_grid, cli_args.global_line_number);
-
     return SUCCESS;
 }
 
 /**
- * Copies the structure (obstacles and walls) from the environment_only_grid to the floor field grid 
- * for the provided exit. Additionally, adds the exit cells to it.
+ * Initializes the floor field of the provided exit from the cell types: walls, obstacles and the other exits receive INFINITY, 
+ * the cells of the exit receive EXIT_VALUE and the remaining cells receive 0.0 (not reached yet).
  * 
- * @param current_exit The exit for which the floor field will be initialized.
+ * @param current_exit The exit for which the floor field will be initialized. Its cells must be marked as CELL_CURRENT_EXIT.
 */
 static void initialize_exit_floor_field(Exit current_exit)
 {
-    // Add walls and obstacles to the floor field. 
     for(int i = 0; i < cli_args.global_line_number; i++)
     {
         for(int h = 0; h < cli_args.global_column_number; h++)
         {
-            double cell_value = environment_only_grid[i][h];
-            if(cell_value == WALL_VALUE)
-                current_exit->floor_field[i][h] = WALL_VALUE;
-            else
+            unsigned char cell_type = exits_set.cell_types[i][h];
+            if(cell_type == CELL_CURRENT_EXIT)
+                current_exit->floor_field[i][h] = EXIT_VALUE;
+            else if(cell_type == CELL_FLOOR)
                 current_exit->floor_field[i][h] = 0.0;
+            else
+                current_exit->floor_field[i][h] = INFINITY;
         }
     }
-
-    // Add the exit cells to the floor field
-    for(int i = 0; i < current_exit->width; i++)
-    {
-        Location exit_cell = current_exit->coordinates[i];
-
-        current_exit->floor_field[exit_cell.lin][exit_cell.col] = EXIT_VALUE;
-    }
 }
 
 /**
@@ -315,30 +623,312 @@ static bool is_exit_accessible(Exit current_exit)
     if(current_exit == NULL)
         return false;
 
+    int orthogonal_directions = get_direction_bit(-1, 0) | get_direction_bit(0, -1) | get_direction_bit(0, 1) | get_direction_bit(1, 0);
+
     for(int exit_cell_index = 0; exit_cell_index < current_exit->width; exit_cell_index++)
     {
         Location c = current_exit->coordinates[exit_cell_index];
 
-        for(int j = -1; j < 2; j++)
+        if(exit_field_masks[c.lin][c.col] & orthogonal_directions)
+            return true;
+    }
+
+    return false;
+}
+
+/**
+ * Propagates the floor field from the exit cells with the Dijkstra algorithm, in O(N log N) for N cells. The neighborhood rules 
+ * (walls, exits, diagonal validity and floor_field_rule) are the same of the iterative propagation, which needs one full sweep 
+ * of the grid per cell of distance to the exit. As the floating point sums are monotonic, both converge to the same values.
+ * 
+ * @note Besides the heap, only one bit per cell is used, so the solver is usable in environments with billions of cells.
+ * 
+ * @param floor_field Floor field initialized by initialize_exit_floor_field. Cells not reachable from the exit remain with 0.
+ * @param floor_field_rule Value added when moving to each cell of the neighborhood.
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+*/
+static Function_Status propagate_floor_field_dijkstra(Double_Grid floor_field, double floor_field_rule[3][3])
+{
+    int line_number = cli_args.global_line_number, column_number = cli_args.global_column_number;
+    long num_cells = (long) line_number * column_number;
+    Byte_Grid cell_types = exits_set.cell_types;
+    Cell_Heap *heap = &floor_field_heap; // Kept across exits and simulation sets.
+    if(heap->settled == NULL)
+    {
+        heap->settled = tracked_malloc(MEMORY_EXIT, sizeof(uint64_t) * (num_cells / 64 + 1));
+        if(heap->settled == NULL)
         {
-            if(! is_within_grid_lines(c.lin + j))
-                continue;
+            fprintf(stderr, "Failure to allocate the settled cells at propagate_floor_field_dijkstra.\n");
+            return FAILURE;
+        }
+    }
+
+    memset(heap->settled, 0, sizeof(uint64_t) * (num_cells / 64 + 1));
+    heap->size = 0;
+
+    Function_Status status = SUCCESS;
+    long relaxed_cells = 0;
 
+    for(int i = 0; i < line_number && status == SUCCESS; i++)
+    {
+        for(int h = 0; h < column_number && status == SUCCESS; h++)
+        {
+            if(cell_types[i][h] == CELL_CURRENT_EXIT)
+                status = push_cell(heap, (long) i * column_number + h, EXIT_VALUE);
+        }
+    }
+
+    while(heap->size > 0 && status == SUCCESS)
+    {
+        Heap_Entry smallest = pop_smallest_cell(heap);
+        if(heap->settled[smallest.cell / 64] & (1UL << (smallest.cell % 64)))
+            continue; // Already removed with a smaller (or equal) value.
+
+        heap->settled[smallest.cell / 64] |= 1UL << (smallest.cell % 64);
+
+        int i = smallest.cell / column_number, h = smallest.cell % column_number;
+        floor_field[i][h] = smallest.value;
+
+        int movement_mask = exit_field_masks[i][h];
+
+        for(int j = -1; j < 2; j++)
+        {
             for(int k = -1; k < 2; k++)
             {
-                if(! is_within_grid_columns(c.col + k))
+                if((j == 0 && k == 0) || ! (movement_mask & get_direction_bit(j, k)))
                     continue;
 
-                if(current_exit->floor_field[c.lin + j][c.col + k] == WALL_VALUE || current_exit->floor_field[c.lin + j][c.col + k] == EXIT_VALUE)
+                long adjacent_cell = (long) (i + j) * column_number + h + k;
+                if(heap->settled[adjacent_cell / 64] & (1UL << (adjacent_cell % 64)))
                     continue;
 
-                if(j != 0 && k != 0)
-                    continue; // diagonals
+                double adjacent_cell_value = smallest.value + floor_field_rule[1 + j][1 + k];
+                if(floor_field[i + j][h + k] != 0.0 && floor_field[i + j][h + k] <= adjacent_cell_value)
+                    continue; // The cell is already queued with a value at least as small.
 
-                return true;
+                floor_field[i + j][h + k] = adjacent_cell_value; // Tentative value, until the cell is settled.
+                relaxed_cells++;
+                if(push_cell(heap, adjacent_cell, adjacent_cell_value) == FAILURE)
+                {
+                    status = FAILURE;
+                    break;
+                }
             }
         }
     }
 
-    return false;
+    COUNT_WORK(work_counters, WORK_FIELD_PASSES, 1);
+    COUNT_WORK(work_counters, WORK_CELLS_RELAXED, relaxed_cells);
+    TELEMETRY_TICK();
+    STATUS_CHECKPOINT(-1, -1, NULL);
+
+    return status;
+}
+
+/**
+ * Inserts a cell in the heap with the given value, growing the heap if necessary.
+ * 
+ * @param heap Binary min-heap of cells, ordered by value.
+ * @param cell Index of the cell.
+ * @param value Candidate floor field value of the cell.
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+*/
+static Function_Status push_cell(Cell_Heap *heap, long cell, double value)
+{
+    if(heap->size == heap->capacity)
+    {
+        long new_capacity = heap->capacity == 0 ? 1024 : heap->capacity * 2;
+        Heap_Entry *new_entries = tracked_realloc(MEMORY_EXIT, heap->entries, sizeof(Heap_Entry) * new_capacity);
+        if(new_entries == NULL)
+        {
+            fprintf(stderr, "Failure in the realloc of the floor field heap.\n");
+            return FAILURE;
+        }
+
+        heap->entries = new_entries;
+        heap->capacity = new_capacity;
+    }
+
+    long index = heap->size++;
+    while(index > 0 && heap->entries[(index - 1) / 2].value > value)
+    {
+        heap->entries[index] = heap->entries[(index - 1) / 2];
+        index = (index - 1) / 2;
+    }
+
+    heap->entries[index] = (Heap_Entry) {value, cell};
+
+    return SUCCESS;
 }
+
+/**
+ * Removes the cell with the smallest value from the heap.
+ * 
+ * @param heap Binary min-heap of cells, ordered by value. Must not be empty.
+ * @return The removed Heap_Entry.
+*/
+static Heap_Entry pop_smallest_cell(Cell_Heap *heap)
+{
+    Heap_Entry smallest = heap->entries[0];
+    Heap_Entry last = heap->entries[--heap->size];
+    long index = 0;
+
+    while(true)
+    {
+        long child = 2 * index + 1;
+        if(child >= heap->size)
+            break;
+
+        if(child + 1 < heap->size && heap->entries[child + 1].value < heap->entries[child].value)
+            child++;
+
+        if(heap->entries[child].value >= last.value)
+            break;
+
+        heap->entries[index] = heap->entries[child];
+        index = child;
+    }
+
+    if(heap->size > 0)
+        heap->entries[index] = last;
+
+    return smallest;
+}
+
+/**
+ * Compresses the floor field of the given exit in runs of walls, unreachable cells and cells with values (quantized to single 
+ * precision). Walls and unreachable cells, usually a large part of big maps, cost only their run.
+ * 
+ * @param current_exit Exit whose floor field was already calculated. The full floor field is kept.
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+*/
+static Function_Status compress_exit_floor_field(Exit current_exit)
+{
+    Double_Grid floor_field = current_exit->floor_field;
+    Compressed_Floor_Field *compressed = arena_allocate_zeroed(&set_arena, sizeof(Compressed_Floor_Field));
+    if(compressed == NULL)
+    {
+        fprintf(stderr, "Failure to allocate the compressed floor field of an exit.\n");
+        return FAILURE;
+    }
+
+    // The first pass only counts the runs and values. The second one stores them.
+    for(int pass = 0; pass < 2; pass++)
+    {
+        if(pass == 1)
+        {
+            compressed->run_lengths = arena_allocate(&set_arena, sizeof(int) * compressed->num_runs);
+            compressed->run_kinds = arena_allocate(&set_arena, sizeof(unsigned char) * compressed->num_runs);
+            compressed->values = arena_allocate(&set_arena, sizeof(float) * compressed->num_values);
+            if(compressed->run_lengths == NULL || compressed->run_kinds == NULL || compressed->values == NULL)
+            {
+                fprintf(stderr, "Failure to allocate the runs of the compressed floor field of an exit.\n");
+                return FAILURE; // Released with the set_arena.
+            }
+
+            compressed->num_runs = 0;
+            compressed->num_values = 0;
+        }
+
+        enum Run_Kind previous_kind = RUN_VALUES;
+        int run_length = 0;
+
+        for(int i = 0; i < cli_args.global_line_number; i++)
+        {
+            for(int h = 0; h < cli_args.global_column_number; h++)
+            {
+                double cell_value = floor_field[i][h];
+                unsigned char cell_type = exits_set.cell_types[i][h];
+                enum Run_Kind kind = cell_type == CELL_WALL || cell_type == CELL_EXIT ? RUN_WALLS : cell_value == 0.0 ? RUN_UNREACHABLE : RUN_VALUES;
+
+                if(run_length > 0 && (kind != previous_kind || run_length == INT_MAX))
+                {
+                    if(pass == 1)
+                    {
+                        compressed->run_lengths[compressed->num_runs] = run_length;
+                        compressed->run_kinds[compressed->num_runs] = previous_kind;
+                    }
+                    compressed->num_runs++;
+                    run_length = 0;
+                }
+
+                if(kind == RUN_VALUES)
+                {
+                    if(pass == 1)
+                        compressed->values[compressed->num_values] = (float) cell_value;
+                    compressed->num_values++;
+                }
+
+                previous_kind = kind;
+                run_length++;
+            }
+        }
+
+        if(pass == 1)
+        {
+            compressed->run_lengths[compressed->num_runs] = run_length;
+            compressed->run_kinds[compressed->num_runs] = previous_kind;
+        }
+        compressed->num_runs++; // The last run.
+    }
+
+    current_exit->compressed_floor_field = compressed;
+    account_grid_memory(compressed_floor_field_size(compressed));
+
+    return SUCCESS;
+}
+
+/**
+ * Calculates the memory used by the runs and values of a compressed floor field.
+ * 
+ * @param compressed A compressed floor field.
+ * @return Size in bytes.
+*/
+static long compressed_floor_field_size(Compressed_Floor_Field *compressed)
+{
+    return (long) (compressed->num_runs * (sizeof(int) + sizeof(unsigned char)) + compressed->num_values * sizeof(float));
+}
+
+/**
+ * Takes an exit floor field from the pool or, if it is empty, allocates a new one.
+ * 
+ * @note The contents of a reused grid are overwritten by initialize_exit_floor_field.
+ * 
+ * @return A NULL pointer, on error, or a Double_Grid of global size.
+*/
+static Double_Grid take_floor_field()
+{
+    if(floor_field_pool.num_grids > 0)
+        return floor_field_pool.grids[--floor_field_pool.num_grids];
+
+    return allocate_cold_double_grid(cli_args.global_line_number, cli_args.global_column_number);
+}
+
+/**
+ * Places an exit floor field in the pool, to be reused by the next exits.
+ * 
+ * @param floor_field Floor field that is no longer used by its exit.
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+*/
+static Function_Status return_floor_field(Double_Grid floor_field)
+{
+    if(floor_field_pool.num_grids == floor_field_pool.capacity)
+    {
+        int new_capacity = floor_field_pool.capacity == 0 ? 8 : floor_field_pool.capacity * 2;
+        Double_Grid *new_grids = tracked_realloc(MEMORY_EXIT, floor_field_pool.grids, sizeof(Double_Grid) * new_capacity);
+        if(new_grids == NULL)
+        {
+            fprintf(stderr, "Failure in the realloc of the floor field pool.\n");
+            deallocate_grid((void **) floor_field, cli_args.global_line_number);
+            return FAILURE;
+        }
+
+        floor_field_pool.grids = new_grids;
+        floor_field_pool.capacity = new_capacity;
+    }
+
+    floor_field_pool.grids[floor_field_pool.num_grids++] = floor_field;
+
+    return SUCCESS;
+}
+
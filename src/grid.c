@@ -2,21 +2,45 @@
    File: grid.c
    Author: Daniel Gonçalves
    Date: 2024-05-20
-   Description: This module contains the declaration of grid types for integer and floating-point numbers, as well as functions to allocate, reset, copy, test limits, verify diagonal validity and deallocate those grids.
+   Description: This module contains the declaration of grid types for integer, floating-point and byte (cell type) values, as well as functions to allocate (in heap, huge page or file-backed memory), reset, copy, test limits, verify diagonal validity, build movement masks and deallocate those grids. A tiled layout is also available for read-only copies of double grids.
 */
 
 #include<stdio.h>
 #include<stdlib.h>
+#include<string.h>
 #include<stdbool.h>
+#include<fcntl.h>
+#include<unistd.h>
+#include<sys/mman.h>
 
 #include"../headers/grid.h"
+#include"../headers/arena.h"
+#include"../headers/memory.h"
+#include"../headers/profile.h"
 #include"../headers/cli_processing.h"
 #include"../headers/shared_resources.h"
 
-Int_Grid environment_only_grid = NULL; // Grid containing only the structure and exits.
+Byte_Grid environment_only_grid = NULL; // Grid containing only the structure (CELL_FLOOR or CELL_WALL). Exits are walls in it.
 Int_Grid pedestrian_position_grid = NULL; // Grid containing pedestrians at their respective positions.
 Int_Grid heatmap_grid = NULL; // Grid containing the count of pedestrian visits per cell.
 
+#define HUGE_PAGE_SIZE (2UL * 1024 * 1024)
+
+// Stored right before the array of line pointers of every grid. The cells of all lines are a single contiguous block.
+typedef struct{
+    void *block;
+    size_t block_size; // In bytes.
+    enum Grid_Backend backend;
+    int file_descriptor; // Only for file-backed grids. -1 otherwise.
+}Grid_Header;
+
+static size_t grid_memory_in_use = 0; // Bytes of all grids currently allocated (and of compressed floor fields).
+static size_t grid_memory_peak = 0;
+
+static void **allocate_grid(int line_number, int column_number, size_t cell_size, bool is_cold);
+static void *map_huge_pages(Grid_Header *header);
+static void *map_grid_file(Grid_Header *header);
+
 /**
  * Dynamically allocates an integer matrix of dimensions determined by the function parameters.
  * 
@@ -28,32 +52,7 @@ Int_Grid heatmap_grid = NULL; // Grid containing the count of pedestrian visits
  */
 Int_Grid allocate_integer_grid(int line_number, int column_number)
 {
-    if(line_number <= 0 || column_number <= 0)
-    {
-        fprintf(stderr, "At least one of the grid dimensions was negative or zero.\n");
-        return NULL;
-    }
-
-    Int_Grid new_grid = malloc(sizeof(int *) * line_number);
-    if( new_grid == NULL )
-    {
-        fprintf(stderr, "Failed to allocate memory for the lines of an integer grid.\n");
-        return NULL;
-    }
-    
-    for(int i = 0; i < line_number; i++)
-    {
-        new_grid[i] = calloc(column_number, sizeof(int));
-        if(new_grid[i] == NULL)
-        {
-            deallocate_grid((void **) new_grid, i);
-
-            fprintf(stderr, "Failed to allocate memory for the columns of the line %d of an integer grid.\n", i);
-            return NULL;
-        }
-    }
-
-    return new_grid;
+    return (Int_Grid) allocate_grid(line_number, column_number, sizeof(int), false);
 }
 
 /**
@@ -67,32 +66,86 @@ Int_Grid allocate_integer_grid(int line_number, int column_number)
  */
 Double_Grid allocate_double_grid(int line_number, int column_number)
 {
-    if(line_number <= 0 || column_number <= 0)
-    {
-        fprintf(stderr, "At least one of the grid dimensions was negative or zero.\n");
-        return NULL;
-    }
+    return (Double_Grid) allocate_grid(line_number, column_number, sizeof(double), false);
+}
 
-    double **new_grid = malloc(sizeof(double *) * line_number);
-    if( new_grid == NULL )
-    {
-        fprintf(stderr, "Failed to allocate memory for the lines of a double grid.\n");
-        return NULL;
-    }
-    
-    for(int i = 0; i < line_number; i++)
-    {
-        new_grid[i] = calloc(column_number, sizeof(double));
-        if(new_grid[i] == NULL)
-        {
-            deallocate_grid((void **) new_grid, i);
+/**
+ * Dynamically allocates an integer matrix that is rarely accessed during the timesteps. With the file backend 
+ * (--grid-backend=3), its cells are stored in a file and only the pages in use are kept in memory.
+ * 
+ * @param line_number Number of lines of the grid.
+ * @param column_number Number of columns of the grid.
+ * @return A NULL pointer, on error, or an Integer_Grid if the grid was successfully allocated.
+ * 
+ * @note All positions of the matrix are already zeroed.
+ */
+Int_Grid allocate_cold_integer_grid(int line_number, int column_number)
+{
+    return (Int_Grid) allocate_grid(line_number, column_number, sizeof(int), true);
+}
 
-            fprintf(stderr, "Failed to allocate memory for the columns of the line %d of a double grid.\n", i);
-            return NULL;
-        }
-    }
+/**
+ * Dynamically allocates a double matrix that is rarely accessed during the timesteps. With the file backend 
+ * (--grid-backend=3), its cells are stored in a file and only the pages in use are kept in memory.
+ * 
+ * @param line_number Number of lines of the grid.
+ * @param column_number Number of columns of the grid.
+ * @return A NULL pointer, on error, or an Double_Grid if the grid was successfully allocated.
+ * 
+ * @note All positions of the matrix are already zeroed.
+ */
+Double_Grid allocate_cold_double_grid(int line_number, int column_number)
+{
+    return (Double_Grid) allocate_grid(line_number, column_number, sizeof(double), true);
+}
 
-    return new_grid;
+/**
+ * Dynamically allocates a matrix of bytes, used for the cell types.
+ * 
+ * @param line_number Number of lines of the grid.
+ * @param column_number Number of columns of the grid.
+ * @return A NULL pointer, on error, or a Byte_Grid if the grid was successfully allocated.
+ * 
+ * @note All positions of the matrix are already zeroed (CELL_FLOOR).
+ */
+Byte_Grid allocate_byte_grid(int line_number, int column_number)
+{
+    return (Byte_Grid) allocate_grid(line_number, column_number, sizeof(unsigned char), false);
+}
+
+/**
+ * Dynamically allocates a matrix of bytes that is rarely accessed during the timesteps. With the file backend 
+ * (--grid-backend=3), its cells are stored in a file and only the pages in use are kept in memory.
+ * 
+ * @param line_number Number of lines of the grid.
+ * @param column_number Number of columns of the grid.
+ * @return A NULL pointer, on error, or a Byte_Grid if the grid was successfully allocated.
+ * 
+ * @note All positions of the matrix are already zeroed (CELL_FLOOR).
+ */
+Byte_Grid allocate_cold_byte_grid(int line_number, int column_number)
+{
+    return (Byte_Grid) allocate_grid(line_number, column_number, sizeof(unsigned char), true);
+}
+
+/**
+ * Removes from memory the pages of a file-backed grid, after writing them to its file. The content of the grid is kept and 
+ * the pages are read again from the file if accessed. Does nothing for grids that are not file-backed.
+ * 
+ * @param grid An integer or double grid, casted to (void **).
+ */
+void release_grid_pages(void **grid)
+{
+    if(grid == NULL)
+        return;
+
+    Grid_Header *header = ((Grid_Header *) grid) - 1;
+    if(header->file_descriptor < 0)
+        return;
+
+    msync(header->block, header->block_size, MS_SYNC);
+    madvise(header->block, header->block_size, MADV_DONTNEED);
+    posix_fadvise(header->file_descriptor, 0, header->block_size, POSIX_FADV_DONTNEED);
 }
 
 /**
@@ -119,10 +172,11 @@ Function_Status reset_integer_grid(Int_Grid integer_grid, int line_number, int c
             return FAILURE;
         }
 
-        for(int h = 0; h < column_number; h++)
-            integer_grid[i][h] = 0;
+        memset(integer_grid[i], 0, sizeof(int) * column_number);
     }
 
+    COUNT_WORK(work_counters, WORK_CELLS_RESET, (long) line_number * column_number);
+
     return SUCCESS;
 }
 
@@ -150,10 +204,11 @@ Function_Status reset_double_grid(Double_Grid double_grid, int line_number, int
             return FAILURE;
         }
 
-        for(int h = 0; h < column_number; h++)
-            double_grid[i][h] = 0.0;
+        memset(double_grid[i], 0, sizeof(double) * column_number);
     }
 
+    COUNT_WORK(work_counters, WORK_CELLS_RESET, (long) line_number * column_number);
+
     return SUCCESS;
 }
 
@@ -182,9 +237,35 @@ Function_Status copy_double_grid(Double_Grid destination, Double_Grid source)
             return FAILURE;
         }
 
+        memcpy(destination[i], source[i], sizeof(double) * cli_args.global_column_number);
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * Writes in each cell of the destination grid the smallest of its value and the value of the same cell in the source grid.
+ *
+ * @param destination Double grid where the merge is written.
+ * @param source Double grid merged into the destination.
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+ * 
+ * @note Both grids must be of global size (lines and columns). Otherwise, undefined behavior will happen.
+ */
+Function_Status merge_minimum_double_grid(Double_Grid destination, Double_Grid source)
+{
+    if(destination == NULL || source == NULL)
+    {
+        fprintf(stderr, "The destination or/and source grids received by 'merge_minimum_double_grid' was a null pointer.\n");
+        return FAILURE;
+    }
+
+    for(int i = 0; i < cli_args.global_line_number; i++)
+    {
         for(int h = 0; h < cli_args.global_column_number; h++)
         {
-            destination[i][h] = source[i][h];
+            if(destination[i][h] > source[i][h])
+                destination[i][h] = source[i][h];
         }
     }
 
@@ -192,30 +273,118 @@ Function_Status copy_double_grid(Double_Grid destination, Double_Grid source)
 }
 
 /**
- * Verifies if a diagonal beginning at origin_cell and ending at origin_cell + coordinate_modifier is valid for crossing 
- * in the given floor field. 
+ * Allocates a grid stored in square tiles, for the read-only copy of a grid that is scanned by neighborhoods.
+ * 
+ * @note The last line and column of tiles may be partially used.
+ * 
+ * @param line_number Number of lines of the grid.
+ * @param column_number Number of columns of the grid.
+ * @return A NULL pointer, on error, or the Tiled_Double_Grid.
+*/
+Tiled_Double_Grid *allocate_tiled_double_grid(int line_number, int column_number)
+{
+    if(line_number <= 0 || column_number <= 0)
+    {
+        fprintf(stderr, "At least one of the grid dimensions was negative or zero.\n");
+        return NULL;
+    }
+
+    Tiled_Double_Grid *tiled_grid = tracked_malloc(MEMORY_GRID, sizeof(Tiled_Double_Grid));
+    if(tiled_grid == NULL)
+    {
+        fprintf(stderr, "Failed to allocate memory for a tiled grid.\n");
+        return NULL;
+    }
+
+    int tile_lines = (line_number + TILE_SIDE - 1) / TILE_SIDE;
+    tiled_grid->line_number = line_number;
+    tiled_grid->column_number = column_number;
+    tiled_grid->tiles_per_line = (column_number + TILE_SIDE - 1) / TILE_SIDE;
+    tiled_grid->cells = tracked_calloc(MEMORY_GRID, (size_t) tile_lines * tiled_grid->tiles_per_line * TILE_SIDE * TILE_SIDE, sizeof(double));
+    if(tiled_grid->cells == NULL)
+    {
+        fprintf(stderr, "Failed to allocate memory for the cells of a %d x %d tiled grid.\n", line_number, column_number);
+        tracked_free(tiled_grid);
+        return NULL;
+    }
+
+    account_grid_memory((long) ((size_t) tile_lines * tiled_grid->tiles_per_line * TILE_SIDE * TILE_SIDE * sizeof(double)));
+
+    return tiled_grid;
+}
+
+/**
+ * Copies a grid stored line by line to a tiled grid of the same dimensions.
+ * 
+ * @param destination Tiled grid where the cells will be written.
+ * @param source Double grid to be copied.
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+*/
+Function_Status copy_to_tiled_double_grid(Tiled_Double_Grid *destination, Double_Grid source)
+{
+    if(destination == NULL || source == NULL)
+    {
+        fprintf(stderr, "The destination or/and source grids received by 'copy_to_tiled_double_grid' was a null pointer.\n");
+        return FAILURE;
+    }
+
+    for(int i = 0; i < destination->line_number; i++)
+    {
+        size_t tile_line_start = (size_t) (i / TILE_SIDE) * destination->tiles_per_line * TILE_SIDE * TILE_SIDE;
+        int line_bits = spread_tile_bits(i % TILE_SIDE) << 1;
+
+        for(int h = 0; h < destination->column_number; h++)
+        {
+            size_t tile_start = tile_line_start + (size_t) (h / TILE_SIDE) * TILE_SIDE * TILE_SIDE;
+            destination->cells[tile_start + (spread_tile_bits(h % TILE_SIDE) | line_bits)] = source[i][h];
+        }
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * Deallocate a tiled grid.
+ * 
+ * @param tiled_grid Tiled grid to be deallocated. May be NULL.
+*/
+void deallocate_tiled_double_grid(Tiled_Double_Grid *tiled_grid)
+{
+    if(tiled_grid == NULL)
+        return;
+
+    int tile_lines = (tiled_grid->line_number + TILE_SIDE - 1) / TILE_SIDE;
+    account_grid_memory(-(long) ((size_t) tile_lines * tiled_grid->tiles_per_line * TILE_SIDE * TILE_SIDE * sizeof(double)));
+
+    tracked_free(tiled_grid->cells);
+    tracked_free(tiled_grid);
+}
+
+/**
+ * Verifies if a diagonal beginning at origin_cell and ending at origin_cell + coordinate_modifier is valid for crossing. 
  * If there are obstacles on both sides, then the diagonal is not valid. If the prevent_corner_crossing flag is True, 
  * then diagonals with at least one obstacle on its sides are not valid.
  *
  * @param origin_cell Origin cell coordinates. Represents where a pedestrian is or a cell whose neighborhood is being calculated.
  * @param coordinate_modifier Line and column coordinate modifiers. They are added to the origin cell coordinates, and the final 
  * result represents one of the four diagonal cells in the origin cell's neighborhood.
- * @param floor_field A Double_Grid representing a floor field.
+ * @param cell_types A Byte_Grid with the enum Cell_Type of each cell.
+ * @param blocking_types Mask, built with CELL_TYPE_BIT, of the cell types that are obstacles.
  * @return bool, where True indicates that a diagonal is valid and False otherwise.
  */
-bool is_diagonal_valid(Location origin_cell, Location coordinate_modifier, Double_Grid floor_field)
+bool is_diagonal_valid(Location origin_cell, Location coordinate_modifier, Byte_Grid cell_types, int blocking_types)
 {
     bool is_horizontal_blocked = false; // Indicates if the horizontal cell in the origin_cell's neighborhood, which is adjacent to origin_cell + coordinate_modifier, is blocked.
     bool is_vertical_blocked = false;// Indicates if the vertical cell in the origin_cell's neighborhood, which is adjacent to origin_cell + coordinate_modifier, is blocked.
 
     if(is_within_grid_lines(origin_cell.lin + coordinate_modifier.lin) && 
-    floor_field[origin_cell.lin + coordinate_modifier.lin][origin_cell.col] == WALL_VALUE)
+    CELL_TYPE_BIT(cell_types[origin_cell.lin + coordinate_modifier.lin][origin_cell.col]) & blocking_types)
     {
         is_vertical_blocked = true;
     }
 
     if(is_within_grid_columns(origin_cell.col + coordinate_modifier.col) && 
-    floor_field[origin_cell.lin][origin_cell.col + coordinate_modifier.col] == WALL_VALUE)
+    CELL_TYPE_BIT(cell_types[origin_cell.lin][origin_cell.col + coordinate_modifier.col]) & blocking_types)
     {
         is_horizontal_blocked = true;
     }
@@ -229,6 +398,63 @@ bool is_diagonal_valid(Location origin_cell, Location coordinate_modifier, Doubl
     return true;
 }
 
+/**
+ * Calculates which neighbors of a cell can be reached from it, combining the grid limits, the cell types and the diagonal 
+ * rules of is_diagonal_valid.
+ * 
+ * @param cell_types A Byte_Grid with the enum Cell_Type of each cell.
+ * @param cell Coordinates of the cell.
+ * @param target_types Mask, built with CELL_TYPE_BIT, of the cell types that can be reached.
+ * @param blocking_types Mask, built with CELL_TYPE_BIT, of the cell types that are obstacles. Obstacles have no moves.
+ * @return The movement mask of the cell, with the bit of get_direction_bit set for each reachable neighbor.
+*/
+unsigned char calculate_movement_mask(Byte_Grid cell_types, Location cell, int target_types, int blocking_types)
+{
+    unsigned char movement_mask = 0;
+
+    if(CELL_TYPE_BIT(cell_types[cell.lin][cell.col]) & blocking_types)
+        return 0;
+
+    for(int j = -1; j < 2; j++)
+    {
+        if(! is_within_grid_lines(cell.lin + j))
+            continue;
+
+        for(int k = -1; k < 2; k++)
+        {
+            if((j == 0 && k == 0) || ! is_within_grid_columns(cell.col + k))
+                continue;
+
+            if(! (CELL_TYPE_BIT(cell_types[cell.lin + j][cell.col + k]) & target_types))
+                continue;
+
+            if(j != 0 && k != 0 && ! is_diagonal_valid(cell, (Location){j,k}, cell_types, blocking_types))
+                continue;
+
+            movement_mask |= get_direction_bit(j, k);
+        }
+    }
+
+    return movement_mask;
+}
+
+/**
+ * Calculates the movement mask of every cell, so that the neighborhood scans need a single lookup per cell.
+ * 
+ * @param movement_masks Byte grid of global size where the masks will be written.
+ * @param cell_types A Byte_Grid with the enum Cell_Type of each cell.
+ * @param target_types Mask, built with CELL_TYPE_BIT, of the cell types that can be reached.
+ * @param blocking_types Mask, built with CELL_TYPE_BIT, of the cell types that are obstacles.
+*/
+void build_movement_masks(Byte_Grid movement_masks, Byte_Grid cell_types, int target_types, int blocking_types)
+{
+    for(int i = 0; i < cli_args.global_line_number; i++)
+    {
+        for(int h = 0; h < cli_args.global_column_number; h++)
+            movement_masks[i][h] = calculate_movement_mask(cell_types, (Location){i,h}, target_types, blocking_types);
+    }
+}
+
 /**
  * Verifies if the value passed to the function is within the grid lines limits, i. e., 0 <= line_coordinate < cli_args.global_line_number.
  * 
@@ -253,21 +479,180 @@ bool is_within_grid_columns(int column_coordinate)
 }
 
 /**
- * Deallocate all memory assigned to a integer grid.
+ * Deallocate all memory assigned to a integer or double grid, according to the backend used to allocate it.
  *
  * @param grid An integer or double grid, casted to (void **).
- * @param line_number Number of lines of the grid that should be deallocated.
+ * @param line_number Number of lines of the grid (the cells of all lines are stored in a single block).
  */
 void deallocate_grid(void **grid, int line_number)
 {
+    (void) line_number;
+
     if(grid != NULL)
     {
-        for(int i = 0; i < line_number; i++)
+        Grid_Header *header = ((Grid_Header *) grid) - 1;
+
+        if(header->backend == BACKEND_HEAP)
+            tracked_free(header->block);
+        else
         {
-            free(grid[i]);
+            munmap(header->block, header->block_size);
+            record_deallocation(MEMORY_GRID, header->block_size);
         }
-        free(grid);
 
-        grid = NULL;
+        if(header->file_descriptor >= 0)
+            close(header->file_descriptor);
+
+        account_grid_memory(-(long) header->block_size);
+        tracked_free(header);
+    }
+}
+
+/**
+ * Adds (or, if negative, subtracts) the given number of bytes to the grid memory in use, updating its peak.
+ * 
+ * @param num_bytes Number of bytes allocated (positive) or deallocated (negative).
+ */
+void account_grid_memory(long num_bytes)
+{
+    grid_memory_in_use += num_bytes;
+    if(grid_memory_in_use > grid_memory_peak)
+        grid_memory_peak = grid_memory_in_use;
+}
+
+/**
+ * Makes the peak of grid memory equal to the memory currently in use. Called at the beginning of each simulation set.
+ */
+void reset_peak_grid_memory()
+{
+    grid_memory_peak = grid_memory_in_use;
+}
+
+/**
+ * Returns the largest amount of memory used by grids since the last call to reset_peak_grid_memory.
+ * 
+ * @return Peak of grid memory, in bytes.
+ */
+size_t get_peak_grid_memory()
+{
+    return grid_memory_peak;
+}
+
+/* ---------------- ---------------- ---------------- ---------------- ---------------- */
+/* ---------------- ---------------- STATIC FUNCTIONS ---------------- ---------------- */
+/* ---------------- ---------------- ---------------- ---------------- ---------------- */
+
+/**
+ * Allocates a grid as a single zeroed block of cells, using the backend chosen with --grid-backend, and an array of pointers 
+ * to the beginning of each line. The Grid_Header is stored right before the array of line pointers.
+ * 
+ * @param line_number Number of lines of the grid.
+ * @param column_number Number of columns of the grid.
+ * @param cell_size Size of each cell, in bytes.
+ * @param is_cold True if the grid is rarely accessed during the timesteps (only relevant for the file backend).
+ * @return A NULL pointer, on error, or the array of line pointers.
+ */
+static void **allocate_grid(int line_number, int column_number, size_t cell_size, bool is_cold)
+{
+    if(line_number <= 0 || column_number <= 0)
+    {
+        fprintf(stderr, "At least one of the grid dimensions was negative or zero.\n");
+        return NULL;
+    }
+
+    Grid_Header *header = tracked_malloc(MEMORY_GRID, sizeof(Grid_Header) + sizeof(void *) * line_number);
+    if(header == NULL)
+    {
+        fprintf(stderr, "Failed to allocate memory for the lines of a grid.\n");
+        return NULL;
+    }
+
+    header->block_size = (size_t) line_number * column_number * cell_size;
+    header->backend = cli_args.grid_backend;
+    header->file_descriptor = -1;
+    header->block = NULL;
+
+    if(header->backend == BACKEND_HEAP)
+        header->block = tracked_calloc(MEMORY_GRID, header->block_size, 1);
+    else if(header->backend == BACKEND_FILE && is_cold)
+        header->block = map_grid_file(header);
+    else
+        header->block = map_huge_pages(header);
+
+    if(header->block == NULL)
+    {
+        fprintf(stderr, "Failed to allocate memory for the cells of a %d x %d grid.\n", line_number, column_number);
+        tracked_free(header);
+        return NULL;
+    }
+
+    account_grid_memory((long) header->block_size);
+    if(header->backend != BACKEND_HEAP)
+        record_allocation(MEMORY_GRID, header->block_size);
+
+    void **grid = (void **) (header + 1);
+    for(int i = 0; i < line_number; i++)
+        grid[i] = (char *) header->block + (size_t) i * column_number * cell_size;
+
+    return grid;
+}
+
+/**
+ * Maps anonymous (zeroed) memory for the cells of a grid, asking the kernel to back it with transparent huge pages.
+ * With 2 MB pages, the scans over the grid need far fewer TLB entries than with 4 KB pages.
+ * 
+ * @param header Header of the grid, with the block_size already filled. block_size is rounded up to whole huge pages.
+ * @return A NULL pointer, on error, or the address of the mapping.
+ */
+static void *map_huge_pages(Grid_Header *header)
+{
+    header->block_size = (header->block_size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+
+    void *block = mmap(NULL, header->block_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if(block == MAP_FAILED)
+        return NULL;
+
+#ifdef MADV_HUGEPAGE
+    madvise(block, header->block_size, MADV_HUGEPAGE); // Only a hint: the mapping is still valid if huge pages are unavailable.
+#endif
+
+    return block;
+}
+
+/**
+ * Maps the cells of a grid to a new temporary file in the directory given by --grid-directory. The file is removed from the 
+ * directory right away, so it disappears when the program ends. Pages that aren't accessed are written to the file and 
+ * evicted by the kernel, so only the parts of the grid in use stay in memory.
+ * 
+ * @param header Header of the grid, with the block_size already filled. Its file_descriptor is filled here.
+ * @return A NULL pointer, on error, or the address of the mapping.
+ */
+static void *map_grid_file(Grid_Header *header)
+{
+    char file_name[sizeof(cli_args.grid_directory) + 20];
+    sprintf(file_name, "%s/varas_grid_XXXXXX", cli_args.grid_directory);
+
+    header->file_descriptor = mkstemp(file_name);
+    if(header->file_descriptor < 0)
+    {
+        fprintf(stderr, "It was not possible to create a grid file in '%s'.\n", cli_args.grid_directory);
+        return NULL;
+    }
+
+    unlink(file_name);
+
+    if(ftruncate(header->file_descriptor, (off_t) header->block_size) != 0)
+    {
+        close(header->file_descriptor);
+        return NULL;
+    }
+
+    void *block = mmap(NULL, header->block_size, PROT_READ | PROT_WRITE, MAP_SHARED, header->file_descriptor, 0);
+    if(block == MAP_FAILED)
+    {
+        close(header->file_descriptor);
+        return NULL;
     }
-}
\ No newline at end of file
+
+    return block;
+}
@@ -14,6 +14,7 @@
 
 #include"../headers/grid.h"
 #include"../headers/exit.h"
+#include"../headers/layout.h"
 #include"../headers/pedestrian.h"
 #include"../headers/initialization.h"
 #include"../headers/cli_processing.h"
@@ -23,8 +24,13 @@ const char *environment_path = "environments/";
 const char *auxiliary_path = "auxiliary/";
 const char *output_path = "output/";
 
+#define OUTPUT_BUFFER_SIZE (1 << 20) // Bytes of the stdio buffer of an output file.
+
+static char output_buffer[OUTPUT_BUFFER_SIZE];
+
 static Function_Status open_environment_file(FILE **environment_file);
 static Function_Status symbol_processing(char read_char, Location coordinates);
+static Function_Status save_environment();
 
 /**
  * Opens the auxiliary file in read mode.  
@@ -70,20 +76,28 @@ Function_Status open_output_file(FILE **output_file)
         if(strcmp(cli_args.output_filename, "") == 0)
         {
             char *output_type_name;
+            char *extension = "txt";
             if(cli_args.output_format == 1)
                 output_type_name = "visual";
             else if(cli_args.output_format == 2)
                 output_type_name = "evacuation_time";
             else if(cli_args.output_format == 3)
                 output_type_name = "heatmap";
+            else if(cli_args.output_format == 5)
+                output_type_name = "statistics";
+            else
+            {
+                output_type_name = "results";
+                extension = "bin";
+            }
             
             time_t current_time = time(NULL);
 	        struct tm * time_information = localtime(&current_time);
 	
 	        strftime(date_time,50,"%F_%Z_%T",time_information);
 
-            sprintf(complete_path,"%s%s-%s-%s.txt", output_path, output_type_name, 
-                    cli_args.environment_filename,date_time);
+            sprintf(complete_path,"%s%s-%s-%s.%s", output_path, output_type_name, 
+                    cli_args.environment_filename,date_time,extension);
         }
         else
             sprintf(complete_path,"%s%s",output_path,cli_args.output_filename);
@@ -95,6 +109,7 @@ Function_Status open_output_file(FILE **output_file)
             fprintf(stderr, "It was not possible to open the output file.\n");
             return FAILURE;
         }
+        setvbuf(*output_file, output_buffer, _IOFBF, OUTPUT_BUFFER_SIZE); // The file is only written when a large block is filled.
     }
     else
         *output_file = stdout;
@@ -103,18 +118,18 @@ Function_Status open_output_file(FILE **output_file)
 }
 
 /**
- * Allocates the integer grids necessary for the program (environment, pedestrian and heatmap grids).
+ * Allocates the grids necessary for the program (environment, pedestrian and heatmap grids).
  *  
  * @return Function_Status: FAILURE (0) or SUCCESS (1).
 */
 Function_Status allocate_grids()
 {
-    environment_only_grid = allocate_integer_grid(cli_args.global_line_number, cli_args.global_column_number);
+    environment_only_grid = allocate_cold_byte_grid(cli_args.global_line_number, cli_args.global_column_number);
     pedestrian_position_grid = allocate_integer_grid(cli_args.global_line_number, cli_args.global_column_number);
-    heatmap_grid = allocate_integer_grid(cli_args.global_line_number, cli_args.global_column_number);
+    heatmap_grid = allocate_cold_integer_grid(cli_args.global_line_number, cli_args.global_column_number); // Only the cells with pedestrians are accessed.
     if(environment_only_grid == NULL || pedestrian_position_grid == NULL || heatmap_grid == NULL)
     {
-        fprintf(stderr,"Failure during allocation of the integer grids with dimensions: %d x %d.\n", cli_args.global_line_number, cli_args.global_column_number);
+        fprintf(stderr,"Failure during allocation of the grids with dimensions: %d x %d.\n", cli_args.global_line_number, cli_args.global_column_number);
         return FAILURE;
     }
 
@@ -182,7 +197,9 @@ Function_Status load_environment()
 }
 
 /**
- * Generates a rectangular environment with dimensions specified by global_line_number and global_column_number.The edges will have walls, while the rest of the room will be empty.
+ * Generates a rectangular environment with dimensions specified by global_line_number and global_column_number.The edges will have walls, while the rest of the room will be empty or filled with the layout chosen by --env-layout.
+ * 
+ * @note With --save-env, the environment is also written to a file.
  * 
  * @return Function_Status: FAILURE (0) or SUCCESS (1).
 */
@@ -196,12 +213,18 @@ Function_Status generate_environment()
         for(int h = 0; h < cli_args.global_column_number; h++)
         {
             if(i > 0 && i < cli_args.global_line_number - 1 && h > 0 && h < cli_args.global_column_number - 1)
-                environment_only_grid[i][h] = 0;
+                environment_only_grid[i][h] = CELL_FLOOR;
             else
-                environment_only_grid[i][h] = WALL_VALUE;
+                environment_only_grid[i][h] = CELL_WALL;
         }
     }
 
+    if(cli_args.environment_layout != ENVIRONMENT_EMPTY && generate_layout() == FAILURE)
+        return FAILURE;
+
+    if(cli_args.save_environment && save_environment() == FAILURE)
+        return FAILURE;
+
     return SUCCESS;
 }
 
@@ -350,7 +373,7 @@ static Function_Status symbol_processing(char read_char, Location coordinates)
     switch(read_char)
     {
         case '#':
-            environment_only_grid[coordinates.lin][coordinates.col] = WALL_VALUE;
+            environment_only_grid[coordinates.lin][coordinates.col] = CELL_WALL;
             break;
         case '_':
             if(origin_uses_static_exits() == true)
@@ -358,14 +381,14 @@ static Function_Status symbol_processing(char read_char, Location coordinates)
                 if(add_new_exit(coordinates) == FAILURE)
                     return FAILURE;
                 
-                environment_only_grid[coordinates.lin][coordinates.col] = WALL_VALUE;
+                environment_only_grid[coordinates.lin][coordinates.col] = CELL_WALL;
             }
             else
-                environment_only_grid[coordinates.lin][coordinates.col] = WALL_VALUE;
+                environment_only_grid[coordinates.lin][coordinates.col] = CELL_WALL;
                 // If a exit is located in the middle of the environment a Wall is still put there.
             break;
         case '.':
-            environment_only_grid[coordinates.lin][coordinates.col] = 0;
+            environment_only_grid[coordinates.lin][coordinates.col] = CELL_FLOOR;
             break;
         case 'p':
         case 'P':
@@ -377,7 +400,7 @@ static Function_Status symbol_processing(char read_char, Location coordinates)
                 pedestrian_position_grid[coordinates.lin][coordinates.col] = pedestrian_set.list[pedestrian_set.num_pedestrians - 1]->id;
             }
             else
-                environment_only_grid[coordinates.lin][coordinates.col] = 0;
+                environment_only_grid[coordinates.lin][coordinates.col] = CELL_FLOOR;
 
             break;
         case '\n':
@@ -388,4 +411,37 @@ static Function_Status symbol_processing(char read_char, Location coordinates)
     }
 
     return SUCCESS;
-}
\ No newline at end of file
+}
+
+/**
+ * Writes the structure of the environment (walls, obstacles and empty cells) to the file provided by the --save-env option, 
+ * in the environments directory, with the syntax of the files read by load_environment.
+ * 
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+*/
+static Function_Status save_environment()
+{
+    char complete_path[300] = "";
+    sprintf(complete_path,"%s%s",environment_path,cli_args.saved_environment_filename);
+
+    FILE *environment_file = fopen(complete_path,"w");
+    if(environment_file == NULL)
+    {
+        fprintf(stderr, "It was not possible to open the file where the environment is saved.\n");
+        return FAILURE;
+    }
+
+    fprintf(environment_file, "%d %d\n", cli_args.global_line_number, cli_args.global_column_number);
+    for(int i = 0; i < cli_args.global_line_number; i++)
+    {
+        for(int h = 0; h < cli_args.global_column_number; h++)
+            fputc(environment_only_grid[i][h] == CELL_WALL ? '#' : '.', environment_file);
+        
+        if(i < cli_args.global_line_number - 1)
+            fputc('\n', environment_file);
+    }
+
+    fclose(environment_file);
+
+    return SUCCESS;
+}
@@ -0,0 +1,335 @@
+/*
+   File: layout.c
+   Author: Daniel Gonçalves
+   Date: 2026-10-18
+   Description: This module implements the procedural layouts of the automatically created environments (--env-layout): tiled classrooms, corridors lined with rooms, random obstacle fields and mazes. The layouts are drawn directly into the environment grid, with a random number generator of their own seeded by --layout-seed, so the random draws of the simulations are the same for any layout.
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<stdint.h>
+#include<stdbool.h>
+
+#include"../headers/grid.h"
+#include"../headers/layout.h"
+#include"../headers/memory.h"
+#include"../headers/cli_processing.h"
+
+#define CLASSROOM_LINES 16
+#define CLASSROOM_COLUMNS 20
+#define CLASSROOM_SPACING 2 // Width of the corridors between the classrooms.
+#define ROOM_DEPTH 8 // Lines of the rooms of the corridors layout, including their walls.
+#define ROOM_MIN_WIDTH 6 // Columns of the rooms of the corridors layout, including their walls.
+#define ROOM_MAX_WIDTH 14
+#define CORRIDOR_WIDTH 3
+#define DOOR_WIDTH 2
+
+// Classroom of varas_classroom_with_obstacles.txt without its pedestrians, with doors on the left and right walls.
+static const char *classroom_template[CLASSROOM_LINES] = {
+    "####################",
+    "#...#..#..#..#..#..#",
+    "#...#..#..#..#..#..#",
+    "#...#..#..#..#..#..#",
+    "...................#",
+    "...................#",
+    "#...#..#..#..#..#..#",
+    "#...#..#..#..#..#..#",
+    "#...#..#..#..#..#..#",
+    "#...#..#..#..#..#..#",
+    "#...................",
+    "#...................",
+    "#...#..#..#..#..#..#",
+    "#...#..#..#..#..#..#",
+    "#...#..#..#..#..#..#",
+    "####################"
+};
+
+static uint64_t layout_random_state;
+
+static void generate_classrooms();
+static void generate_corridors();
+static void generate_obstacle_field();
+static void generate_maze();
+static void fill_cells(int first_line, int last_line, int first_column, int last_column, unsigned char cell_type);
+static Function_Status remove_enclosed_cells();
+static uint64_t next_layout_random();
+static int layout_random_below(int bound);
+
+/**
+ * Draws the layout chosen by --env-layout into the environment grid, which must already hold the walled rectangle of the
+ * environment. A corridor of one cell is kept along the walls, so exits placed anywhere on the walls (except the corners)
+ * are accessible, and cells that can't reach it are turned into obstacles, so every pedestrian can leave the environment.
+ *
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+*/
+Function_Status generate_layout()
+{
+    layout_random_state = (uint64_t) (uint32_t) cli_args.layout_seed;
+
+    switch(cli_args.environment_layout)
+    {
+        case ENVIRONMENT_CLASSROOMS:
+            generate_classrooms();
+            break;
+        case ENVIRONMENT_CORRIDORS:
+            generate_corridors();
+            break;
+        case ENVIRONMENT_OBSTACLES:
+            generate_obstacle_field();
+            break;
+        case ENVIRONMENT_MAZE:
+            generate_maze();
+            break;
+        default:
+            return SUCCESS;
+    }
+
+    return remove_enclosed_cells();
+}
+
+/* ---------------- ---------------- ---------------- ---------------- ---------------- */
+/* ---------------- ---------------- STATIC FUNCTIONS ---------------- ---------------- */
+/* ---------------- ---------------- ---------------- ---------------- ---------------- */
+
+/**
+ * Tiles the environment with copies of classroom_template, separated by corridors of CLASSROOM_SPACING cells. The space
+ * left by the classrooms that don't fit is kept empty.
+*/
+static void generate_classrooms()
+{
+    for(int top = 2; top + CLASSROOM_LINES - 1 <= cli_args.global_line_number - 3; top += CLASSROOM_LINES + CLASSROOM_SPACING)
+    {
+        for(int left = 2; left + CLASSROOM_COLUMNS - 1 <= cli_args.global_column_number - 3; left += CLASSROOM_COLUMNS + CLASSROOM_SPACING)
+        {
+            for(int i = 0; i < CLASSROOM_LINES; i++)
+            {
+                for(int h = 0; h < CLASSROOM_COLUMNS; h++)
+                    environment_only_grid[top + i][left + h] = classroom_template[i][h] == '#' ? CELL_WALL : CELL_FLOOR;
+            }
+        }
+    }
+}
+
+/**
+ * Fills the environment with rows of rooms of ROOM_DEPTH lines, separated by corridors of CORRIDOR_WIDTH lines. The rooms of
+ * a row share their side walls and have random widths, between ROOM_MIN_WIDTH and ROOM_MAX_WIDTH, and each one has a door of
+ * DOOR_WIDTH cells at a random position of its top or bottom wall.
+*/
+static void generate_corridors()
+{
+    for(int top = 2; top + ROOM_DEPTH - 1 <= cli_args.global_line_number - 3; top += ROOM_DEPTH + CORRIDOR_WIDTH)
+    {
+        int bottom = top + ROOM_DEPTH - 1;
+        int left = 2;
+
+        while(left + ROOM_MIN_WIDTH - 1 <= cli_args.global_column_number - 3)
+        {
+            int width = ROOM_MIN_WIDTH + layout_random_below(ROOM_MAX_WIDTH - ROOM_MIN_WIDTH + 1);
+            if(left + width - 1 > cli_args.global_column_number - 3)
+                width = cli_args.global_column_number - 2 - left;
+
+            int right = left + width - 1;
+            fill_cells(top, bottom, left, right, CELL_WALL);
+            fill_cells(top + 1, bottom - 1, left + 1, right - 1, CELL_FLOOR);
+
+            int door_line = layout_random_below(2) == 0 ? top : bottom;
+            int door_column = left + 1 + layout_random_below(width - 1 - DOOR_WIDTH);
+            fill_cells(door_line, door_line, door_column, door_column + DOOR_WIDTH - 1, CELL_FLOOR);
+
+            left = right; // The next room shares this wall.
+        }
+    }
+}
+
+/**
+ * Turns each cell inside the corridor along the walls into an obstacle with the probability given by --obstacle-density.
+*/
+static void generate_obstacle_field()
+{
+    // The comparison is made with 53 random bits, the precision of a double.
+    for(int i = 2; i <= cli_args.global_line_number - 3; i++)
+    {
+        for(int h = 2; h <= cli_args.global_column_number - 3; h++)
+        {
+            if((next_layout_random() >> 11) * 0x1.0p-53 < cli_args.obstacle_density)
+                environment_only_grid[i][h] = CELL_WALL;
+        }
+    }
+}
+
+/**
+ * Draws a maze with passages of one cell inside the corridor along the walls, with the sidewinder algorithm, which carves it
+ * line by line without auxiliary memory. The maze cells are at odd lines and columns, and there is one opening to the
+ * corridor, at a random position, on each side of the maze.
+*/
+static void generate_maze()
+{
+    int maze_lines = (cli_args.global_line_number - 5) / 2; // Maze cells at lines 3, 5, ..., up to global_line_number - 4.
+    int maze_columns = (cli_args.global_column_number - 5) / 2;
+    if(maze_lines < 1 || maze_columns < 1)
+        return;
+
+    fill_cells(2, cli_args.global_line_number - 3, 2, cli_args.global_column_number - 3, CELL_WALL);
+
+    for(int line = 0; line < maze_lines; line++)
+    {
+        int i = 3 + 2 * line;
+        int run_start = 0;
+
+        for(int column = 0; column < maze_columns; column++)
+        {
+            int h = 3 + 2 * column;
+            environment_only_grid[i][h] = CELL_FLOOR;
+
+            bool is_last_column = column == maze_columns - 1;
+            // The first line is a single passage. In the other lines, each run of cells is closed with a passage to the line above.
+            if(line > 0 && (is_last_column || layout_random_below(2) == 0))
+            {
+                int chosen_column = run_start + layout_random_below(column - run_start + 1);
+                environment_only_grid[i - 1][3 + 2 * chosen_column] = CELL_FLOOR;
+                run_start = column + 1;
+            }
+            else if(! is_last_column)
+                environment_only_grid[i][h + 1] = CELL_FLOOR;
+        }
+    }
+
+    int last_maze_line = 3 + 2 * (maze_lines - 1);
+    int last_maze_column = 3 + 2 * (maze_columns - 1);
+    int opening = 3 + 2 * layout_random_below(maze_columns);
+    fill_cells(2, 2, opening, opening, CELL_FLOOR);
+    opening = 3 + 2 * layout_random_below(maze_columns);
+    fill_cells(last_maze_line + 1, cli_args.global_line_number - 3, opening, opening, CELL_FLOOR);
+    opening = 3 + 2 * layout_random_below(maze_lines);
+    fill_cells(opening, opening, 2, 2, CELL_FLOOR);
+    opening = 3 + 2 * layout_random_below(maze_lines);
+    fill_cells(opening, opening, last_maze_column + 1, cli_args.global_column_number - 3, CELL_FLOOR);
+}
+
+/**
+ * Sets all cells of a rectangle of the environment to the given type.
+ *
+ * @param first_line First line of the rectangle.
+ * @param last_line Last line of the rectangle (inclusive).
+ * @param first_column First column of the rectangle.
+ * @param last_column Last column of the rectangle (inclusive).
+ * @param cell_type Cell_Type assigned to the cells.
+*/
+static void fill_cells(int first_line, int last_line, int first_column, int last_column, unsigned char cell_type)
+{
+    for(int i = first_line; i <= last_line; i++)
+    {
+        for(int h = first_column; h <= last_column; h++)
+            environment_only_grid[i][h] = cell_type;
+    }
+}
+
+/**
+ * Turns into obstacles the empty cells that can't be reached from the corridor along the walls, moving only between cells
+ * that share a side. The reachable cells are found with a scanline flood fill, whose stack holds segments of lines instead
+ * of cells.
+ *
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+*/
+static Function_Status remove_enclosed_cells()
+{
+    if(cli_args.global_line_number < 3 || cli_args.global_column_number < 3)
+        return SUCCESS;
+
+    Byte_Grid reached = allocate_byte_grid(cli_args.global_line_number, cli_args.global_column_number);
+    int stack_capacity = 1024, stack_size = 0;
+    Location *stack = tracked_malloc(MEMORY_GRID, sizeof(Location) * stack_capacity);
+    if(reached == NULL || stack == NULL)
+    {
+        fprintf(stderr, "Failure during the allocation of the structures used to generate the environment layout.\n");
+        deallocate_grid((void **) reached, cli_args.global_line_number);
+        tracked_free(stack);
+        return FAILURE;
+    }
+
+    // The environment is surrounded by walls, so the fill never leaves the grid.
+    stack[stack_size++] = (Location) {1, 1};
+    while(stack_size > 0)
+    {
+        Location cell = stack[--stack_size];
+        unsigned char *line = environment_only_grid[cell.lin];
+        if(line[cell.col] != CELL_FLOOR || reached[cell.lin][cell.col])
+            continue;
+
+        int first_column = cell.col, last_column = cell.col;
+        while(line[first_column - 1] == CELL_FLOOR && ! reached[cell.lin][first_column - 1])
+            first_column--;
+        while(line[last_column + 1] == CELL_FLOOR && ! reached[cell.lin][last_column + 1])
+            last_column++;
+
+        for(int h = first_column; h <= last_column; h++)
+            reached[cell.lin][h] = true;
+
+        // The first cell of each segment of unreached empty cells of the neighboring lines is stacked.
+        for(int i = cell.lin - 1; i <= cell.lin + 1; i += 2)
+        {
+            bool in_segment = false;
+            for(int h = first_column; h <= last_column; h++)
+            {
+                bool is_open = environment_only_grid[i][h] == CELL_FLOOR && ! reached[i][h];
+                if(is_open && ! in_segment)
+                {
+                    if(stack_size == stack_capacity)
+                    {
+                        Location *larger_stack = tracked_realloc(MEMORY_GRID, stack, sizeof(Location) * stack_capacity * 2);
+                        if(larger_stack == NULL)
+                        {
+                            fprintf(stderr, "Failure during the allocation of the structures used to generate the environment layout.\n");
+                            deallocate_grid((void **) reached, cli_args.global_line_number);
+                            tracked_free(stack);
+                            return FAILURE;
+                        }
+                        stack = larger_stack;
+                        stack_capacity *= 2;
+                    }
+                    stack[stack_size++] = (Location) {i, h};
+                }
+                in_segment = is_open;
+            }
+        }
+    }
+
+    for(int i = 1; i < cli_args.global_line_number - 1; i++)
+    {
+        for(int h = 1; h < cli_args.global_column_number - 1; h++)
+        {
+            if(environment_only_grid[i][h] == CELL_FLOOR && ! reached[i][h])
+                environment_only_grid[i][h] = CELL_WALL;
+        }
+    }
+
+    deallocate_grid((void **) reached, cli_args.global_line_number);
+    tracked_free(stack);
+
+    return SUCCESS;
+}
+
+/**
+ * Draws the next number of the splitmix64 generator of the layouts.
+ *
+ * @return A pseudo-random 64-bit unsigned integer.
+*/
+static uint64_t next_layout_random()
+{
+    uint64_t z = (layout_random_state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+    return z ^ (z >> 31);
+}
+
+/**
+ * Draws a pseudo-random integer from the generator of the layouts.
+ *
+ * @param bound A positive integer.
+ * @return An integer between 0 and bound - 1.
+*/
+static int layout_random_below(int bound)
+{
+    return (int) (next_layout_random() % (uint64_t) bound);
+}
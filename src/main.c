@@ -12,6 +12,16 @@
 #include<unistd.h>
 
 #include"../headers/exit.h"
+#include"../headers/arena.h"
+#include"../headers/memory.h"
+#include"../headers/batch.h"
+#include"../headers/trace.h"
+#include"../headers/status.h"
+#include"../headers/profile.h"
+#include"../headers/parallel.h"
+#include"../headers/telemetry.h"
+#include"../headers/binary_output.h"
+#include"../headers/statistics.h"
 #include"../headers/pedestrian.h"
 #include"../headers/initialization.h"
 #include"../headers/cli_processing.h"
@@ -20,6 +30,7 @@
 
 static Function_Status run_simulations(FILE *output_file);
 static Function_Status conflict_solving();
+static Function_Status skip_simulation_set();
 static void deallocate_program_structures(FILE *output_file, FILE *auxiliary_file);
 
 int main(int argc, char **argv){
@@ -28,11 +39,20 @@ int main(int argc, char **argv){
     FILE *output_file = NULL;
     int simulation_set_quantity = 1; // Origins that use static exits have a single simulation set.
     int simulation_set_index = 0;
+    int set_position = 0; // Position of the current simulation set in the auxiliary file, starting at 1.
     int current_exit_number = 0;
 
     if(argp_parse(&argp, argc, argv,0,0,&cli_args) != 0)
         return END_PROGRAM;
 
+    start_profile();
+
+    if(start_trace() == FAILURE)
+        return END_PROGRAM;
+
+    if(install_status_handler() == FAILURE)
+        return END_PROGRAM;
+
     if(open_auxiliary_file(&auxiliary_file) == FAILURE)
         return END_PROGRAM;
     
@@ -54,15 +74,40 @@ int main(int argc, char **argv){
             return END_PROGRAM;
     }
 
-    print_full_command(output_file);
+    if(cli_args.output_format == OUTPUT_BINARY)
+    {
+        if(start_binary_output(output_file) == FAILURE)
+            return END_PROGRAM;
+    }
+    else
+        print_full_command(output_file);
+
+    if(cli_args.output_format == OUTPUT_STATISTICS)
+        print_statistics_header(output_file);
+
+    if(cli_args.num_threads > 0)
+    {
+        if(start_parallel_engine() == FAILURE)
+            return END_PROGRAM;
+    }
 
     if(auxiliary_file != NULL)
     {
         simulation_set_quantity = extract_simulation_set_quantity(auxiliary_file);
         if(simulation_set_quantity == -1)
             return END_PROGRAM;
+
+        if(cli_args.first_set > 0) // Only the sets in the range given by --sets are run.
+        {
+            int last_set = cli_args.last_set < simulation_set_quantity ? cli_args.last_set : simulation_set_quantity;
+            simulation_set_quantity = last_set >= cli_args.first_set ? last_set - cli_args.first_set + 1 : 0;
+        }
     }
 
+    if(start_telemetry(simulation_set_quantity) == FAILURE)
+        return END_PROGRAM;
+    run_status.set_quantity = simulation_set_quantity;
+
     do
     {
         if(origin_uses_auxiliary_data() == true)
@@ -72,25 +117,61 @@ int main(int argc, char **argv){
 
             if(current_exit_number == 0)
                 break; // All simulation sets were processed.
+
+            set_position++;
+            if(cli_args.first_set > 0 && set_position > cli_args.last_set)
+                break;
+
+            if(cli_args.first_set > 0 && set_position < cli_args.first_set)
+            {
+                if(skip_simulation_set() == FAILURE)
+                    return END_PROGRAM;
+                continue;
+            }
         }
 
-        if(cli_args.show_simulation_set_info)
+        if(cli_args.show_simulation_set_info && cli_args.output_format != OUTPUT_BINARY) // The binary output holds the exits of every set.
             print_simulation_set_information(output_file);
 
+        uint64_t set_trace_start = trace_clock();
+        begin_profile_set();
+        reset_peak_grid_memory();
+        begin_memory_set();
+        begin_set_statistics();
+
+        run_status.set_index = simulation_set_index;
+        run_status.activity = "floor field";
+        PROFILE_BEGIN(PHASE_FLOOR_FIELD);
+        uint64_t field_trace_start = trace_clock();
         int returned_value = calculate_final_floor_field();
+        write_trace_span("floor field", "floor field", 0, field_trace_start, "exits", exits_set.num_exits);
+        PROFILE_END(PHASE_FLOOR_FIELD);
         if( returned_value == FAILURE) 
             return END_PROGRAM;
         else if(returned_value == INACCESSIBLE_EXIT)
         {
-            if(cli_args.output_format != OUTPUT_TIMESTEPS_COUNT)
+            if(cli_args.output_format == OUTPUT_BINARY)
+            {
+                if(write_binary_set(output_file, set_position > 0 ? set_position : 1, true) == FAILURE)
+                    return END_PROGRAM;
+            }
+            else if(cli_args.output_format == OUTPUT_STATISTICS)
+                print_inaccessible_set_statistics(output_file);
+            else if(cli_args.output_format != OUTPUT_TIMESTEPS_COUNT)
                 fprintf(output_file, "At least one exit from the simulation set is inaccessible.\n");
             else
                 print_placeholder(output_file, -1);
 
             if(origin_uses_auxiliary_data() == true)
-                deallocate_exits();
+                reset_exits();
 
-            print_execution_status(simulation_set_index, simulation_set_quantity);
+            end_profile_set();
+            end_memory_set();
+            write_trace_span("simulation set", "set", 0, set_trace_start, "set", simulation_set_index + 1);
+            if(cli_args.telemetry)
+                TELEMETRY_SET();
+            else
+                print_execution_status(simulation_set_index, simulation_set_quantity);
             simulation_set_index++;
 
             continue;
@@ -100,19 +181,40 @@ int main(int argc, char **argv){
         if(run_simulations(output_file) == FAILURE)
             return END_PROGRAM;
 
-        if(origin_uses_auxiliary_data() == true)
-            deallocate_exits();
-
+        run_status.activity = "output";
+        PROFILE_BEGIN(PHASE_OUTPUT);
+        uint64_t output_trace_start = trace_clock();
         if(cli_args.output_format == OUTPUT_TIMESTEPS_COUNT)
             fprintf(output_file, "\n");
 
+        if(cli_args.output_format == OUTPUT_STATISTICS)
+            print_set_statistics(output_file);
+
         if(cli_args.output_format == OUTPUT_HEATMAP)
         {
             print_heatmap(output_file);        
             reset_integer_grid(heatmap_grid, cli_args.global_line_number, cli_args.global_column_number);
         }
 
-        print_execution_status(simulation_set_index, simulation_set_quantity);
+        if(cli_args.output_format == OUTPUT_BINARY)
+        {
+            if(write_binary_set(output_file, set_position > 0 ? set_position : 1, false) == FAILURE)
+                return END_PROGRAM;
+            reset_integer_grid(heatmap_grid, cli_args.global_line_number, cli_args.global_column_number);
+        }
+        write_trace_span("output", "output", 0, output_trace_start, NULL, 0);
+        PROFILE_END(PHASE_OUTPUT);
+
+        if(origin_uses_auxiliary_data() == true) // The binary output holds the exits of the set.
+            reset_exits();
+
+        end_profile_set();
+        end_memory_set();
+        write_trace_span("simulation set", "set", 0, set_trace_start, "set", simulation_set_index + 1);
+        if(cli_args.telemetry)
+            TELEMETRY_SET();
+        else
+            print_execution_status(simulation_set_index, simulation_set_quantity);
         simulation_set_index++;
 
         if(origin_uses_static_exits() == true) // Only a single simulation set.
@@ -120,6 +222,10 @@ int main(int argc, char **argv){
 
     }while(true);
 
+    print_profile_report();
+    print_memory_report();
+    finish_trace();
+    finish_telemetry();
     deallocate_program_structures(output_file, auxiliary_file);
 
     return END_PROGRAM;
@@ -133,13 +239,22 @@ int main(int argc, char **argv){
 */
 static Function_Status run_simulations(FILE *output_file)
 {
-    if(cli_args.single_exit_flag == true && cli_args.output_format == OUTPUT_TIMESTEPS_COUNT && exits_set.num_exits == 1)
+    if(cli_args.single_exit_flag == true && (cli_args.output_format == OUTPUT_TIMESTEPS_COUNT || cli_args.output_format == OUTPUT_STATISTICS) &&
+       exits_set.num_exits == 1)
     {
         fprintf(output_file, "#1 "); // simulation set where the exit was combined with itself. Used to correct errors in the plotting program.
     }
 
+    run_status.activity = "simulation";
+
+    if(cli_args.batch_lanes > 0)
+        return run_batched_simulations(output_file);
+
     for(int simu_index = 0; simu_index < cli_args.num_simulations; simu_index++, cli_args.seed++)
     {
+        uint64_t replica_trace_start = trace_clock();
+        run_status.simulation = simu_index;
+        run_status.seed = cli_args.seed;
         srand(cli_args.seed);
 
         if(cli_args.show_debug_information)
@@ -147,56 +262,110 @@ static Function_Status run_simulations(FILE *output_file)
 
         if(origin_uses_static_pedestrians() == false)
         {
+            PROFILE_BEGIN(PHASE_PEDESTRIAN_INSERTION);
             if( insert_pedestrians_at_random(cli_args.total_num_pedestrians) == FAILURE)
                 return FAILURE;
+            PROFILE_END(PHASE_PEDESTRIAN_INSERTION);
         }
         
         if(cli_args.output_format == OUTPUT_VISUALIZATION)
             print_pedestrian_position_grid(output_file, simu_index, 0);
 
         int number_timesteps = 0;
-        while(is_environment_empty() == false)
+        if(cli_args.num_threads > 0)
         {
-            if(cli_args.show_debug_information)
+            if(run_parallel_timesteps(output_file, simu_index, &number_timesteps) == FAILURE)
+                return FAILURE;
+        }
+        else
+        {
+            while(is_environment_empty() == false)
             {
-                print_int_grid(pedestrian_position_grid);
-                printf("\nTimestep %d.\n", number_timesteps + 1);
-            }
+                if(cli_args.show_debug_information)
+                {
+                    print_int_grid(pedestrian_position_grid);
+                    printf("\nTimestep %d.\n", number_timesteps + 1);
+                }
+
+                uint64_t timestep_trace_start = is_traced_timestep(number_timesteps) ? trace_clock() : 0;
             
-            evaluate_pedestrians_movements();
-            determine_pedestrians_in_panic();
+                PROFILE_COUNT_TIMESTEPS(1, count_pedestrians_in_environment());
+                TELEMETRY_TIMESTEP(count_pedestrians_in_environment());
+                STATUS_CHECKPOINT(number_timesteps, count_pedestrians_in_environment(), NULL);
+
+                PROFILE_BEGIN(PHASE_EVALUATE_MOVEMENTS);
+                evaluate_pedestrians_movements();
+                PROFILE_END(PHASE_EVALUATE_MOVEMENTS);
+
+                PROFILE_BEGIN(PHASE_PANIC);
+                determine_pedestrians_in_panic();
+                PROFILE_END(PHASE_PANIC);
             
-            if(!cli_args.allow_X_movement)
-                block_X_movement(); // Runs when allow_X_movement is false.
+                if(!cli_args.allow_X_movement)
+                {
+                    PROFILE_BEGIN(PHASE_X_MOVEMENT);
+                    if(block_X_movement() == FAILURE) // Runs when allow_X_movement is false.
+                        return FAILURE;
+                    PROFILE_END(PHASE_X_MOVEMENT);
+                }
             
-            if(conflict_solving() == FAILURE)
-                return FAILURE;
+                PROFILE_BEGIN(PHASE_CONFLICTS);
+                if(conflict_solving() == FAILURE)
+                    return FAILURE;
+                PROFILE_END(PHASE_CONFLICTS);
             
-            apply_pedestrian_movement();
+                PROFILE_BEGIN(PHASE_APPLY_MOVEMENT);
+                apply_pedestrian_movement();
+                PROFILE_END(PHASE_APPLY_MOVEMENT);
 
-            update_pedestrian_position_grid();
-            reset_pedestrian_state();
-            reset_pedestrian_panic();
+                PROFILE_BEGIN(PHASE_UPDATE_POSITION_GRID);
+                update_pedestrian_position_grid();
+                PROFILE_END(PHASE_UPDATE_POSITION_GRID);
+
+                PROFILE_BEGIN(PHASE_RESETS);
+                reset_pedestrian_state();
+                reset_pedestrian_panic();
+                PROFILE_END(PHASE_RESETS);
+
+                if(timestep_trace_start != 0)
+                    write_trace_span("timestep", "timestep", 0, timestep_trace_start, "timestep", number_timesteps + 1);
             
-            number_timesteps++;
+                number_timesteps++;
 
-            if(cli_args.output_format == OUTPUT_VISUALIZATION)
-            {
-                if(!cli_args.write_to_file)
-                    sleep(1);
+                if(cli_args.output_format == OUTPUT_VISUALIZATION)
+                {
+                    if(!cli_args.write_to_file)
+                        sleep(1);
                     
-                print_pedestrian_position_grid(output_file, simu_index,number_timesteps);
-            }
+                    PROFILE_BEGIN(PHASE_OUTPUT);
+                    uint64_t output_trace_start = trace_clock();
+                    print_pedestrian_position_grid(output_file, simu_index,number_timesteps);
+                    if(timestep_trace_start != 0)
+                        write_trace_span("output", "output", 0, output_trace_start, "timestep", number_timesteps);
+                    PROFILE_END(PHASE_OUTPUT);
+                }
 
+            }
         }
 
+        PROFILE_BEGIN(PHASE_RESETS);
         if(origin_uses_static_pedestrians() == true)
             reset_pedestrians_structures();
         else
-            deallocate_pedestrians();
+            clear_pedestrian_set();
+        PROFILE_END(PHASE_RESETS);
 
+        PROFILE_BEGIN(PHASE_OUTPUT);
         if(cli_args.output_format == OUTPUT_TIMESTEPS_COUNT)
-            fprintf(output_file,"%d ", number_timesteps);
+            print_timesteps(output_file, number_timesteps);
+        else if(cli_args.output_format == OUTPUT_BINARY)
+            record_binary_timesteps(number_timesteps);
+        else if(cli_args.output_format == OUTPUT_STATISTICS)
+            add_statistics_sample(number_timesteps);
+        PROFILE_END(PHASE_OUTPUT);
+
+        write_trace_span("simulation", "replica", 0, replica_trace_start, "seed", cli_args.seed);
+        TELEMETRY_REPLICAS(1);
     }
 
     return SUCCESS;
@@ -220,7 +389,26 @@ static Function_Status conflict_solving()
     if(cli_args.show_debug_information)
         print_pedestrian_conflict_information(pedestrian_conflicts, num_conflicts);
 
-    free(pedestrian_conflicts);
+    return SUCCESS;
+}
+
+/**
+ * Skips a simulation set that precedes the range given by --sets. The seeds of its simulations are consumed as in a run over
+ * all sets (none if one of its exits is inaccessible), so the sets in the range get the same seeds. Only the accessibility of
+ * the exits is verified, not their floor fields.
+ * 
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+*/
+static Function_Status skip_simulation_set()
+{
+    int returned_value = check_exits_accessibility();
+    if(returned_value == FAILURE)
+        return FAILURE;
+
+    if(returned_value == SUCCESS)
+        cli_args.seed += cli_args.num_simulations;
+
+    reset_exits();
 
     return SUCCESS;
 }
@@ -239,8 +427,11 @@ static void deallocate_program_structures(FILE *output_file, FILE *auxiliary_fil
     if(output_file != NULL && output_file != stdout)
         fclose(output_file);
 
+    stop_parallel_engine();
+    deallocate_timestep_structures();
     deallocate_pedestrians();
     deallocate_exits();
+    finish_binary_output();
     
     deallocate_grid((void **) environment_only_grid,cli_args.global_line_number);
     deallocate_grid((void **) pedestrian_position_grid,cli_args.global_line_number);
@@ -0,0 +1,358 @@
+/*
+   File: memory.c
+   Author: Daniel Gonçalves
+   Date: 2026-10-18
+   Description: This module contains the allocation wrappers used by the program, which count the allocator calls and the bytes allocated, live and at peak, by subsystem (grids, exits, pedestrians, conflicts, parallel engine and output), and the report of --mem-report.
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<stdint.h>
+#include<stdalign.h>
+#include<sys/resource.h>
+
+#include"../headers/memory.h"
+#include"../headers/initialization.h"
+#include"../headers/cli_processing.h"
+#include"../headers/shared_resources.h"
+
+// Stored right before each tracked allocation, keeping the alignment of malloc.
+typedef union{
+    struct{
+        size_t size;
+        enum Memory_Subsystem subsystem;
+    }info;
+    max_align_t alignment;
+}Allocation_Header;
+
+// Peaks of a simulation set, for the per-set rows of --mem-report-sets.
+typedef struct{
+    long calls;
+    size_t peak_bytes[NUM_MEMORY_SUBSYSTEMS];
+    size_t total_peak_bytes;
+}Set_Memory;
+
+Memory_Counters memory_counters[NUM_MEMORY_SUBSYSTEMS];
+Memory_Counters memory_total;
+
+static const char *subsystem_names[NUM_MEMORY_SUBSYSTEMS] = {
+    "grid",
+    "exit",
+    "pedestrian",
+    "conflict",
+    "engine",
+    "output"
+};
+
+static long set_start_calls = 0; // memory_total.calls at the beginning of the current simulation set.
+static Set_Memory *set_memory = NULL;
+static int num_sets = 0;
+static int sets_capacity = 0;
+
+static void count_call(enum Memory_Subsystem subsystem);
+static void account_memory(enum Memory_Subsystem subsystem, long size_change);
+static void update_counters(Memory_Counters *counters, long size_change);
+static void raise_peak(size_t *peak, size_t value);
+
+/**
+ * Allocates memory attributed to the given subsystem, as malloc.
+ *
+ * @param subsystem Subsystem that owns the allocation.
+ * @param size Number of bytes to allocate.
+ * @return A NULL pointer, on error, or a pointer aligned as the ones returned by malloc, to be released with tracked_free.
+*/
+void *tracked_malloc(enum Memory_Subsystem subsystem, size_t size)
+{
+    count_call(subsystem);
+
+    Allocation_Header *header = malloc(sizeof(Allocation_Header) + size);
+    if(header == NULL)
+        return NULL;
+
+    header->info.size = size;
+    header->info.subsystem = subsystem;
+    account_memory(subsystem, (long) size);
+
+    return header + 1;
+}
+
+/**
+ * Allocates zeroed memory attributed to the given subsystem, as calloc.
+ *
+ * @param subsystem Subsystem that owns the allocation.
+ * @param count Number of elements.
+ * @param size Size of each element, in bytes.
+ * @return A NULL pointer, on error, or a pointer to the zeroed memory, to be released with tracked_free.
+*/
+void *tracked_calloc(enum Memory_Subsystem subsystem, size_t count, size_t size)
+{
+    if(size != 0 && count > (SIZE_MAX - sizeof(Allocation_Header)) / size)
+        return NULL;
+
+    count_call(subsystem);
+
+    Allocation_Header *header = calloc(1, sizeof(Allocation_Header) + count * size);
+    if(header == NULL)
+        return NULL;
+
+    header->info.size = count * size;
+    header->info.subsystem = subsystem;
+    account_memory(subsystem, (long) (count * size));
+
+    return header + 1;
+}
+
+/**
+ * Resizes a tracked allocation, as realloc. A NULL allocation is allocated for the given subsystem.
+ *
+ * @param subsystem Subsystem that owns the allocation.
+ * @param allocation Allocation returned by the tracked functions, or NULL.
+ * @param size New size, in bytes.
+ * @return A NULL pointer, on error (when the old allocation is kept), or the resized allocation.
+*/
+void *tracked_realloc(enum Memory_Subsystem subsystem, void *allocation, size_t size)
+{
+    if(allocation == NULL)
+        return tracked_malloc(subsystem, size);
+
+    count_call(subsystem);
+
+    Allocation_Header *old_header = ((Allocation_Header *) allocation) - 1;
+    size_t old_size = old_header->info.size;
+    enum Memory_Subsystem old_subsystem = old_header->info.subsystem;
+
+    Allocation_Header *header = realloc(old_header, sizeof(Allocation_Header) + size);
+    if(header == NULL)
+        return NULL;
+
+    account_memory(old_subsystem, -(long) old_size);
+    header->info.size = size;
+    header->info.subsystem = subsystem;
+    account_memory(subsystem, (long) size);
+
+    return header + 1;
+}
+
+/**
+ * Releases a tracked allocation, as free.
+ *
+ * @param allocation Allocation returned by the tracked functions, or NULL.
+*/
+void tracked_free(void *allocation)
+{
+    if(allocation == NULL)
+        return;
+
+    Allocation_Header *header = ((Allocation_Header *) allocation) - 1;
+    count_call(header->info.subsystem);
+    account_memory(header->info.subsystem, -(long) header->info.size);
+
+    free(header);
+}
+
+/**
+ * Counts memory obtained outside the tracked functions (as the mappings of the grid backends), with its allocator call.
+ *
+ * @param subsystem Subsystem that owns the memory.
+ * @param size Number of bytes.
+*/
+void record_allocation(enum Memory_Subsystem subsystem, size_t size)
+{
+    count_call(subsystem);
+    account_memory(subsystem, (long) size);
+}
+
+/**
+ * Counts the release of memory obtained outside the tracked functions, with its allocator call.
+ *
+ * @param subsystem Subsystem that owned the memory.
+ * @param size Number of bytes.
+*/
+void record_deallocation(enum Memory_Subsystem subsystem, size_t size)
+{
+    count_call(subsystem);
+    account_memory(subsystem, -(long) size);
+}
+
+/**
+ * Marks the beginning of a simulation set: its allocator calls are counted from here and its peaks start at the memory in use.
+*/
+void begin_memory_set()
+{
+    set_start_calls = memory_total.calls;
+
+    for(int subsystem = 0; subsystem < NUM_MEMORY_SUBSYSTEMS; subsystem++)
+        memory_counters[subsystem].set_peak_bytes = memory_counters[subsystem].live_bytes;
+    memory_total.set_peak_bytes = memory_total.live_bytes;
+}
+
+/**
+ * Stores the peaks of the simulation set that has just been finalized. Only used with --mem-report-sets.
+ *
+ * @note The peaks of a simulation set are silently discarded if there isn't memory to store them.
+*/
+void end_memory_set()
+{
+    if(!cli_args.mem_report_sets)
+        return;
+
+    if(num_sets == sets_capacity)
+    {
+        int new_capacity = sets_capacity == 0 ? 16 : 2 * sets_capacity;
+        Set_Memory *new_sets = tracked_realloc(MEMORY_OUTPUT, set_memory, sizeof(Set_Memory) * new_capacity);
+        if(new_sets == NULL)
+            return;
+
+        set_memory = new_sets;
+        sets_capacity = new_capacity;
+    }
+
+    Set_Memory *set = &set_memory[num_sets];
+    set->calls = get_allocator_calls();
+    for(int subsystem = 0; subsystem < NUM_MEMORY_SUBSYSTEMS; subsystem++)
+        set->peak_bytes[subsystem] = memory_counters[subsystem].set_peak_bytes;
+    set->total_peak_bytes = memory_total.set_peak_bytes;
+
+    num_sets++;
+}
+
+/**
+ * Returns the number of allocator calls made since the beginning of the current simulation set.
+ *
+ * @return Number of allocator calls.
+*/
+long get_allocator_calls()
+{
+    return memory_total.calls - set_start_calls;
+}
+
+/**
+ * Prints the memory report of --mem-report to the file optionally given (in the output directory) or to stderr: the allocator
+ * calls and the bytes allocated, live and at peak of each subsystem, the peak resident memory of the process and, with
+ * --mem-report-sets, the peaks of each simulation set. Releases the per-set peaks.
+ *
+ * @note The live bytes are the ones still allocated when the report is printed, before the structures of the program are
+ * deallocated.
+ *
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+*/
+Function_Status print_memory_report()
+{
+    if(!cli_args.mem_report)
+        return SUCCESS;
+
+    FILE *report_file = stderr;
+    if(strcmp(cli_args.mem_report_filename, "") != 0)
+    {
+        char complete_path[300];
+        sprintf(complete_path, "%s%s", output_path, cli_args.mem_report_filename);
+
+        report_file = fopen(complete_path, "w");
+        if(report_file == NULL)
+        {
+            fprintf(stderr, "It was not possible to open the memory report file.\n");
+            return FAILURE;
+        }
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage); // ru_maxrss is given in kilobytes on Linux.
+
+    fprintf(report_file, "Memory: peak of %.3lf MB allocated at once, %.3lf MB allocated in total, %ld allocator calls, peak RSS of %.3lf MB.\n",
+            memory_total.peak_bytes / (1024.0 * 1024.0), memory_total.allocated_bytes / (1024.0 * 1024.0), memory_total.calls, usage.ru_maxrss / 1024.0);
+    fprintf(report_file, "%-14s %12s %16s %12s %12s\n", "subsystem", "calls", "allocated (MB)", "live (MB)", "peak (MB)");
+
+    for(int subsystem = 0; subsystem <= NUM_MEMORY_SUBSYSTEMS; subsystem++)
+    {
+        Memory_Counters *counters = subsystem < NUM_MEMORY_SUBSYSTEMS ? &memory_counters[subsystem] : &memory_total;
+        fprintf(report_file, "%-14s %12ld %16.3lf %12.3lf %12.3lf\n", subsystem < NUM_MEMORY_SUBSYSTEMS ? subsystem_names[subsystem] : "total",
+                counters->calls, counters->allocated_bytes / (1024.0 * 1024.0), counters->live_bytes / (1024.0 * 1024.0), counters->peak_bytes / (1024.0 * 1024.0));
+    }
+
+    if(cli_args.mem_report_sets)
+    {
+        fprintf(report_file, "\nPeak of each simulation set (MB):\n%-14s %12s", "simulation set", "calls");
+        for(int subsystem = 0; subsystem < NUM_MEMORY_SUBSYSTEMS; subsystem++)
+            fprintf(report_file, " %10s", subsystem_names[subsystem]);
+        fprintf(report_file, " %10s\n", "total");
+
+        for(int set = 0; set < num_sets; set++)
+        {
+            fprintf(report_file, "%-14d %12ld", set + 1, set_memory[set].calls);
+            for(int subsystem = 0; subsystem < NUM_MEMORY_SUBSYSTEMS; subsystem++)
+                fprintf(report_file, " %10.3lf", set_memory[set].peak_bytes[subsystem] / (1024.0 * 1024.0));
+            fprintf(report_file, " %10.3lf\n", set_memory[set].total_peak_bytes / (1024.0 * 1024.0));
+        }
+    }
+
+    if(report_file != stderr)
+        fclose(report_file);
+
+    tracked_free(set_memory);
+    set_memory = NULL;
+    num_sets = sets_capacity = 0;
+
+    return SUCCESS;
+}
+
+/* ---------------- ---------------- ---------------- ---------------- ---------------- */
+/* ---------------- ---------------- STATIC FUNCTIONS ---------------- ---------------- */
+/* ---------------- ---------------- ---------------- ---------------- ---------------- */
+
+/**
+ * Counts a call to the allocator.
+ *
+ * @note The counters are updated atomically, as the threads of the parallel engine may allocate at the same time.
+ *
+ * @param subsystem Subsystem that made the call.
+*/
+static void count_call(enum Memory_Subsystem subsystem)
+{
+    __atomic_fetch_add(&memory_counters[subsystem].calls, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&memory_total.calls, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * Adds an allocation (positive size_change) or a deallocation (negative) to the counters of the subsystem and of the program.
+ *
+ * @param subsystem Subsystem that owns the memory.
+ * @param size_change Number of bytes allocated or deallocated.
+*/
+static void account_memory(enum Memory_Subsystem subsystem, long size_change)
+{
+    update_counters(&memory_counters[subsystem], size_change);
+    update_counters(&memory_total, size_change);
+}
+
+/**
+ * Adds an allocation (positive size_change) or a deallocation (negative) to the given counters, raising their peaks.
+ *
+ * @param counters Counters of a subsystem or of the whole program.
+ * @param size_change Number of bytes allocated or deallocated.
+*/
+static void update_counters(Memory_Counters *counters, long size_change)
+{
+    if(size_change > 0)
+        __atomic_fetch_add(&counters->allocated_bytes, (size_t) size_change, __ATOMIC_RELAXED);
+
+    size_t live_bytes = __atomic_add_fetch(&counters->live_bytes, (size_t) size_change, __ATOMIC_RELAXED);
+    if(size_change > 0)
+    {
+        raise_peak(&counters->peak_bytes, live_bytes);
+        raise_peak(&counters->set_peak_bytes, live_bytes);
+    }
+}
+
+/**
+ * Raises a peak to the given value, if it is lower.
+ *
+ * @param peak Peak to be raised.
+ * @param value Bytes currently live.
+*/
+static void raise_peak(size_t *peak, size_t value)
+{
+    size_t current = __atomic_load_n(peak, __ATOMIC_RELAXED);
+    while(value > current && !__atomic_compare_exchange_n(peak, &current, value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+}
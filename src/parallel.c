@@ -0,0 +1,963 @@
+/*
+   File: parallel.c
+   Author: Daniel Gonçalves
+   Date: 2026-10-17
+   Description: This module implements the parallel timestep engine, which splits the environment into stripes of lines and lets each thread evaluate, find X movements, solve conflicts and move the pedestrians of its own stripe. The X movements found by all stripes are then blocked by a single thread, in the order and with the rules of the non-parallel scan. Lines adjacent to a stripe (halo lines) are read to handle X movements and conflicts across stripe borders. Random decisions are derived from the seed, the timestep and the pedestrian id, so results do not depend on the number of threads.
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<stdint.h>
+#include<stdbool.h>
+#include<pthread.h>
+#include<unistd.h>
+
+#include"../headers/cell.h"
+#include"../headers/exit.h"
+#include"../headers/grid.h"
+#include"../headers/arena.h"
+#include"../headers/memory.h"
+#include"../headers/trace.h"
+#include"../headers/status.h"
+#include"../headers/parallel.h"
+#include"../headers/profile.h"
+#include"../headers/telemetry.h"
+#include"../headers/pedestrian.h"
+#include"../headers/cli_processing.h"
+#include"../headers/printing_utilities.h"
+#include"../headers/shared_resources.h"
+
+enum Random_Purpose {MOVEMENT_DRAW = 1, PANIC_DRAW, X_MOVEMENT_DRAW, CONFLICT_DRAW, LOWER_X_MOVEMENT_DRAW};
+
+enum X_Movement_Direction {RIGHT_NEIGHBOR = 0, LOWER_NEIGHBOR};
+
+typedef struct{
+    int first_pedestrian; // Pedestrian index of the first pedestrian of a X movement.
+    int second_pedestrian;
+    long scan_key; // (line * columns + column) * 2 + direction, for the first pedestrian: the order of block_X_movement.
+}X_Movement;
+
+typedef struct{
+    int first_line; // First line of the stripe.
+    int end_line; // Line after the last line of the stripe.
+    int num_got_out; // Pedestrians that left the environment in the current timestep.
+    X_Movement *x_movements; // X movements found in the stripe during the current timestep.
+    int num_x_movements;
+    int x_movements_capacity;
+    Work_Counters work; // Added to work_counters at the end of each simulation.
+    uint64_t idle_nanoseconds; // Time waiting at the phase barrier (only with --profile). Added to the profile at the end of each simulation.
+}Stripe;
+
+typedef struct{
+    int num_threads;
+    pthread_t threads[MAX_THREADS];
+    pthread_barrier_t start_barrier; // Workers wait here between simulations.
+    pthread_barrier_t phase_barrier; // Separates the phases of a timestep.
+    Stripe stripes[MAX_THREADS];
+    bool quit;
+    bool finished; // True when the current simulation has ended.
+    bool failed; // True when the current simulation was stopped by a failure of the main thread.
+    uint64_t seed_key;
+    int timestep;
+    int remaining; // Pedestrians still in the environment.
+    int *line_order; // Pedestrian indexes sorted (stably) by current line. Only pedestrians in the environment are present.
+    int num_ordered; // Number of pedestrians in line_order.
+    int *line_start; // line_order[line_start[i]] is the first pedestrian in the line i.
+    int *line_offset; // Next free position of each line during the sort.
+    int *sort_buffer;
+    int *column_start; // Counters of the sort by column, with global_column_number + 1 positions.
+    struct pedestrian *packed[2]; // Copies of the pedestrian structures, in the order of line_order, made by repack_pedestrians.
+    int packed_current; // Buffer of packed referenced by pedestrian_set.list after the last repack.
+    int packed_capacity;
+    bool *lost_conflict; // Set by the thread that owns the target cell of the pedestrian.
+    Int_Grid claim_grid; // Pedestrian index + 1 of the current winner of the conflict in each cell (negated once someone lost).
+    int capacity; // Number of pedestrians the arrays above can hold.
+    FILE *output_file;
+    int simulation_number;
+}Parallel_Engine;
+
+static Parallel_Engine engine = {.num_threads = 0};
+
+static void *worker_function(void *argument);
+static void run_timesteps(int thread_index);
+static void wait_phase_barrier(Stripe *stripe);
+static void write_engine_status();
+static Function_Status prepare_simulation();
+static void sort_pedestrians_by_line();
+static void sort_pedestrians_by_column();
+static Function_Status reorder_pedestrians();
+static void evaluate_stripe(Stripe *stripe);
+static void find_stripe_smallest_cell(Stripe *stripe, Pedestrian pedestrian, bool unoccupied_only);
+static Function_Status find_stripe_X_movements(Stripe *stripe);
+static void block_X_movements_in_scan_order();
+static int compare_X_movements(const void *first, const void *second);
+static void solve_stripe_conflicts(Stripe *stripe);
+static void apply_stripe_movement(Stripe *stripe);
+static inline uint32_t counter_random(int timestep, int pedestrian_id, enum Random_Purpose purpose);
+static inline uint64_t mix_bits(uint64_t z);
+
+/**
+ * Creates the worker threads and splits the environment lines into one stripe per thread.
+ *
+ * @note The calling thread works as the thread 0.
+ *
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+*/
+Function_Status start_parallel_engine()
+{
+    engine.num_threads = cli_args.num_threads;
+    engine.quit = false;
+
+    for(int t = 0; t < engine.num_threads; t++)
+    {
+        engine.stripes[t].first_line = (int) ((long) cli_args.global_line_number * t / engine.num_threads);
+        engine.stripes[t].end_line = (int) ((long) cli_args.global_line_number * (t + 1) / engine.num_threads);
+    }
+
+    engine.line_start = tracked_calloc(MEMORY_ENGINE, cli_args.global_line_number + 1, sizeof(int));
+    engine.line_offset = tracked_calloc(MEMORY_ENGINE, cli_args.global_line_number, sizeof(int));
+    engine.column_start = tracked_calloc(MEMORY_ENGINE, cli_args.global_column_number + 1, sizeof(int));
+    engine.claim_grid = allocate_integer_grid(cli_args.global_line_number, cli_args.global_column_number);
+    if(engine.line_start == NULL || engine.line_offset == NULL || engine.column_start == NULL || engine.claim_grid == NULL)
+    {
+        fprintf(stderr, "Failure during the allocation of the parallel engine structures.\n");
+        return FAILURE;
+    }
+
+    if(pthread_barrier_init(&engine.start_barrier, NULL, engine.num_threads) != 0 ||
+       pthread_barrier_init(&engine.phase_barrier, NULL, engine.num_threads) != 0)
+    {
+        fprintf(stderr, "Failure on initializing the barriers of the parallel engine.\n");
+        return FAILURE;
+    }
+
+    for(long t = 1; t < engine.num_threads; t++)
+    {
+        if(pthread_create(&engine.threads[t], NULL, worker_function, (void *) t) != 0)
+        {
+            fprintf(stderr, "Failure on creating the thread %ld of the parallel engine.\n", t);
+            return FAILURE;
+        }
+    }
+
+    // The counters of all threads are read by the thread 0, so the workers must have opened theirs before any phase begins.
+    if(profile.counters_enabled)
+        pthread_barrier_wait(&engine.start_barrier);
+
+    return SUCCESS;
+}
+
+/**
+ * Runs the timesteps of the current simulation with all threads, until the environment is empty.
+ *
+ * @note The pedestrians must be already placed, as done by run_simulations.
+ *
+ * @param output_file Stream where the visual output will be written, if appropriate.
+ * @param simulation_number Current simulation index.
+ * @param number_timesteps Pointer to an integer, where the number of timesteps will be stored.
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+*/
+Function_Status run_parallel_timesteps(FILE *output_file, int simulation_number, int *number_timesteps)
+{
+    PROFILE_BEGIN(PHASE_PEDESTRIAN_ORDERING);
+    if(prepare_simulation() == FAILURE)
+        return FAILURE;
+    PROFILE_END(PHASE_PEDESTRIAN_ORDERING);
+
+    engine.output_file = output_file;
+    engine.simulation_number = simulation_number;
+
+    pthread_barrier_wait(&engine.start_barrier);
+
+    // Only written after the start barrier: the workers may still be reading the flag of the previous simulation before it.
+    engine.finished = engine.remaining == 0;
+    engine.failed = false;
+    uint64_t timesteps_start = read_profile_clock();
+    run_timesteps(0);
+    profile.parallel_nanoseconds += read_profile_clock() - timesteps_start;
+
+    for(int t = 0; t < engine.num_threads; t++)
+    {
+        add_work_counters(&work_counters, &engine.stripes[t].work);
+        profile.thread_idle_nanoseconds[t] += engine.stripes[t].idle_nanoseconds;
+        engine.stripes[t].idle_nanoseconds = 0;
+
+        if(engine.stripes[t].num_x_movements < 0)
+            return FAILURE; // A thread failed to store its X movements.
+    }
+
+    if(engine.failed)
+        return FAILURE; // The pedestrians could not be reordered.
+
+    *number_timesteps = engine.timestep;
+
+    return SUCCESS;
+}
+
+/**
+ * Stops the worker threads and deallocates the structures of the parallel engine.
+*/
+void stop_parallel_engine()
+{
+    if(engine.num_threads <= 0)
+        return;
+
+    engine.quit = true;
+    pthread_barrier_wait(&engine.start_barrier);
+
+    for(int t = 1; t < engine.num_threads; t++)
+        pthread_join(engine.threads[t], NULL);
+
+    pthread_barrier_destroy(&engine.start_barrier);
+    pthread_barrier_destroy(&engine.phase_barrier);
+
+    for(int t = 0; t < engine.num_threads; t++)
+        tracked_free(engine.stripes[t].x_movements);
+
+    tracked_free(engine.line_order);
+    tracked_free(engine.line_start);
+    tracked_free(engine.line_offset);
+    tracked_free(engine.sort_buffer);
+    tracked_free(engine.column_start);
+    tracked_free(engine.packed[0]);
+    tracked_free(engine.packed[1]);
+    tracked_free(engine.lost_conflict);
+    deallocate_grid((void **) engine.claim_grid, cli_args.global_line_number);
+
+    memset(&engine, 0, sizeof(Parallel_Engine));
+}
+
+/* ---------------- ---------------- ---------------- ---------------- ---------------- */
+/* ---------------- ---------------- STATIC FUNCTIONS ---------------- ---------------- */
+/* ---------------- ---------------- ---------------- ---------------- ---------------- */
+
+/**
+ * Main function of the worker threads. Each iteration runs a whole simulation.
+ *
+ * @param argument Index of the thread, casted to (void *).
+ * @return Always NULL.
+*/
+static void *worker_function(void *argument)
+{
+    int thread_index = (int) (long) argument;
+
+    name_trace_thread(thread_index);
+
+    if(profile.counters_enabled)
+    {
+        open_perf_counters(thread_index);
+        pthread_barrier_wait(&engine.start_barrier);
+    }
+
+    while(true)
+    {
+        pthread_barrier_wait(&engine.start_barrier);
+        if(engine.quit)
+            break;
+
+        run_timesteps(thread_index);
+    }
+
+    return NULL;
+}
+
+/**
+ * Runs the phases of every timestep for the stripe of the given thread. The thread 0 also runs the serial part of each timestep:
+ * sorting (and periodically reordering) the pedestrians, counting the pedestrians that got out and printing the visual output.
+ *
+ * @note With --profile, the phases are timed by the thread 0, from its start until the barrier that ends the phase.
+ * With --trace, every thread writes the spans of its own work in the phases of the sampled timesteps (without the waits).
+ *
+ * @param thread_index Index of the thread (and of its stripe).
+*/
+static void run_timesteps(int thread_index)
+{
+    Stripe *stripe = &engine.stripes[thread_index];
+    bool is_timer = thread_index == 0;
+
+    while(true)
+    {
+        wait_phase_barrier(stripe);
+        if(engine.finished)
+            break;
+
+        int timestep = engine.timestep + 1;
+        bool is_traced = is_traced_timestep(engine.timestep);
+        uint64_t trace_start = is_traced ? trace_clock() : 0;
+
+        if(is_timer)
+        {
+            PROFILE_COUNT_TIMESTEPS(1, engine.remaining);
+            TELEMETRY_TIMESTEP(engine.remaining);
+            PROFILE_BEGIN(PHASE_EVALUATE_MOVEMENTS);
+        }
+        evaluate_stripe(stripe);
+        if(is_traced)
+            write_trace_span("evaluate movements", "timestep", thread_index, trace_start, "timestep", timestep);
+        wait_phase_barrier(stripe);
+        if(is_timer)
+            PROFILE_END(PHASE_EVALUATE_MOVEMENTS);
+
+        if(!cli_args.allow_X_movement)
+        {
+            if(is_timer)
+                PROFILE_BEGIN(PHASE_X_MOVEMENT);
+            trace_start = is_traced ? trace_clock() : 0;
+            if(find_stripe_X_movements(stripe) == FAILURE)
+                stripe->num_x_movements = -1;
+            if(is_traced)
+                write_trace_span("find X movements", "timestep", thread_index, trace_start, "timestep", timestep);
+            wait_phase_barrier(stripe);
+
+            trace_start = is_traced ? trace_clock() : 0;
+            if(thread_index == 0)
+                block_X_movements_in_scan_order();
+            if(is_traced)
+                write_trace_span("block X movements", "timestep", thread_index, trace_start, "timestep", timestep);
+            wait_phase_barrier(stripe);
+            if(is_timer)
+                PROFILE_END(PHASE_X_MOVEMENT);
+        }
+
+        if(is_timer)
+            PROFILE_BEGIN(PHASE_CONFLICTS);
+        trace_start = is_traced ? trace_clock() : 0;
+        solve_stripe_conflicts(stripe);
+        if(is_traced)
+            write_trace_span("conflicts", "timestep", thread_index, trace_start, "timestep", timestep);
+        wait_phase_barrier(stripe);
+        if(is_timer)
+        {
+            PROFILE_END(PHASE_CONFLICTS);
+            PROFILE_BEGIN(PHASE_APPLY_MOVEMENT);
+        }
+
+        trace_start = is_traced ? trace_clock() : 0;
+        apply_stripe_movement(stripe);
+        if(is_traced)
+            write_trace_span("apply movement", "timestep", thread_index, trace_start, "timestep", timestep);
+        wait_phase_barrier(stripe);
+
+        if(thread_index != 0)
+            continue;
+
+        PROFILE_END(PHASE_APPLY_MOVEMENT);
+
+        for(int t = 0; t < engine.num_threads; t++)
+        {
+            engine.remaining -= engine.stripes[t].num_got_out;
+            engine.stripes[t].num_got_out = 0;
+
+            if(engine.stripes[t].num_x_movements < 0)
+                engine.finished = true;
+        }
+
+        engine.timestep++;
+        PROFILE_BEGIN(PHASE_PEDESTRIAN_ORDERING);
+        trace_start = is_traced ? trace_clock() : 0;
+        if(cli_args.reorder_interval > 0 && engine.timestep % cli_args.reorder_interval == 0)
+        {
+            if(reorder_pedestrians() == FAILURE)
+            {
+                engine.failed = true;
+                engine.finished = true;
+            }
+        }
+        else
+            sort_pedestrians_by_line();
+        if(is_traced)
+            write_trace_span("pedestrian ordering", "timestep", 0, trace_start, "timestep", timestep);
+        PROFILE_END(PHASE_PEDESTRIAN_ORDERING);
+
+        if(status_requested)
+            write_engine_status();
+
+        if(engine.remaining == 0)
+            engine.finished = true;
+
+        if(cli_args.output_format == OUTPUT_VISUALIZATION)
+        {
+            if(!cli_args.write_to_file)
+                sleep(1);
+
+            PROFILE_BEGIN(PHASE_OUTPUT);
+            trace_start = is_traced ? trace_clock() : 0;
+            print_pedestrian_position_grid(engine.output_file, engine.simulation_number, engine.timestep);
+            if(is_traced)
+                write_trace_span("output", "output", 0, trace_start, "timestep", timestep);
+            PROFILE_END(PHASE_OUTPUT);
+        }
+    }
+}
+
+/**
+ * Waits at the barrier between the phases of a timestep. With --profile, the time spent waiting is added to the idle time
+ * of the stripe (the time the thread had no work while the slowest stripe, or the serial part of the thread 0, was running).
+ *
+ * @param stripe Stripe of the calling thread.
+*/
+static void wait_phase_barrier(Stripe *stripe)
+{
+#ifndef VARAS_NO_PROFILE
+    if(cli_args.profile)
+    {
+        uint64_t wait_start = read_profile_clock();
+        pthread_barrier_wait(&engine.phase_barrier);
+        stripe->idle_nanoseconds += read_profile_clock() - wait_start;
+        return;
+    }
+#endif
+
+    pthread_barrier_wait(&engine.phase_barrier);
+}
+
+/**
+ * Writes the status file asked by SIGUSR1, adding the work counted by the stripes in the current simulation.
+ *
+ * @note Only called by the thread 0 in the serial part of a timestep, while the other threads wait at the barrier.
+*/
+static void write_engine_status()
+{
+    Work_Counters stripes_work;
+    memset(&stripes_work, 0, sizeof(Work_Counters));
+
+    for(int t = 0; t < engine.num_threads; t++)
+    {
+        for(int counter = 0; counter < NUM_WORK_COUNTERS; counter++)
+            stripes_work.counts[counter] += engine.stripes[t].work.counts[counter];
+    }
+
+    write_status_file(engine.timestep, engine.remaining, &stripes_work);
+}
+
+/**
+ * Prepares the engine for a new simulation, growing the per-pedestrian arrays if needed.
+ *
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+*/
+static Function_Status prepare_simulation()
+{
+    int num_pedestrians = pedestrian_set.num_pedestrians;
+
+    if(num_pedestrians > engine.capacity)
+    {
+        tracked_free(engine.line_order);
+        tracked_free(engine.sort_buffer);
+        tracked_free(engine.lost_conflict);
+
+        engine.line_order = tracked_malloc(MEMORY_ENGINE, sizeof(int) * num_pedestrians);
+        engine.sort_buffer = tracked_malloc(MEMORY_ENGINE, sizeof(int) * num_pedestrians);
+        engine.lost_conflict = tracked_calloc(MEMORY_CONFLICT, num_pedestrians, sizeof(bool));
+        if(engine.line_order == NULL || engine.sort_buffer == NULL || engine.lost_conflict == NULL)
+        {
+            fprintf(stderr, "Failure during the allocation of the parallel engine pedestrian structures.\n");
+            engine.capacity = 0;
+            return FAILURE;
+        }
+
+        engine.capacity = num_pedestrians;
+    }
+
+    engine.seed_key = mix_bits((uint64_t) (uint32_t) cli_args.seed);
+    engine.timestep = 0;
+    engine.num_ordered = 0;
+
+    for(int p_index = 0; p_index < num_pedestrians; p_index++)
+    {
+        if(pedestrian_set.list[p_index]->state != GOT_OUT)
+            engine.line_order[engine.num_ordered++] = p_index;
+    }
+
+    for(int t = 0; t < engine.num_threads; t++)
+    {
+        engine.stripes[t].num_got_out = 0;
+        engine.stripes[t].num_x_movements = 0;
+    }
+
+    if(cli_args.reorder_interval > 0)
+    {
+        if(reorder_pedestrians() == FAILURE)
+            return FAILURE;
+    }
+    else
+        sort_pedestrians_by_line();
+
+    engine.remaining = engine.num_ordered;
+
+    return SUCCESS;
+}
+
+/**
+ * Sorts the pedestrians still in the environment by their current line (stable counting sort), filling line_order and line_start.
+ * Pedestrians that got out are removed from line_order.
+*/
+static void sort_pedestrians_by_line()
+{
+    int line_number = cli_args.global_line_number;
+    int num_kept = 0;
+
+    memset(engine.line_start, 0, sizeof(int) * (line_number + 1));
+
+    for(int index = 0; index < engine.num_ordered; index++)
+    {
+        int p_index = engine.line_order[index];
+        if(pedestrian_set.list[p_index]->state == GOT_OUT)
+            continue;
+
+        engine.sort_buffer[num_kept++] = p_index;
+        engine.line_start[pedestrian_set.list[p_index]->current.lin + 1]++;
+    }
+
+    for(int i = 0; i < line_number; i++)
+    {
+        engine.line_start[i + 1] += engine.line_start[i];
+        engine.line_offset[i] = engine.line_start[i];
+    }
+
+    for(int index = 0; index < num_kept; index++)
+    {
+        int p_index = engine.sort_buffer[index];
+        engine.line_order[engine.line_offset[pedestrian_set.list[p_index]->current.lin]++] = p_index;
+    }
+
+    engine.num_ordered = num_kept;
+}
+
+/**
+ * Sorts line_order by the current column of the pedestrians (stable counting sort). Followed by sort_pedestrians_by_line, the
+ * pedestrians are ordered by line and then by column, which is the order of the cells in memory.
+*/
+static void sort_pedestrians_by_column()
+{
+    int column_number = cli_args.global_column_number;
+
+    memset(engine.column_start, 0, sizeof(int) * (column_number + 1));
+
+    for(int index = 0; index < engine.num_ordered; index++)
+        engine.column_start[pedestrian_set.list[engine.line_order[index]]->current.col + 1]++;
+
+    for(int j = 0; j < column_number; j++)
+        engine.column_start[j + 1] += engine.column_start[j];
+
+    for(int index = 0; index < engine.num_ordered; index++)
+    {
+        int p_index = engine.line_order[index];
+        engine.sort_buffer[engine.column_start[pedestrian_set.list[p_index]->current.col]++] = p_index;
+    }
+
+    memcpy(engine.line_order, engine.sort_buffer, sizeof(int) * engine.num_ordered);
+}
+
+/**
+ * Orders the pedestrians in the environment by their current cell (line and then column) and copies their structures to a
+ * contiguous buffer in that order, so the phases of the timestep walk the pedestrians, and the grid cells they read, in the
+ * order they are stored in memory. Pedestrians that got out are copied after them.
+ *
+ * @note Only the structures move: ids and the positions in pedestrian_set.list are unchanged, and so are the results.
+ *
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+*/
+static Function_Status reorder_pedestrians()
+{
+    int num_pedestrians = pedestrian_set.num_pedestrians;
+    int destination_index = engine.packed_current ^ 1;
+
+    sort_pedestrians_by_column();
+    sort_pedestrians_by_line();
+
+    if(num_pedestrians > engine.packed_capacity)
+    {
+        tracked_free(engine.packed[destination_index]); // Not referenced: pedestrian_set.list may only point to the current buffer.
+        engine.packed[destination_index] = tracked_malloc(MEMORY_ENGINE, sizeof(struct pedestrian) * num_pedestrians);
+        if(engine.packed[destination_index] == NULL)
+        {
+            fprintf(stderr, "Failure during the allocation of the reordered pedestrian structures.\n");
+            return FAILURE;
+        }
+    }
+
+    struct pedestrian *destination = engine.packed[destination_index];
+    int num_copied = 0;
+
+    for(int index = 0; index < engine.num_ordered; index++)
+        destination[num_copied++] = *pedestrian_set.list[engine.line_order[index]];
+
+    for(int p_index = 0; p_index < num_pedestrians; p_index++)
+    {
+        if(pedestrian_set.list[p_index]->state == GOT_OUT)
+            destination[num_copied++] = *pedestrian_set.list[p_index];
+    }
+
+    for(int copy_index = 0; copy_index < num_copied; copy_index++)
+        pedestrian_set.list[destination[copy_index].id - 1] = &destination[copy_index];
+
+    engine.packed_current = destination_index;
+
+    if(num_pedestrians > engine.packed_capacity)
+    {
+        // The previous buffer is no longer referenced and is reallocated with the new capacity.
+        tracked_free(engine.packed[destination_index ^ 1]);
+        engine.packed[destination_index ^ 1] = tracked_malloc(MEMORY_ENGINE, sizeof(struct pedestrian) * num_pedestrians);
+        if(engine.packed[destination_index ^ 1] == NULL)
+        {
+            fprintf(stderr, "Failure during the allocation of the reordered pedestrian structures.\n");
+            return FAILURE;
+        }
+
+        engine.packed_capacity = num_pedestrians;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * Determines the destination cell and the panic state of each pedestrian in the stripe.
+ *
+ * @param stripe Stripe whose pedestrians will be evaluated.
+*/
+static void evaluate_stripe(Stripe *stripe)
+{
+    for(int index = engine.line_start[stripe->first_line]; index < engine.line_start[stripe->end_line]; index++)
+    {
+        Pedestrian current_pedestrian = pedestrian_set.list[engine.line_order[index]];
+
+        if(current_pedestrian->state == MOVING)
+            find_stripe_smallest_cell(stripe, current_pedestrian, ! cli_args.always_move_to_lowest);
+
+        uint32_t draw = counter_random(engine.timestep, current_pedestrian->id, PANIC_DRAW);
+        COUNT_WORK(stripe->work, WORK_RANDOM_DRAWS, 1);
+        if((draw % 100 + 1) / 100.0 <= PANIC_PROBABILITY)
+            current_pedestrian->in_panic = true;
+    }
+}
+
+/**
+ * Sets the target of the given pedestrian to the neighbor cell with the smallest floor field value, following the rules
+ * of find_smallest_cell. The pedestrian is STOPPED if there is no valid cell to move.
+ *
+ * @param stripe Stripe of the pedestrian, whose work counters are incremented.
+ * @param pedestrian Pedestrian whose movement will be evaluated.
+ * @param unoccupied_only A boolean indicating whether to consider only cells not occupied by a pedestrian (True) or not (False).
+*/
+static void find_stripe_smallest_cell(Stripe *stripe, Pedestrian pedestrian, bool unoccupied_only)
+{
+    double floor_field_values[3][3];
+    Location origin = pedestrian->current;
+    Location candidates[8];
+    double smallest_value = 0;
+    int num_smallest = 0;
+
+    int movement_mask = get_floor_field_neighborhood(origin, floor_field_values);
+    COUNT_WORK(stripe->work, WORK_NEIGHBOR_CANDIDATES, __builtin_popcount(movement_mask));
+
+    for(int j = -1; j < 2; j++)
+    {
+        for(int k = -1; k < 2; k++)
+        {
+            if(j == 0 && k == 0)
+                continue;
+
+            if(! (movement_mask & get_direction_bit(j, k)))
+                continue;
+
+            double cell_value = floor_field_values[1 + j][1 + k];
+
+            if(unoccupied_only && pedestrian_position_grid[origin.lin + j][origin.col + k] > 0)
+                continue;
+
+            if(num_smallest == 0 || cell_value < smallest_value)
+            {
+                smallest_value = cell_value;
+                num_smallest = 0;
+            }
+
+            if(cell_value == smallest_value)
+                candidates[num_smallest++] = (Location){origin.lin + j, origin.col + k};
+        }
+    }
+
+    if(num_smallest == 0)
+    {
+        pedestrian->state = STOPPED; // There isn't a valid cell to move.
+        return;
+    }
+
+    Location drawn_cell = candidates[counter_random(engine.timestep, pedestrian->id, MOVEMENT_DRAW) % num_smallest];
+    COUNT_WORK(stripe->work, WORK_RANDOM_DRAWS, 1);
+
+    if(pedestrian_position_grid[drawn_cell.lin][drawn_cell.col] == 0)
+        pedestrian->target = drawn_cell;
+    else
+        pedestrian->state = STOPPED;
+}
+
+/**
+ * Finds the X movements between the pedestrians of the stripe and their right and lower neighbors. The lower neighbors
+ * of the last line belong to the next stripe (halo line).
+ *
+ * @note The pairs are only stored here, sorted in the order of a line by line scan, and solved by
+ * block_X_movements_in_scan_order, so that the result does not depend on the number of stripes.
+ *
+ * @param stripe Stripe to be scanned.
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+*/
+static Function_Status find_stripe_X_movements(Stripe *stripe)
+{
+    stripe->num_x_movements = 0;
+
+    for(int index = engine.line_start[stripe->first_line]; index < engine.line_start[stripe->end_line]; index++)
+    {
+        Pedestrian first = pedestrian_set.list[engine.line_order[index]];
+        Location c = first->current;
+
+        if(first->state != MOVING || first->in_panic == true)
+            continue;
+
+        if(c.lin < 1 || c.lin >= cli_args.global_line_number - 1 || c.col < 1 || c.col >= cli_args.global_column_number - 1)
+            continue; // Same limits used by block_X_movement.
+
+        int neighbor_ids[2] = {[RIGHT_NEIGHBOR] = pedestrian_position_grid[c.lin][c.col + 1], [LOWER_NEIGHBOR] = pedestrian_position_grid[c.lin + 1][c.col]};
+
+        for(int direction = RIGHT_NEIGHBOR; direction <= LOWER_NEIGHBOR; direction++)
+        {
+            if(neighbor_ids[direction] == 0)
+                continue;
+
+            Pedestrian second = pedestrian_set.list[neighbor_ids[direction] - 1];
+            if(second->state != MOVING || second->in_panic == true)
+                continue;
+
+            COUNT_WORK(stripe->work, WORK_X_MOVEMENT_CHECKS, 1);
+            if(are_movements_crossing(first->current, first->target, second->current, second->target) == false)
+                continue;
+
+            if(stripe->num_x_movements == stripe->x_movements_capacity)
+            {
+                int new_capacity = stripe->x_movements_capacity > 0 ? stripe->x_movements_capacity * 2 : 64;
+                X_Movement *new_list = tracked_realloc(MEMORY_CONFLICT, stripe->x_movements, sizeof(X_Movement) * new_capacity);
+                if(new_list == NULL)
+                {
+                    fprintf(stderr, "Failure in the realloc of the X movements list of a stripe.\n");
+                    return FAILURE;
+                }
+
+                stripe->x_movements = new_list;
+                stripe->x_movements_capacity = new_capacity;
+            }
+
+            long scan_key = ((long) c.lin * cli_args.global_column_number + c.col) * 2 + direction;
+            stripe->x_movements[stripe->num_x_movements++] = (X_Movement){first->id - 1, second->id - 1, scan_key};
+        }
+    }
+
+    // line_order is only sorted by line, so the pairs of a line are put in the order of their columns.
+    qsort(stripe->x_movements, stripe->num_x_movements, sizeof(X_Movement), compare_X_movements);
+
+    return SUCCESS;
+}
+
+/**
+ * Solves the X movements found by every stripe, in the order of a line by line scan (the stripes hold consecutive lines), with
+ * the rules of block_X_movement: a pair is ignored if one of its pedestrians was already stopped, and the lower neighbor is
+ * ignored if the X movement with the right neighbor was solved. Run by a single thread.
+ *
+ * @note The pairs were found before any pedestrian was stopped, so they include every pair the scan would check.
+*/
+static void block_X_movements_in_scan_order()
+{
+    int right_solved_by = -1; // Pedestrian index of the last first pedestrian whose X movement with the right neighbor was solved.
+
+    for(int t = 0; t < engine.num_threads; t++)
+    {
+        Stripe *stripe = &engine.stripes[t];
+
+        for(int x_index = 0; x_index < stripe->num_x_movements; x_index++)
+        {
+            X_Movement x_movement = stripe->x_movements[x_index];
+            Pedestrian first = pedestrian_set.list[x_movement.first_pedestrian];
+            Pedestrian second = pedestrian_set.list[x_movement.second_pedestrian];
+            bool is_lower = x_movement.scan_key % 2 == LOWER_NEIGHBOR;
+
+            if(first->state != MOVING || second->state != MOVING)
+                continue;
+            if(is_lower && right_solved_by == x_movement.first_pedestrian)
+                continue;
+
+            uint32_t draw = counter_random(engine.timestep, first->id, is_lower ? LOWER_X_MOVEMENT_DRAW : X_MOVEMENT_DRAW);
+            COUNT_WORK(engine.stripes[0].work, WORK_RANDOM_DRAWS, 1);
+
+            if(draw % 100 < 50)
+                second->state = STOPPED;
+            else
+                first->state = STOPPED;
+
+            if(! is_lower)
+                right_solved_by = x_movement.first_pedestrian;
+        }
+    }
+}
+
+/**
+ * Compares two X movements by their scan_key, for qsort.
+ *
+ * @param first Pointer to the first X_Movement.
+ * @param second Pointer to the second X_Movement.
+ * @return A negative value, zero or a positive value, if the first X movement is scanned before, at the same time or after the second.
+*/
+static int compare_X_movements(const void *first, const void *second)
+{
+    long first_key = ((const X_Movement *) first)->scan_key, second_key = ((const X_Movement *) second)->scan_key;
+
+    return (first_key > second_key) - (first_key < second_key);
+}
+
+/**
+ * Solves the conflicts for the cells of the stripe. Pedestrians in the halo lines (the lines right before and after the stripe)
+ * may target cells of the stripe and are also considered. The winner of each conflict is the pedestrian with the smallest draw.
+ *
+ * @param stripe Stripe whose cells will have their conflicts solved.
+*/
+static void solve_stripe_conflicts(Stripe *stripe)
+{
+    int first_line = stripe->first_line > 0 ? stripe->first_line - 1 : 0;
+    int end_line = stripe->end_line < cli_args.global_line_number ? stripe->end_line + 1 : cli_args.global_line_number;
+    int first_index = engine.line_start[first_line];
+    int end_index = engine.line_start[end_line];
+
+    for(int pass = 0; pass < 3; pass++)
+    {
+        // pass 0: claim the target cells; pass 1: identify the losers; pass 2: clean the claim_grid.
+        for(int index = first_index; index < end_index; index++)
+        {
+            int p_index = engine.line_order[index];
+            Pedestrian current_pedestrian = pedestrian_set.list[p_index];
+
+            if(current_pedestrian->state != MOVING || current_pedestrian->in_panic == true)
+                continue;
+
+            Location target = current_pedestrian->target;
+            if(target.lin < stripe->first_line || target.lin >= stripe->end_line)
+                continue; // Cells of other stripes are handled by their threads.
+
+            int *claim = &(engine.claim_grid[target.lin][target.col]);
+
+            if(pass == 0)
+            {
+                if(*claim == 0)
+                    *claim = p_index + 1;
+                else
+                {
+                    uint32_t current_draw = counter_random(engine.timestep, current_pedestrian->id, CONFLICT_DRAW);
+                    uint32_t winner_draw = counter_random(engine.timestep, *claim, CONFLICT_DRAW);
+                    COUNT_WORK(stripe->work, WORK_RANDOM_DRAWS, 2);
+
+                    if(current_draw < winner_draw || (current_draw == winner_draw && p_index + 1 < *claim))
+                        *claim = p_index + 1;
+                }
+            }
+            else if(pass == 1)
+            {
+                int winner = *claim > 0 ? *claim : -*claim;
+                engine.lost_conflict[p_index] = winner != p_index + 1;
+
+                if(engine.lost_conflict[p_index] && *claim > 0)
+                {
+                    *claim = -winner; // The first loser marks the cell, so that each conflict is counted once.
+                    COUNT_WORK(stripe->work, WORK_CONFLICTS, 1);
+                }
+            }
+            else
+            {
+                *claim = 0;
+                COUNT_WORK(stripe->work, WORK_CELLS_RESET, 1);
+            }
+        }
+    }
+}
+
+/**
+ * Moves the pedestrians of the stripe, as done by apply_pedestrian_movement, and updates the pedestrian position grid,
+ * the heatmap, their states and their panic flags.
+ *
+ * @note Targets are always empty cells at the beginning of the timestep, so each cell is written by a single thread.
+ *
+ * @param stripe Stripe whose pedestrians will be moved.
+*/
+static void apply_stripe_movement(Stripe *stripe)
+{
+    for(int index = engine.line_start[stripe->first_line]; index < engine.line_start[stripe->end_line]; index++)
+    {
+        int p_index = engine.line_order[index];
+        Pedestrian current_pedestrian = pedestrian_set.list[p_index];
+
+        if(engine.lost_conflict[p_index])
+        {
+            current_pedestrian->state = STOPPED;
+            engine.lost_conflict[p_index] = false;
+        }
+
+        Location previous = current_pedestrian->current;
+
+        if(current_pedestrian->in_panic == false)
+        {
+            if(current_pedestrian->state == MOVING)
+            {
+                current_pedestrian->current = current_pedestrian->target;
+
+                if(exits_set.cell_types[current_pedestrian->current.lin][current_pedestrian->current.col] == CELL_EXIT)
+                    current_pedestrian->state = cli_args.immediate_exit ? GOT_OUT : LEAVING;
+            }
+            else if(current_pedestrian->state == LEAVING)
+                current_pedestrian->state = GOT_OUT;
+        }
+
+        pedestrian_position_grid[previous.lin][previous.col] = 0;
+
+        if(current_pedestrian->state == GOT_OUT)
+        {
+            stripe->num_got_out++;
+            continue;
+        }
+
+        pedestrian_position_grid[current_pedestrian->current.lin][current_pedestrian->current.col] = current_pedestrian->id;
+        heatmap_grid[current_pedestrian->current.lin][current_pedestrian->current.col]++;
+
+        if(current_pedestrian->state != LEAVING)
+            current_pedestrian->state = MOVING;
+        current_pedestrian->in_panic = false;
+    }
+}
+
+/**
+ * Derives a random number from the seed of the simulation, the timestep, the pedestrian id and the purpose of the draw.
+ * The same arguments always produce the same number, whatever the order of the calls or the thread making them.
+ *
+ * @param timestep Current timestep.
+ * @param pedestrian_id Id of the pedestrian related to the draw.
+ * @param purpose What the number will be used for.
+ * @return A pseudo-random 32-bit unsigned integer.
+*/
+static inline uint32_t counter_random(int timestep, int pedestrian_id, enum Random_Purpose purpose)
+{
+    uint64_t z = engine.seed_key;
+    z = mix_bits(z ^ ((uint64_t) (uint32_t) timestep * 0x9E3779B97F4A7C15ULL));
+    z = mix_bits(z ^ ((uint64_t) (uint32_t) pedestrian_id * 0xC2B2AE3D27D4EB4FULL + purpose));
+
+    return (uint32_t) (z >> 32);
+}
+
+/**
+ * Finalizer of the splitmix64 generator, used to scramble the bits of the counters.
+ *
+ * @param z Value to be scrambled.
+ * @return The scrambled value.
+*/
+static inline uint64_t mix_bits(uint64_t z)
+{
+    z += 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+    return z ^ (z >> 31);
+}
@@ -13,12 +13,13 @@
 #include"../headers/cell.h"
 #include"../headers/exit.h"
 #include"../headers/grid.h"
+#include"../headers/arena.h"
+#include"../headers/memory.h"
+#include"../headers/profile.h"
 #include"../headers/pedestrian.h"
 #include"../headers/cli_processing.h"
 #include"../headers/shared_resources.h"
 
-#define PANIC_PROBABILITY 0.05
-
 typedef struct reduced_line_equation{
     double angular_coefficient;
     double linear_coefficient; // Where the line intersects the y-axis.
@@ -26,18 +27,33 @@ typedef struct reduced_line_equation{
 
 typedef struct cell_conflict{
     int num_pedestrians;
-    int pedestrian_ids[8];
+    int pedestrian_ids[8]; // Only the 8 neighbours of a cell can target it, so a conflict never has more pedestrians.
     int pedestrian_allowed;
 }cell_conflict;
 
-Pedestrian_Set pedestrian_set = {NULL,0};
+// Structures reused across timesteps, so no phase allocates or scans the whole grid at every timestep.
+typedef struct{
+    Int_Grid conflict_grid; // Kept zeroed between timesteps. Only the targeted cells are written and then cleared.
+    Cell_Conflict conflict_list;
+    int conflict_capacity;
+    int *scan_order; // Pedestrians in the environment, sorted by their cell in the order of a line by line scan of the grid.
+    int *scan_buffer;
+    int *cell_count; // Counters of the counting sort, with max(global_line_number, global_column_number) + 1 positions.
+    int scan_capacity;
+}Timestep_Structures;
+
+Pedestrian_Set pedestrian_set = {NULL,0,0};
+
+static Timestep_Structures timestep_structures = {NULL, NULL, 0, NULL, NULL, NULL, 0};
 
 static Pedestrian create_pedestrian(Location ped_coordinates);
 static bool are_pedestrian_paths_crossing(Pedestrian first_pedestrian, Pedestrian second_pedestrian);
 static Function_Status calculate_reduced_line_equation(Location origin, Location target, reduced_line_equation* line);
 static void calculate_intersection_point(reduced_line_equation first_line, reduced_line_equation second_line, double *x, double *y);
-static bool is_intersection_within_pedestrian_movement(double x_coordinate, double y_coordinate, Pedestrian pedestrian);
+static bool is_intersection_within_movement(double x_coordinate, double y_coordinate, Location current, Location target);
 static void solve_X_movement(Pedestrian first_pedestrian, Pedestrian second_pedestrian);
+static Function_Status grow_conflict_list(int minimum_capacity);
+static int sort_pedestrians_by_cell();
 
 /**
  * Inserts a specified number of pedestrians at random locations within the environment.
@@ -62,6 +78,7 @@ Function_Status insert_pedestrians_at_random(int num_pedestrians_to_insert)
     {
         int line = rand() % (cli_args.global_line_number - 1) + 1;
         int column = rand() % (cli_args.global_column_number - 1) + 1;
+        COUNT_WORK(work_counters, WORK_RANDOM_DRAWS, 2);
 
         Location random_coordinates = {line,column};
 
@@ -71,8 +88,7 @@ Function_Status insert_pedestrians_at_random(int num_pedestrians_to_insert)
                 continue;
         }
 
-        if(pedestrian_position_grid[line][column] != 0 || exits_set.final_floor_field[line][column] == EXIT_VALUE 
-            || exits_set.final_floor_field[line][column] == WALL_VALUE)
+        if(pedestrian_position_grid[line][column] != 0 || exits_set.cell_types[line][column] != CELL_FLOOR)
             continue;
 
         if( add_new_pedestrian(random_coordinates) == FAILURE)
@@ -103,14 +119,23 @@ Function_Status add_new_pedestrian(Location ped_coordinates)
         return FAILURE;
     }
 
-    pedestrian_set.num_pedestrians += 1;
-    pedestrian_set.list = realloc(pedestrian_set.list, sizeof(struct pedestrian) * pedestrian_set.num_pedestrians);
-    if(pedestrian_set.list == NULL)
+    if(pedestrian_set.num_pedestrians == pedestrian_set.capacity)
     {
-        fprintf(stderr,"Failure in the realloc of the pedestrian_set list.\n");
-        return FAILURE;
+        // The list grows geometrically, so loading or inserting N pedestrians costs O(N) copies instead of O(N^2).
+        int new_capacity = pedestrian_set.capacity == 0 ? 64 : pedestrian_set.capacity * 2;
+        Pedestrian *new_list = tracked_realloc(MEMORY_PEDESTRIAN, pedestrian_set.list, sizeof(Pedestrian) * new_capacity);
+        if(new_list == NULL)
+        {
+            fprintf(stderr,"Failure in the realloc of the pedestrian_set list.\n");
+            return FAILURE;
+        }
+
+        pedestrian_set.list = new_list;
+        pedestrian_set.capacity = new_capacity;
     }
 
+    pedestrian_set.num_pedestrians += 1;
+
     new_pedestrian->id = pedestrian_set.num_pedestrians;
     pedestrian_set.list[pedestrian_set.num_pedestrians - 1] = new_pedestrian;
 
@@ -118,18 +143,28 @@ Function_Status add_new_pedestrian(Location ped_coordinates)
 }
 
 
+/**
+ * Removes all pedestrians from the pedestrian set, at the end of a simulation. The pedestrians are released by resetting the 
+ * replica_arena, and the list is kept for the pedestrians of the next simulation.
+*/
+void clear_pedestrian_set()
+{
+    pedestrian_set.num_pedestrians = 0;
+    reset_arena(&replica_arena);
+}
+
 /**
  * Deallocate the pedestrian_set list and reset the number of pedestrians.
 */
 void deallocate_pedestrians()
 {
-    for(int p_index = 0; p_index < pedestrian_set.num_pedestrians; p_index++)
-        free(pedestrian_set.list[p_index]);
-        
-    free(pedestrian_set.list);
+    deallocate_arena(&replica_arena);
+
+    tracked_free(pedestrian_set.list);
     pedestrian_set.list = NULL;
 
     pedestrian_set.num_pedestrians = 0;
+    pedestrian_set.capacity = 0;
 }
 
 /**
@@ -146,6 +181,7 @@ int determine_pedestrians_in_panic()
         if(pedestrian_set.list[p_index]->state == GOT_OUT)
             continue;
 
+        COUNT_WORK(work_counters, WORK_RANDOM_DRAWS, 1);
         if((rand() % 100 + 1) / 100.0 <= PANIC_PROBABILITY)
         {
             pedestrian_set.list[p_index]->in_panic = true;
@@ -192,21 +228,26 @@ void evaluate_pedestrians_movements()
 /**
  * Verifies the target cells of all pedestrians and identifies cases where multiple pedestrians aim to move to the same cell.
  * 
- * @param pedestrian_conflicts A pointer to a pointer to a cell_conflict structure, representing the address of a list of cell_conflict structures. The function will create this list of conflicts and assign its pointer to the provided pointer. 
+ * @note The conflict list is reused across timesteps and must not be freed by the caller (see deallocate_timestep_structures).
+ * 
+ * @param pedestrian_conflicts A pointer to a pointer to a cell_conflict structure, representing the address of a list of cell_conflict structures. The function will fill this list of conflicts and assign its pointer to the provided pointer. 
  * @param num_conflicts Pointer to a integer, where the number of conflicts will be stored.
  * @return Function_Status: FAILURE (0) or SUCCESS (1).
 */
 Function_Status identify_pedestrian_conflicts(Cell_Conflict *pedestrian_conflicts, int *num_conflicts)
 {
     int conflict_number = 0;
-    Int_Grid conflict_grid = allocate_integer_grid(cli_args.global_line_number,cli_args.global_column_number);
-    if(conflict_grid == NULL)
+    if(timestep_structures.conflict_grid == NULL)
     {
-        fprintf(stderr, "Failure in the allocation of the conflict_grid.\n");
-        return FAILURE;
+        timestep_structures.conflict_grid = allocate_integer_grid(cli_args.global_line_number,cli_args.global_column_number);
+        if(timestep_structures.conflict_grid == NULL)
+        {
+            fprintf(stderr, "Failure in the allocation of the conflict_grid.\n");
+            return FAILURE;
+        }
     }
 
-    Cell_Conflict conflict_list = NULL;
+    Int_Grid conflict_grid = timestep_structures.conflict_grid;
 
     for(int p_index = 0; p_index < pedestrian_set.num_pedestrians; p_index++)
     {
@@ -227,14 +268,10 @@ Function_Status identify_pedestrian_conflicts(Cell_Conflict *pedestrian_conflict
         if(*target_cell > 0) // Exactly one pedestrian has the same target cell (so far).
         {
             // A new conflict has been found. A cell_conflict structure is created and filled.
-            conflict_list = realloc(conflict_list, sizeof(cell_conflict) * (conflict_number + 1));
-            if(conflict_list == NULL)
-            {
-                fprintf(stderr,"Failure in the realloc of the conflict_list.\n");
+            if(conflict_number == timestep_structures.conflict_capacity && grow_conflict_list(conflict_number + 1) == FAILURE)
                 return FAILURE;
-            }
 
-            Cell_Conflict current_conflict = &(conflict_list[conflict_number]);
+            Cell_Conflict current_conflict = &(timestep_structures.conflict_list[conflict_number]);
 
             current_conflict->pedestrian_ids[0] = *target_cell;
             current_conflict->pedestrian_ids[1] = current_pedestrian->id;
@@ -254,16 +291,28 @@ Function_Status identify_pedestrian_conflicts(Cell_Conflict *pedestrian_conflict
         // Futhermore, the corresponding index of the cell_conflict for this cell can be obtained by the following expression.
 
         int conflict_index = (*target_cell * -1) - 1;
-        Cell_Conflict current_conflict = &(conflict_list[conflict_index]);
+        Cell_Conflict current_conflict = &(timestep_structures.conflict_list[conflict_index]);
 
         current_conflict->pedestrian_ids[current_conflict->num_pedestrians] = current_pedestrian->id;
         current_conflict->num_pedestrians++;
         // Adds the new id to the cell_conflict structure.
     }
 
-    deallocate_grid((void **) conflict_grid,cli_args.global_line_number);
+    // Only the targeted cells were written, so only them need to be cleared for the next timestep.
+    for(int p_index = 0; p_index < pedestrian_set.num_pedestrians; p_index++)
+    {
+        Pedestrian current_pedestrian = pedestrian_set.list[p_index];
+
+        if(current_pedestrian->state == MOVING && current_pedestrian->in_panic == false)
+        {
+            conflict_grid[current_pedestrian->target.lin][current_pedestrian->target.col] = 0;
+            COUNT_WORK(work_counters, WORK_CELLS_RESET, 1);
+        }
+    }
+
+    COUNT_WORK(work_counters, WORK_CONFLICTS, conflict_number);
 
-    *pedestrian_conflicts = conflict_list;
+    *pedestrian_conflicts = timestep_structures.conflict_list;
     *num_conflicts = conflict_number;
 
     return SUCCESS;
@@ -288,6 +337,7 @@ Function_Status solve_pedestrian_conflicts(Cell_Conflict pedestrian_conflicts, i
     {
         Cell_Conflict current_conflict = &(pedestrian_conflicts[conflict_index]);
         int random_result = rand() % current_conflict->num_pedestrians;
+        COUNT_WORK(work_counters, WORK_RANDOM_DRAWS, 1);
 
         current_conflict->pedestrian_allowed = current_conflict->pedestrian_ids[random_result];
         for(int p_index = 0; p_index < current_conflict->num_pedestrians; p_index++)
@@ -330,59 +380,66 @@ void print_pedestrian_conflict_information(Cell_Conflict pedestrian_conflicts, i
 
 /**
  * Scans the pedestrian_position_grid to find adjacent pedestrians where their movement path cross (X movement) and resolves the conflict by allowing only one pedestrian to move.
+ * 
+ * @note Instead of visiting every cell of the grid, only the cells occupied by pedestrians are visited, in the same order of a 
+ * line by line scan of the grid. Thus, the X movements are solved in the same order (and with the same random draws) as a full scan.
+ * 
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
  */
-void block_X_movement()
+Function_Status block_X_movement()
 {
     bool is_X_movement;
+    int num_scanned = sort_pedestrians_by_cell();
+    if(num_scanned < 0)
+        return FAILURE;
 
-    //Except for the exits, there are no pedestrians at the boundaries of the environment, so no checks are performed there.
-    for(int i = 1; i < cli_args.global_line_number - 1; i++) 
+    for(int scan_index = 0; scan_index < num_scanned; scan_index++)
     {
-        for(int h = 1; h < cli_args.global_column_number - 1; h++)
-        {
-            int first_pedestrian_id = pedestrian_position_grid[i][h];
-            if(first_pedestrian_id > 0) // there is a pedestrian on the cell
-            {
-                if(pedestrian_set.list[first_pedestrian_id - 1]->state != MOVING  || 
-                    pedestrian_set.list[first_pedestrian_id - 1]->in_panic == true)
-                    continue;
+        int first_pedestrian_id = timestep_structures.scan_order[scan_index];
+        Location first_location = pedestrian_set.list[first_pedestrian_id - 1]->current;
+        int i = first_location.lin, h = first_location.col;
 
-                // X movements only occur between pedestrians located in vertically or horizontally adjacent cells,
-                // so only those cells need to be verified. Due to the scanning method, the [i-1][h] and [i][h-1] cells
-                // have already been checked for X movements (or did not require any check), so only the cells located
-                // at [i][h+1] and [i+1][h] need to be verified.        
+        if(pedestrian_set.list[first_pedestrian_id - 1]->state != MOVING  || 
+            pedestrian_set.list[first_pedestrian_id - 1]->in_panic == true)
+            continue;
 
-                int second_pedestrian_id = pedestrian_position_grid[i][h + 1];
-                if(second_pedestrian_id > 0)  // there is a pedestrian on the cell
-                {
-                    is_X_movement = are_pedestrian_paths_crossing(pedestrian_set.list[first_pedestrian_id- 1], pedestrian_set.list[second_pedestrian_id - 1]);
+        // X movements only occur between pedestrians located in vertically or horizontally adjacent cells,
+        // so only those cells need to be verified. Due to the scanning method, the [i-1][h] and [i][h-1] cells
+        // have already been checked for X movements (or did not require any check), so only the cells located
+        // at [i][h+1] and [i+1][h] need to be verified.        
 
-                    if(is_X_movement == true)
-                    {
-                        solve_X_movement(pedestrian_set.list[first_pedestrian_id- 1], pedestrian_set.list[second_pedestrian_id - 1]);
-                        continue;
-                    }
+        int second_pedestrian_id = pedestrian_position_grid[i][h + 1];
+        if(second_pedestrian_id > 0)  // there is a pedestrian on the cell
+        {
+            is_X_movement = are_pedestrian_paths_crossing(pedestrian_set.list[first_pedestrian_id- 1], pedestrian_set.list[second_pedestrian_id - 1]);
 
-                }
+            if(is_X_movement == true)
+            {
+                solve_X_movement(pedestrian_set.list[first_pedestrian_id- 1], pedestrian_set.list[second_pedestrian_id - 1]);
+                continue;
+            }
 
-                second_pedestrian_id = pedestrian_position_grid[i + 1][h];
-                if(second_pedestrian_id > 0) // there is a pedestrian on the cell
-                {
-                    is_X_movement = are_pedestrian_paths_crossing(pedestrian_set.list[first_pedestrian_id- 1], pedestrian_set.list[second_pedestrian_id - 1]);
+        }
 
-                    if(is_X_movement == true)
-                        solve_X_movement(pedestrian_set.list[first_pedestrian_id- 1], pedestrian_set.list[second_pedestrian_id - 1]);
+        second_pedestrian_id = pedestrian_position_grid[i + 1][h];
+        if(second_pedestrian_id > 0) // there is a pedestrian on the cell
+        {
+            is_X_movement = are_pedestrian_paths_crossing(pedestrian_set.list[first_pedestrian_id- 1], pedestrian_set.list[second_pedestrian_id - 1]);
+
+            if(is_X_movement == true)
+                solve_X_movement(pedestrian_set.list[first_pedestrian_id- 1], pedestrian_set.list[second_pedestrian_id - 1]);
 
-                }
-            }
         }
-    }    
+    }
+
+    return SUCCESS;
 }
 
 /**
  *  Pedestrians in MOVING state are moved to their target location (the target Location is copied to the current Location). Upon reaching an exit, their state changes to LEAVING; those already in an exit transition to GOT_OUT. This is how the movement of a pedestrian is done.
  * 
  * @note If the immediate_exit flag is on, the pedestrians go directly from MOVING to GOT_OUT when a exit is reached.
+ * @note The cells left by the pedestrians are cleared in the pedestrian_position_grid. The new positions are written by update_pedestrian_position_grid.
  * 
 */
 void apply_pedestrian_movement()
@@ -396,16 +453,20 @@ void apply_pedestrian_movement()
 
         if(current_pedestrian->state == MOVING)
         {
+            pedestrian_position_grid[current_pedestrian->current.lin][current_pedestrian->current.col] = 0;
             current_pedestrian->current = current_pedestrian->target;
 
-            if(exits_set.final_floor_field[current_pedestrian->current.lin][current_pedestrian->current.col] == EXIT_VALUE)
+            if(exits_set.cell_types[current_pedestrian->current.lin][current_pedestrian->current.col] == CELL_EXIT)
             {
                 current_pedestrian->state = cli_args.immediate_exit ? GOT_OUT : LEAVING; 
                 // Leaving means the pedestrian will remain for a timestep before being removed from the environment.
             }
         }
         else if(current_pedestrian->state == LEAVING)
+        {
+            pedestrian_position_grid[current_pedestrian->current.lin][current_pedestrian->current.col] = 0;
             current_pedestrian->state = GOT_OUT; // After a timestep in the exit the pedestrian is removed from the environment.
+        }
     }
 }
 
@@ -426,12 +487,30 @@ bool is_environment_empty()
 }
 
 /**
- * Reset the pedestrian_position_grid and update it with the current position of all pedestrians still in the environment.
+ * Counts the pedestrians still in the environment (not in the GOT_OUT state).
+ * 
+ * @return Number of pedestrians in the environment.
 */
-void update_pedestrian_position_grid()
+int count_pedestrians_in_environment()
 {
-    reset_integer_grid(pedestrian_position_grid, cli_args.global_line_number, cli_args.global_column_number);
+    int num_in_environment = 0;
 
+    for(int p_index = 0; p_index < pedestrian_set.num_pedestrians; p_index++)
+    {
+        if(pedestrian_set.list[p_index]->state != GOT_OUT)
+            num_in_environment++;
+    }
+
+    return num_in_environment;
+}
+
+/**
+ * Update the pedestrian_position_grid with the current position of all pedestrians still in the environment.
+ * 
+ * @note The cells left during the timestep were already cleared by apply_pedestrian_movement, so the grid isn't reset here.
+*/
+void update_pedestrian_position_grid()
+{
     for(int p_index = 0; p_index < pedestrian_set.num_pedestrians; p_index++)
     {
         Pedestrian current_pedestrian = pedestrian_set.list[p_index];
@@ -487,6 +566,63 @@ void reset_pedestrians_structures()
     }
 }
 
+/**
+ * Deallocate the structures reused across timesteps (conflict grid, conflict list and scan buffers).
+*/
+void deallocate_timestep_structures()
+{
+    deallocate_grid((void **) timestep_structures.conflict_grid, cli_args.global_line_number);
+    tracked_free(timestep_structures.conflict_list);
+    tracked_free(timestep_structures.scan_order);
+    tracked_free(timestep_structures.scan_buffer);
+    tracked_free(timestep_structures.cell_count);
+
+    timestep_structures = (Timestep_Structures) {NULL, NULL, 0, NULL, NULL, NULL, 0};
+}
+
+/**
+ * Verifies if the movements from first_current to first_target and from second_current to second_target cross each other 
+ * (X movement), using the reduced straight line formula and intersection of lines.
+ * 
+ * @note The states of the pedestrians performing the movements are not verified here.
+ * 
+ * @param first_current Current location of the first pedestrian.
+ * @param first_target Target location of the first pedestrian.
+ * @param second_current Current location of the second pedestrian, adjacent to the first one.
+ * @param second_target Target location of the second pedestrian.
+ * @return bool, where True indicates that the paths cross and False otherwise.
+*/
+bool are_movements_crossing(Location first_current, Location first_target, Location second_current, Location second_target)
+{
+    reduced_line_equation first_line, second_line;
+    // Each straight line struct represents the line containing the segment from the initial to the target location of each pedestrian.
+
+    if(calculate_reduced_line_equation(first_current, first_target, &first_line) == FAILURE ||
+       calculate_reduced_line_equation(second_current, second_target, &second_line) == FAILURE)
+        return false; //Vertical lines doesn't allow the occurrence of X movement.
+
+    if(first_line.angular_coefficient == 0.0 || second_line.angular_coefficient == 0.0)
+        return false; // angular_coefficient equals zero results in a horizontal line, where X movements cannot occur.
+
+    if(first_line.angular_coefficient == second_line.angular_coefficient)
+        return false; // Lines are equal or parallel, and therefore X movements cannot occur.
+
+    double intersect_x, intersect_y;
+
+    calculate_intersection_point(first_line, second_line, &intersect_x, &intersect_y);    
+
+    // .lin corresponds to the y-axis and .col corresponds to the x-axis.
+
+    if(first_target.col == intersect_x && first_target.lin == intersect_y)       
+        return false; // The intersect point coincides with the target cell coordinates of one pedestrian. This means that both aim to move to the same cell and this characterizes a simples conflict. These conflicts are solved elsewhere. 
+    
+    if(is_intersection_within_movement(intersect_x, intersect_y, first_current, first_target) == true &&
+       is_intersection_within_movement(intersect_x, intersect_y, second_current, second_target) == true)
+        return true; // A X movement happens
+
+    return false;
+}
+
 /* ---------------- ---------------- ---------------- ---------------- ---------------- */
 /* ---------------- ---------------- STATIC FUNCTIONS ---------------- ---------------- */
 /* ---------------- ---------------- ---------------- ---------------- ---------------- */
@@ -501,7 +637,7 @@ void reset_pedestrians_structures()
 */ 
 static Pedestrian create_pedestrian(Location ped_coordinates)
 {
-    Pedestrian new_pedestrian = malloc(sizeof(struct pedestrian));
+    Pedestrian new_pedestrian = arena_allocate(&replica_arena, sizeof(struct pedestrian));
     if(new_pedestrian != NULL)
     {
         new_pedestrian->current = new_pedestrian->origin = ped_coordinates;
@@ -528,33 +664,9 @@ static bool are_pedestrian_paths_crossing(Pedestrian first_pedestrian, Pedestria
         first_pedestrian->in_panic == true || second_pedestrian->in_panic == true)
         return false;
 
-    reduced_line_equation first_line, second_line;
-    // Each straight line struct represents the line containing the segment from the initial to the target location of each pedestrian.
-
-    if(calculate_reduced_line_equation(first_pedestrian->current, first_pedestrian->target, &first_line) == FAILURE ||
-       calculate_reduced_line_equation(second_pedestrian->current, second_pedestrian->target, &second_line) == FAILURE)
-        return false; //Vertical lines doesn't allow the occurrence of X movement.
-
-    if(first_line.angular_coefficient == 0.0 || second_line.angular_coefficient == 0.0)
-        return false; // angular_coefficient equals zero results in a horizontal line, where X movements cannot occur.
-
-    if(first_line.angular_coefficient == second_line.angular_coefficient)
-        return false; // Lines are equal or parallel, and therefore X movements cannot occur.
-
-    double intersect_x, intersect_y;
-
-    calculate_intersection_point(first_line, second_line, &intersect_x, &intersect_y);    
-
-    // .lin corresponds to the y-axis and .col corresponds to the x-axis.
-
-    if(first_pedestrian->target.col == intersect_x && first_pedestrian->target.lin == intersect_y)       
-        return false; // The intersect point coincides with the target cell coordinates of one pedestrian. This means that both aim to move to the same cell and this characterizes a simples conflict. These conflicts are solved elsewhere. 
-    
-    if(is_intersection_within_pedestrian_movement(intersect_x, intersect_y, first_pedestrian) == true &&
-       is_intersection_within_pedestrian_movement(intersect_x, intersect_y, second_pedestrian) == true)
-        return true; // A X movement happens
-
-    return false;
+    COUNT_WORK(work_counters, WORK_X_MOVEMENT_CHECKS, 1);
+    return are_movements_crossing(first_pedestrian->current, first_pedestrian->target, 
+                                  second_pedestrian->current, second_pedestrian->target);
 }
 
 /**
@@ -615,19 +727,20 @@ static void calculate_intersection_point(reduced_line_equation first_line, reduc
 }
 
 /**
- * Verifies if the point (x_coordinate, y_coordinate) is within a the line segment defined by the current and target locations of the given pedestrian.
+ * Verifies if the point (x_coordinate, y_coordinate) is within a the line segment defined by the current and target locations of a pedestrian.
  * 
  * @param x_coordinate A double, representing the x-axis coordinate.
  * @param y_coordinate A double, representing the y-axis coordinate.
- * @param first_pedestrian A Pedestrian.
+ * @param current Current location of the pedestrian.
+ * @param target Target location of the pedestrian.
  * @return bool, where True indicates that the point is within the line segment.
 */
-static bool is_intersection_within_pedestrian_movement(double x_coordinate, double y_coordinate, Pedestrian pedestrian)
+static bool is_intersection_within_movement(double x_coordinate, double y_coordinate, Location current, Location target)
 {
-    return  x_coordinate > fmin(pedestrian->current.col, pedestrian->target.col) && 
-            x_coordinate < fmax(pedestrian->current.col, pedestrian->target.col) && 
-            y_coordinate > fmin(pedestrian->current.lin, pedestrian->target.lin) && 
-            y_coordinate < fmax(pedestrian->current.lin, pedestrian->target.lin);
+    return  x_coordinate > fmin(current.col, target.col) && 
+            x_coordinate < fmax(current.col, target.col) && 
+            y_coordinate > fmin(current.lin, target.lin) && 
+            y_coordinate < fmax(current.lin, target.lin);
 }
 
 /**
@@ -639,6 +752,7 @@ static bool is_intersection_within_pedestrian_movement(double x_coordinate, doub
 static void solve_X_movement(Pedestrian first_pedestrian, Pedestrian second_pedestrian)
 {
     int sorted_num = rand() % 100;
+    COUNT_WORK(work_counters, WORK_RANDOM_DRAWS, 1);
 
     if(sorted_num < 50)
         second_pedestrian->state = STOPPED;
@@ -648,4 +762,114 @@ static void solve_X_movement(Pedestrian first_pedestrian, Pedestrian second_pede
     if(cli_args.show_debug_information)
         printf("X Movement between %d and %d --> %d.\n", first_pedestrian->id, second_pedestrian->id, 
                                                          sorted_num < 50 ? first_pedestrian->id : second_pedestrian->id);
-}
\ No newline at end of file
+}
+
+/**
+ * Grows the conflict list geometrically, keeping the conflicts already stored.
+ * 
+ * @param minimum_capacity Minimum number of conflicts the list must be able to store.
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+*/
+static Function_Status grow_conflict_list(int minimum_capacity)
+{
+    int new_capacity = timestep_structures.conflict_capacity == 0 ? 64 : timestep_structures.conflict_capacity * 2;
+    if(new_capacity < minimum_capacity)
+        new_capacity = minimum_capacity;
+
+    Cell_Conflict new_list = tracked_realloc(MEMORY_CONFLICT, timestep_structures.conflict_list, sizeof(cell_conflict) * new_capacity);
+    if(new_list == NULL)
+    {
+        fprintf(stderr,"Failure in the realloc of the conflict_list.\n");
+        return FAILURE;
+    }
+
+    timestep_structures.conflict_list = new_list;
+    timestep_structures.conflict_capacity = new_capacity;
+
+    return SUCCESS;
+}
+
+/**
+ * Sorts the IDs of the pedestrians located inside the environment (not at its boundaries) by line and then by column, 
+ * storing them at timestep_structures.scan_order. Two passes of counting sort are used (by column and then, stable, by line), 
+ * so the cost is proportional to the number of pedestrians plus the grid dimensions, instead of the number of cells.
+ * 
+ * @return The number of pedestrians stored in scan_order, or -1 if the scan buffers couldn't be allocated.
+*/
+static int sort_pedestrians_by_cell()
+{
+    int line_number = cli_args.global_line_number, column_number = cli_args.global_column_number;
+    int max_dimension = line_number > column_number ? line_number : column_number;
+
+    if(pedestrian_set.num_pedestrians == 0)
+        return 0;
+
+    if(timestep_structures.scan_capacity < pedestrian_set.num_pedestrians || timestep_structures.cell_count == NULL)
+    {
+        tracked_free(timestep_structures.scan_order);
+        tracked_free(timestep_structures.scan_buffer);
+        tracked_free(timestep_structures.cell_count);
+
+        timestep_structures.scan_order = tracked_malloc(MEMORY_CONFLICT, sizeof(int) * pedestrian_set.num_pedestrians);
+        timestep_structures.scan_buffer = tracked_malloc(MEMORY_CONFLICT, sizeof(int) * pedestrian_set.num_pedestrians);
+        timestep_structures.cell_count = tracked_malloc(MEMORY_CONFLICT, sizeof(int) * (max_dimension + 1));
+        if(timestep_structures.scan_order == NULL || timestep_structures.scan_buffer == NULL || timestep_structures.cell_count == NULL)
+        {
+            fprintf(stderr, "Failure in the allocation of the X movement scan buffers.\n");
+            timestep_structures.scan_capacity = 0;
+            return -1;
+        }
+
+        timestep_structures.scan_capacity = pedestrian_set.num_pedestrians;
+    }
+
+    int *order = timestep_structures.scan_order, *buffer = timestep_structures.scan_buffer, *count = timestep_structures.cell_count;
+    int num_scanned = 0;
+
+    // First pass: by column. The boundaries of the environment are not scanned (only exits can hold pedestrians there).
+    for(int h = 0; h <= column_number; h++)
+        count[h] = 0;
+
+    for(int p_index = 0; p_index < pedestrian_set.num_pedestrians; p_index++)
+    {
+        Pedestrian current_pedestrian = pedestrian_set.list[p_index];
+        Location location = current_pedestrian->current;
+
+        if(current_pedestrian->state == GOT_OUT || location.lin < 1 || location.lin >= line_number - 1 || 
+            location.col < 1 || location.col >= column_number - 1)
+            continue;
+
+        count[location.col + 1]++;
+        num_scanned++;
+    }
+
+    for(int h = 0; h < column_number; h++)
+        count[h + 1] += count[h];
+
+    for(int p_index = 0; p_index < pedestrian_set.num_pedestrians; p_index++)
+    {
+        Pedestrian current_pedestrian = pedestrian_set.list[p_index];
+        Location location = current_pedestrian->current;
+
+        if(current_pedestrian->state == GOT_OUT || location.lin < 1 || location.lin >= line_number - 1 || 
+            location.col < 1 || location.col >= column_number - 1)
+            continue;
+
+        buffer[count[location.col]++] = current_pedestrian->id;
+    }
+
+    // Second pass: by line, keeping the column order of the first pass.
+    for(int i = 0; i <= line_number; i++)
+        count[i] = 0;
+
+    for(int index = 0; index < num_scanned; index++)
+        count[pedestrian_set.list[buffer[index] - 1]->current.lin + 1]++;
+
+    for(int i = 0; i < line_number; i++)
+        count[i + 1] += count[i];
+
+    for(int index = 0; index < num_scanned; index++)
+        order[count[pedestrian_set.list[buffer[index] - 1]->current.lin]++] = buffer[index];
+
+    return num_scanned;
+}
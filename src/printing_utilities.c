@@ -6,15 +6,33 @@
 */
 
 #include<stdio.h>
+#include<stdint.h>
 #include<string.h>
+#include<math.h>
 #include<time.h>
 
 #include"../headers/exit.h"
+#include"../headers/grid.h"
+#include"../headers/memory.h"
 #include"../headers/pedestrian.h"
 #include"../headers/cli_processing.h"
 #include"../headers/printing_utilities.h"
 #include"../headers/shared_resources.h"
 
+#define OUTPUT_CHUNK_SIZE 65536 // Bytes of formatted text gathered before each write to the output stream.
+#define MAX_FORMATTED_VALUE 400 // Longest text appended at once (a double of any magnitude printed with %.2lf).
+
+// Text of a grid being printed, written to the output stream at the end of each line of the grid or when full.
+static char output_chunk[OUTPUT_CHUNK_SIZE];
+static int chunk_length = 0;
+
+static void append_text(FILE *output_stream, const char *text, int length);
+static void append_integer(FILE *output_stream, int value);
+static void append_fixed_point(FILE *output_stream, double value);
+static void reserve_chunk_space(FILE *output_stream);
+static void write_chunk(FILE *output_stream);
+static int format_unsigned(char *destination, uint64_t value);
+
 /**
  * Print the command received by CLI on the provided stream.
  * 
@@ -44,11 +62,15 @@ void print_heatmap(FILE *output_stream)
 	{
 		for(int i = 0; i < cli_args.global_line_number; i++){
 			for(int h = 0; h < cli_args.global_column_number; h++)
-				fprintf(output_stream, "%.2lf ", (double) heatmap_grid[i][h] / (double) cli_args.num_simulations);
+			{
+				append_fixed_point(output_stream, (double) heatmap_grid[i][h] / (double) cli_args.num_simulations);
+				append_text(output_stream, " ", 1);
+			}
 
-			fprintf(output_stream,"\n");
+			append_text(output_stream, "\n", 1);
+			write_chunk(output_stream);
 		}
-		fprintf(output_stream,"\n");
+		fputc('\n', output_stream);
 	}
 	else
 		fprintf(stderr, "No valid stream was provided at print_heatmap.\n");
@@ -74,17 +96,18 @@ void print_pedestrian_position_grid(FILE *output_stream, int simulation_number,
 			for(int h = 0; h < cli_args.global_column_number; h++)
 			{
 				if(pedestrian_position_grid[i][h] != 0)
-					fprintf(output_stream,"👤");
-				else if(exits_set.final_floor_field[i][h] == EXIT_VALUE)
-					fprintf(output_stream,"🚪");
-				else if(exits_set.final_floor_field[i][h] == WALL_VALUE)
-					fprintf(output_stream,"🧱");
+					append_text(output_stream, "👤", sizeof("👤") - 1);
+				else if(exits_set.cell_types[i][h] == CELL_EXIT)
+					append_text(output_stream, "🚪", sizeof("🚪") - 1);
+				else if(exits_set.cell_types[i][h] == CELL_WALL)
+					append_text(output_stream, "🧱", sizeof("🧱") - 1);
 				else if(pedestrian_position_grid[i][h] == 0)
-					fprintf(output_stream,"⬛");
+					append_text(output_stream, "⬛", sizeof("⬛") - 1);
 			}
-			fprintf(output_stream,"\n");
+			append_text(output_stream, "\n", 1);
+			write_chunk(output_stream);
 		}
-		fprintf(output_stream,"\n");
+		fputc('\n', output_stream);
 	}
 	else
 		fprintf(stderr, "No valid stream was provided at print_pedestrian_position_grid.\n");	
@@ -163,7 +186,8 @@ void print_simulation_set_information(FILE *output_stream)
 }
 
 /**
- * Print a status message about the execution of the program to stdout.
+ * Print a status message about the execution of the program to stdout, including the peak of grid memory and the number of
+ * allocator calls during the last simulation set.
  * 
  * @param set_index Current simulation set index.
  * @param set_quantity The number of simulations sets.
@@ -183,7 +207,8 @@ void print_execution_status(int set_index, int set_quantity)
 		fflush(stdout);
 	}
 	
-	fprintf(stdout, "Simulation set %5d/%d finalized at %s.\n", set_index + 1, set_quantity, date_time);
+	fprintf(stdout, "Simulation set %5d/%d finalized at %s (peak grid memory: %.1lf MB, allocator calls: %ld).\n", set_index + 1, 
+		set_quantity, date_time, get_peak_grid_memory() / (1024.0 * 1024.0), get_allocator_calls());
 }
 
 /**
@@ -196,7 +221,146 @@ void print_placeholder(FILE *stream, int placeholder)
 {
 	for(int times = 0; times < cli_args.num_simulations; times++)
 	{
-		fprintf(stream, "%d ", placeholder);
+		append_integer(stream, placeholder);
+		append_text(stream, " ", 1);
+	}
+	append_text(stream, "\n", 1);
+	write_chunk(stream);
+}
+
+/**
+ * Prints the number of timesteps of a simulation, followed by a space, to the provided stream (the same text as "%d ").
+ * 
+ * @param output_stream Stream where the data will be written.
+ * @param timesteps Number of timesteps required for the termination of the simulation.
+*/
+void print_timesteps(FILE *output_stream, int timesteps)
+{
+	char text[24];
+	int length = 0;
+
+	if(timesteps < 0)
+		text[length++] = '-';
+	length += format_unsigned(text + length, (uint64_t) (timesteps < 0 ? -(int64_t) timesteps : timesteps));
+	text[length++] = ' ';
+	fwrite(text, 1, length, output_stream);
+}
+
+/* ---------------- ---------------- ---------------- ---------------- ---------------- */
+/* ---------------- ---------------- STATIC FUNCTIONS ---------------- ---------------- */
+/* ---------------- ---------------- ---------------- ---------------- ---------------- */
+
+/**
+ * Appends text to the chunk of the output.
+ * 
+ * @param output_stream Stream where the chunk is written when it is full.
+ * @param text Text to be appended.
+ * @param length Number of bytes of the text, at most MAX_FORMATTED_VALUE.
+*/
+static void append_text(FILE *output_stream, const char *text, int length)
+{
+	reserve_chunk_space(output_stream);
+	memcpy(output_chunk + chunk_length, text, length);
+	chunk_length += length;
+}
+
+/**
+ * Appends an integer to the chunk of the output, with the same text as "%d".
+ * 
+ * @param output_stream Stream where the chunk is written when it is full.
+ * @param value Integer to be appended.
+*/
+static void append_integer(FILE *output_stream, int value)
+{
+	reserve_chunk_space(output_stream);
+	if(value < 0)
+		output_chunk[chunk_length++] = '-';
+	chunk_length += format_unsigned(output_chunk + chunk_length, (uint64_t) (value < 0 ? -(int64_t) value : value));
+}
+
+/**
+ * Appends a double to the chunk of the output, with the same text as "%.2lf".
+ * 
+ * @note The hundredths are rounded from the exact binary value of the double, with ties to even, as printf does. Values 
+ * that are negative, too large for 64-bit hundredths or not finite are formatted by snprintf.
+ * 
+ * @param output_stream Stream where the chunk is written when it is full.
+ * @param value Double to be appended.
+*/
+static void append_fixed_point(FILE *output_stream, double value)
+{
+	reserve_chunk_space(output_stream);
+	if(signbit(value) || !(value < 0x1.0p52))
+	{
+		chunk_length += snprintf(output_chunk + chunk_length, MAX_FORMATTED_VALUE, "%.2lf", value);
+		return;
+	}
+
+	// value = mantissa * 2^-shift, with a mantissa of 53 bits, so mantissa * 100 fits in 60 bits.
+	int exponent;
+	uint64_t mantissa = (uint64_t) ldexp(frexp(value, &exponent), 53);
+	int shift = 53 - exponent;
+	uint64_t hundredths = 0;
+	if(shift < 64)
+	{
+		uint64_t scaled = mantissa * 100;
+		uint64_t remainder = scaled & ((UINT64_C(1) << shift) - 1);
+		uint64_t half = UINT64_C(1) << (shift - 1);
+
+		hundredths = scaled >> shift;
+		if(remainder > half || (remainder == half && (hundredths & 1)))
+			hundredths++;
 	}
-	fprintf(stream, "\n");
+	// Otherwise, value * 100 < 2^-11 and the hundredths are zero.
+
+	chunk_length += format_unsigned(output_chunk + chunk_length, hundredths / 100);
+	output_chunk[chunk_length++] = '.';
+	output_chunk[chunk_length++] = '0' + hundredths % 100 / 10;
+	output_chunk[chunk_length++] = '0' + hundredths % 10;
+}
+
+/**
+ * Writes the chunk of the output to the stream if the next value might not fit in it.
+ * 
+ * @param output_stream Stream where the chunk will be written.
+*/
+static void reserve_chunk_space(FILE *output_stream)
+{
+	if(chunk_length > OUTPUT_CHUNK_SIZE - MAX_FORMATTED_VALUE)
+		write_chunk(output_stream);
+}
+
+/**
+ * Writes the chunk of the output to the stream and empties it.
+ * 
+ * @param output_stream Stream where the chunk will be written.
+*/
+static void write_chunk(FILE *output_stream)
+{
+	fwrite(output_chunk, 1, chunk_length, output_stream);
+	chunk_length = 0;
+}
+
+/**
+ * Writes the decimal digits of an unsigned integer, without a terminating null character.
+ * 
+ * @param destination Where the digits are written (at least 20 bytes).
+ * @param value Integer to be written.
+ * @return The number of digits written.
+*/
+static int format_unsigned(char *destination, uint64_t value)
+{
+	char digits[20];
+	int length = 0;
+
+	do
+	{
+		digits[length++] = '0' + value % 10;
+		value /= 10;
+	}while(value > 0);
+
+	for(int digit = 0; digit < length; digit++)
+		destination[digit] = digits[length - 1 - digit];
+
+	return length;
 }
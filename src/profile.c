@@ -0,0 +1,509 @@
+/*
+   File: profile.c
+   Author: Daniel Gonçalves
+   Date: 2026-10-18
+   Description: This module contains the timers of the phases of the program (floor field calculation, each phase of the timesteps and output printing), enabled by --profile, the hardware performance counters of --perf-counters, the work counters of --work-counters and the reports printed at the end of the run.
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<errno.h>
+#include<unistd.h>
+#include<sys/syscall.h>
+#include<linux/perf_event.h>
+
+#include"../headers/memory.h"
+#include"../headers/profile.h"
+#include"../headers/initialization.h"
+#include"../headers/cli_processing.h"
+#include"../headers/shared_resources.h"
+
+Profile profile;
+Work_Counters work_counters;
+
+static const char *phase_names[NUM_PROFILE_PHASES] = {
+    "floor field",
+    "pedestrian insertion",
+    "evaluate movements",
+    "panic",
+    "X movement",
+    "conflicts",
+    "apply movement",
+    "update position grid",
+    "resets",
+    "pedestrian ordering",
+    "output"
+};
+
+static const char *counter_names[NUM_PERF_COUNTERS] = {
+    "cycles",
+    "instructions",
+    "cache misses",
+    "branch misses"
+};
+
+static const uint64_t counter_configs[NUM_PERF_COUNTERS] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES
+};
+
+static const char *work_counter_names[NUM_WORK_COUNTERS] = {
+    "field passes",
+    "cells relaxed",
+    "neighbor candidates",
+    "conflicts",
+    "X movement checks",
+    "random draws",
+    "cells reset"
+};
+
+static Function_Status print_timing_report();
+static Function_Status print_work_counters_report();
+static FILE *open_report_file(const char *filename);
+static void print_counters_header(FILE *report_file, const char *first_column);
+static void print_counters(FILE *report_file, const uint64_t counters[NUM_PERF_COUNTERS]);
+static void print_work_counters(FILE *report_file, const Work_Counters *counters);
+static void release_profile();
+
+/**
+ * Clears the timers and marks the beginning of the run. With --perf-counters, also opens the counters of the calling thread.
+ * If none of them is available (as in most containers and virtual machines without a virtual PMU), the report says so and
+ * contains only the timers.
+ *
+ * @note Must be called before start_parallel_engine, whose workers open their own counters if the main thread could.
+*/
+void start_profile()
+{
+    memset(&profile, 0, sizeof(Profile));
+
+    if(cli_args.perf_counters)
+    {
+        profile.num_counter_threads = cli_args.num_threads > 0 ? cli_args.num_threads : 1;
+        for(int t = 0; t < profile.num_counter_threads; t++)
+            profile.counter_groups[t].leader_fd = -1;
+
+        open_perf_counters(0);
+
+        Perf_Group *main_group = &profile.counter_groups[0];
+        for(int e = 0; e < main_group->num_events; e++)
+            profile.counter_available[main_group->events[e]] = true;
+
+        profile.counters_enabled = main_group->leader_fd != -1;
+    }
+
+    profile.run_start = read_profile_clock();
+}
+
+/**
+ * Opens the hardware counters of the calling thread as a group, skipping the counters that the processor (or the kernel)
+ * doesn't provide. Only user space events are counted, which is allowed with perf_event_paranoid up to 2.
+ *
+ * @param thread_index Index of the calling thread in the parallel engine (0 for the main thread).
+*/
+void open_perf_counters(int thread_index)
+{
+    Perf_Group *group = &profile.counter_groups[thread_index];
+    group->leader_fd = -1;
+    group->num_events = 0;
+
+    for(int counter = 0; counter < NUM_PERF_COUNTERS; counter++)
+    {
+        struct perf_event_attr attributes;
+        memset(&attributes, 0, sizeof(attributes));
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.size = sizeof(attributes);
+        attributes.config = counter_configs[counter];
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        // pid 0 and cpu -1: the calling thread, on any CPU.
+        int fd = (int) syscall(SYS_perf_event_open, &attributes, 0, -1, group->leader_fd, 0);
+        if(fd == -1)
+        {
+            if(profile.counter_error == 0)
+                profile.counter_error = errno;
+            continue;
+        }
+
+        if(group->leader_fd == -1)
+            group->leader_fd = fd;
+
+        group->fds[group->num_events] = fd;
+        group->events[group->num_events] = counter;
+        group->num_events++;
+    }
+}
+
+/**
+ * Reads the counters of all threads, summing them.
+ *
+ * @note When the kernel multiplexes the counters (more events than hardware counters), the values are scaled by the fraction
+ * of the time they were counting.
+ *
+ * @param values Where the sum of each counter will be stored (0 for unavailable counters).
+*/
+void read_perf_counters(uint64_t values[NUM_PERF_COUNTERS])
+{
+    memset(values, 0, sizeof(uint64_t) * NUM_PERF_COUNTERS);
+
+    for(int t = 0; t < profile.num_counter_threads; t++)
+    {
+        Perf_Group *group = &profile.counter_groups[t];
+        if(group->leader_fd == -1)
+            continue;
+
+        struct{
+            uint64_t num_events;
+            uint64_t time_enabled;
+            uint64_t time_running;
+            uint64_t values[NUM_PERF_COUNTERS];
+        }group_values;
+
+        if(read(group->leader_fd, &group_values, sizeof(group_values)) <= 0)
+            continue;
+
+        for(int e = 0; e < (int) group_values.num_events && e < group->num_events; e++)
+        {
+            uint64_t value = group_values.values[e];
+            if(group_values.time_running > 0 && group_values.time_running < group_values.time_enabled)
+                value = (uint64_t) ((double) value * group_values.time_enabled / group_values.time_running);
+
+            values[group->events[e]] += value;
+        }
+    }
+}
+
+/**
+ * Adds the given partial work counters to the total and clears them.
+ *
+ * @param total Counters where the work will be added.
+ * @param partial Counters of part of the work (as the counters of a stripe of the parallel engine).
+*/
+void add_work_counters(Work_Counters *total, Work_Counters *partial)
+{
+    for(int counter = 0; counter < NUM_WORK_COUNTERS; counter++)
+        total->counts[counter] += partial->counts[counter];
+
+    memset(partial, 0, sizeof(Work_Counters));
+}
+
+/**
+ * Marks the beginning of a simulation set (before its floor field is calculated). Only used with --perf-counters and
+ * --work-counters.
+*/
+void begin_profile_set()
+{
+    if(!cli_args.perf_counters && !cli_args.work_counters)
+        return;
+
+    profile.set_work_start = work_counters;
+    if(profile.counters_enabled)
+        read_perf_counters(profile.set_counter_start);
+    profile.set_start = read_profile_clock();
+}
+
+/**
+ * Stores the time and the counters of the simulation set that has just been finalized.
+ *
+ * @note The profile of a simulation set is silently discarded if there isn't memory to store it.
+*/
+void end_profile_set()
+{
+    if(!cli_args.perf_counters && !cli_args.work_counters)
+        return;
+
+    uint64_t nanoseconds = read_profile_clock() - profile.set_start;
+
+    if(profile.num_sets == profile.sets_capacity)
+    {
+        int new_capacity = profile.sets_capacity == 0 ? 16 : 2 * profile.sets_capacity;
+        Set_Profile *new_sets = tracked_realloc(MEMORY_OUTPUT, profile.sets, sizeof(Set_Profile) * new_capacity);
+        if(new_sets == NULL)
+            return;
+
+        profile.sets = new_sets;
+        profile.sets_capacity = new_capacity;
+    }
+
+    Set_Profile *set = &profile.sets[profile.num_sets];
+    memset(set, 0, sizeof(Set_Profile));
+    set->nanoseconds = nanoseconds;
+    if(profile.counters_enabled)
+        accumulate_perf_counters(set->counters, profile.set_counter_start);
+
+    for(int counter = 0; counter < NUM_WORK_COUNTERS; counter++)
+        set->work.counts[counter] = work_counters.counts[counter] - profile.set_work_start.counts[counter];
+
+    profile.num_sets++;
+}
+
+/**
+ * Prints the reports of --profile and --work-counters and releases the counters.
+ *
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+*/
+Function_Status print_profile_report()
+{
+    Function_Status status = SUCCESS;
+
+    if(cli_args.profile && print_timing_report() == FAILURE)
+        status = FAILURE;
+
+    if(cli_args.work_counters && print_work_counters_report() == FAILURE)
+        status = FAILURE;
+
+    release_profile();
+
+    return status;
+}
+
+/**
+ * Prints the work counters accumulated so far and, with --profile, the time of each phase, as one "name: value" per line.
+ * Used by the status file of SIGUSR1.
+ *
+ * @param status_file Stream where the counters will be written.
+ * @param pending_work Work counters not yet added to work_counters, or NULL.
+*/
+void print_profile_status(FILE *status_file, const Work_Counters *pending_work)
+{
+    fprintf(status_file, "work counters:\n");
+    for(int counter = 0; counter < NUM_WORK_COUNTERS; counter++)
+    {
+        long count = work_counters.counts[counter] + (pending_work != NULL ? pending_work->counts[counter] : 0);
+        fprintf(status_file, "  %s: %ld\n", work_counter_names[counter], count);
+    }
+
+    if(!cli_args.profile)
+        return;
+
+    fprintf(status_file, "profile: %ld timesteps, %ld pedestrian-steps\n", profile.timesteps, profile.pedestrian_steps);
+    for(int phase = 0; phase < NUM_PROFILE_PHASES; phase++)
+    {
+        if(profile.calls[phase] > 0)
+            fprintf(status_file, "  %s: %.3lf s (%ld calls)\n", phase_names[phase], profile.nanoseconds[phase] / 1e9, profile.calls[phase]);
+    }
+}
+
+/* ---------------- ---------------- ---------------- ---------------- ---------------- */
+/* ---------------- ---------------- STATIC FUNCTIONS ---------------- ---------------- */
+/* ---------------- ---------------- ---------------- ---------------- ---------------- */
+
+/**
+ * Prints the time of each phase (total, per timestep and per pedestrian-step) to the file given with --profile, which is
+ * created in the output directory, or to stderr. With --perf-counters, also prints the counters of each phase and the time
+ * and the counters of each simulation set.
+ *
+ * @note In the parallel engine, the panic draws are made while the movements are evaluated, and each phase includes the time
+ * spent waiting for the slowest stripe. The counters of a phase are summed over all threads.
+ *
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+*/
+static Function_Status print_timing_report()
+{
+    uint64_t run_time = read_profile_clock() - profile.run_start;
+    FILE *report_file = open_report_file(cli_args.profile_filename);
+    if(report_file == NULL)
+    {
+        fprintf(stderr, "It was not possible to open the profile file.\n");
+        return FAILURE;
+    }
+
+    uint64_t phases_time = 0;
+    for(int phase = 0; phase < NUM_PROFILE_PHASES; phase++)
+        phases_time += profile.nanoseconds[phase];
+
+    fprintf(report_file, "Profile: %.3lf s, %ld timesteps, %ld pedestrian-steps.\n", run_time / 1e9, profile.timesteps, profile.pedestrian_steps);
+    fprintf(report_file, "%-22s %12s %7s %10s %14s %16s\n", "phase", "total (s)", "share", "calls", "ns/timestep", "ns/ped-step");
+
+    for(int phase = 0; phase < NUM_PROFILE_PHASES; phase++)
+    {
+        if(profile.calls[phase] == 0)
+            continue;
+
+        double nanoseconds = (double) profile.nanoseconds[phase];
+        fprintf(report_file, "%-22s %12.3lf %6.1lf%% %10ld %14.1lf %16.2lf\n", phase_names[phase], nanoseconds / 1e9,
+                100.0 * nanoseconds / run_time, profile.calls[phase],
+                profile.timesteps > 0 ? nanoseconds / profile.timesteps : 0.0,
+                profile.pedestrian_steps > 0 ? nanoseconds / profile.pedestrian_steps : 0.0);
+    }
+
+    fprintf(report_file, "%-22s %12.3lf %6.1lf%%\n", "other", (run_time - phases_time) / 1e9, 100.0 * (run_time - phases_time) / run_time);
+
+    // Share of the time of the timesteps each thread spent waiting for the other threads.
+    if(cli_args.num_threads > 0 && profile.parallel_nanoseconds > 0)
+    {
+        fprintf(report_file, "\n%-22s %12s %7s\n", "thread", "idle (s)", "idle");
+        for(int t = 0; t < cli_args.num_threads; t++)
+            fprintf(report_file, "%-22d %12.3lf %6.1lf%%\n", t, profile.thread_idle_nanoseconds[t] / 1e9,
+                    100.0 * profile.thread_idle_nanoseconds[t] / profile.parallel_nanoseconds);
+    }
+
+    if(cli_args.perf_counters)
+    {
+        if(profile.counters_enabled)
+        {
+            fprintf(report_file, "\nPerformance counters (user space, all threads):\n");
+            print_counters_header(report_file, "phase");
+            for(int phase = 0; phase < NUM_PROFILE_PHASES; phase++)
+            {
+                if(profile.calls[phase] == 0)
+                    continue;
+
+                fprintf(report_file, "%-22s", phase_names[phase]);
+                print_counters(report_file, profile.counters[phase]);
+            }
+        }
+        else
+            fprintf(report_file, "\nPerformance counters: unavailable (%s).\n", strerror(profile.counter_error));
+
+        fprintf(report_file, "\n%-22s %12s", "simulation set", "time (s)");
+        print_counters_header(report_file, NULL);
+        for(int set = 0; set < profile.num_sets; set++)
+        {
+            fprintf(report_file, "%-22d %12.3lf", set + 1, profile.sets[set].nanoseconds / 1e9);
+            print_counters(report_file, profile.sets[set].counters);
+        }
+    }
+
+    if(report_file != stderr)
+        fclose(report_file);
+
+    return SUCCESS;
+}
+
+/**
+ * Prints the work counters of each simulation set and of the whole run to the file given with --work-counters, which is
+ * created in the output directory, or to stderr. The report contains only the counters, so the reports of two runs can
+ * be compared with diff.
+ *
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+*/
+static Function_Status print_work_counters_report()
+{
+    FILE *report_file = open_report_file(cli_args.work_counters_filename);
+    if(report_file == NULL)
+    {
+        fprintf(stderr, "It was not possible to open the work counters file.\n");
+        return FAILURE;
+    }
+
+    fprintf(report_file, "%-14s", "simulation set");
+    for(int counter = 0; counter < NUM_WORK_COUNTERS; counter++)
+        fprintf(report_file, " %19s", work_counter_names[counter]);
+    fprintf(report_file, "\n");
+
+    for(int set = 0; set < profile.num_sets; set++)
+    {
+        fprintf(report_file, "%-14d", set + 1);
+        print_work_counters(report_file, &profile.sets[set].work);
+    }
+
+    fprintf(report_file, "%-14s", "total");
+    print_work_counters(report_file, &work_counters);
+
+    if(report_file != stderr)
+        fclose(report_file);
+
+    return SUCCESS;
+}
+
+/**
+ * Opens a report file in the output directory.
+ *
+ * @param filename Name of the file, or an empty string for stderr.
+ * @return The opened stream (stderr if no name was given), or NULL on failure.
+*/
+static FILE *open_report_file(const char *filename)
+{
+    if(strcmp(filename, "") == 0)
+        return stderr;
+
+    char complete_path[300];
+    sprintf(complete_path, "%s%s", output_path, filename);
+
+    return fopen(complete_path, "w");
+}
+
+/**
+ * Prints the names of the counter columns, preceded by the name of the first column, if given.
+ *
+ * @param report_file Stream where the report is being written.
+ * @param first_column Name of the first column, or NULL if it was already printed.
+*/
+static void print_counters_header(FILE *report_file, const char *first_column)
+{
+    if(first_column != NULL)
+        fprintf(report_file, "%-22s", first_column);
+
+    for(int counter = 0; counter < NUM_PERF_COUNTERS; counter++)
+    {
+        fprintf(report_file, " %16s", counter_names[counter]);
+        if(counter == COUNTER_INSTRUCTIONS)
+            fprintf(report_file, " %6s", "IPC");
+    }
+    fprintf(report_file, "\n");
+}
+
+/**
+ * Prints the counter columns of a phase or simulation set, with n/a for the counters that couldn't be opened.
+ *
+ * @param report_file Stream where the report is being written.
+ * @param counters Counters of the phase or simulation set.
+*/
+static void print_counters(FILE *report_file, const uint64_t counters[NUM_PERF_COUNTERS])
+{
+    for(int counter = 0; counter < NUM_PERF_COUNTERS; counter++)
+    {
+        if(profile.counter_available[counter])
+            fprintf(report_file, " %16llu", (unsigned long long) counters[counter]);
+        else
+            fprintf(report_file, " %16s", "n/a");
+
+        if(counter == COUNTER_INSTRUCTIONS)
+        {
+            if(profile.counter_available[COUNTER_CYCLES] && profile.counter_available[COUNTER_INSTRUCTIONS] && counters[COUNTER_CYCLES] > 0)
+                fprintf(report_file, " %6.2lf", (double) counters[COUNTER_INSTRUCTIONS] / counters[COUNTER_CYCLES]);
+            else
+                fprintf(report_file, " %6s", "n/a");
+        }
+    }
+    fprintf(report_file, "\n");
+}
+
+/**
+ * Prints the columns of the work counters of a simulation set or of the whole run.
+ *
+ * @param report_file Stream where the report is being written.
+ * @param counters Work counters to be printed.
+*/
+static void print_work_counters(FILE *report_file, const Work_Counters *counters)
+{
+    for(int counter = 0; counter < NUM_WORK_COUNTERS; counter++)
+        fprintf(report_file, " %19ld", counters->counts[counter]);
+    fprintf(report_file, "\n");
+}
+
+/**
+ * Closes the counters of all threads and deallocates the profiles of the simulation sets.
+*/
+static void release_profile()
+{
+    for(int t = 0; t < profile.num_counter_threads; t++)
+    {
+        Perf_Group *group = &profile.counter_groups[t];
+        for(int e = 0; e < group->num_events; e++)
+            close(group->fds[e]);
+
+        group->leader_fd = -1;
+        group->num_events = 0;
+    }
+
+    profile.counters_enabled = false;
+    tracked_free(profile.sets);
+    profile.sets = NULL;
+    profile.num_sets = 0;
+}
@@ -0,0 +1,269 @@
+/*
+   File: statistics.c
+   Author: Daniel Gonçalves
+   Date: 2026-10-18
+   Description: This module keeps online statistics of the timesteps of the simulations of each simulation set, for the statistics output (--output-format 5): number of simulations, mean and standard deviation (Welford's algorithm), minimum, maximum and quantiles, which are exact for the first EXACT_QUANTILE_SAMPLES simulations and estimated with the P² algorithm afterwards. The memory used doesn't depend on the number of simulations, and a single line is printed per simulation set.
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<math.h>
+
+#include"../headers/statistics.h"
+
+static const double quantile_probabilities[NUM_QUANTILES] = {0.5, 0.9, 0.99};
+
+static Set_Statistics set_statistics;
+
+static void start_p2_estimator(P2_Estimator *estimator, double probability, const double *sorted_samples, int num_samples);
+static void add_p2_sample(P2_Estimator *estimator, double sample);
+static double exact_quantile(const double *sorted_samples, int num_samples, double probability);
+static double adjusted_height(const P2_Estimator *estimator, int marker, int direction);
+static int compare_doubles(const void *first, const void *second);
+
+/**
+ * Clears the statistics, at the beginning of a simulation set.
+*/
+void begin_set_statistics()
+{
+    set_statistics.count = 0;
+    set_statistics.mean = 0;
+    set_statistics.squared_differences = 0;
+    set_statistics.minimum = 0;
+    set_statistics.maximum = 0;
+}
+
+/**
+ * Updates the statistics of the simulation set with the number of timesteps of a simulation.
+ *
+ * @param timesteps Number of timesteps required for the termination of the simulation.
+*/
+void add_statistics_sample(int timesteps)
+{
+    set_statistics.count++;
+
+    double difference = timesteps - set_statistics.mean;
+    set_statistics.mean += difference / set_statistics.count;
+    set_statistics.squared_differences += difference * (timesteps - set_statistics.mean);
+
+    if(set_statistics.count == 1 || timesteps < set_statistics.minimum)
+        set_statistics.minimum = timesteps;
+    if(set_statistics.count == 1 || timesteps > set_statistics.maximum)
+        set_statistics.maximum = timesteps;
+
+    if(set_statistics.count <= EXACT_QUANTILE_SAMPLES)
+    {
+        set_statistics.first_samples[set_statistics.count - 1] = timesteps;
+        if(set_statistics.count == EXACT_QUANTILE_SAMPLES)
+        {
+            double sorted_samples[EXACT_QUANTILE_SAMPLES];
+            memcpy(sorted_samples, set_statistics.first_samples, sizeof(sorted_samples));
+            qsort(sorted_samples, EXACT_QUANTILE_SAMPLES, sizeof(double), compare_doubles);
+
+            for(int quantile = 0; quantile < NUM_QUANTILES; quantile++)
+                start_p2_estimator(&set_statistics.quantiles[quantile], quantile_probabilities[quantile], sorted_samples, EXACT_QUANTILE_SAMPLES);
+        }
+        return;
+    }
+
+    for(int quantile = 0; quantile < NUM_QUANTILES; quantile++)
+        add_p2_sample(&set_statistics.quantiles[quantile], timesteps);
+}
+
+/**
+ * Prints the names of the columns of the statistics output on the provided stream.
+ *
+ * @param output_stream Stream where the data will be written.
+*/
+void print_statistics_header(FILE *output_stream)
+{
+    fprintf(output_stream, "simulations mean standard_deviation minimum maximum");
+    for(int quantile = 0; quantile < NUM_QUANTILES; quantile++)
+        fprintf(output_stream, " p%g", 100 * quantile_probabilities[quantile]);
+    fprintf(output_stream, "\n");
+}
+
+/**
+ * Prints the statistics of the simulation set, in a single line, on the provided stream.
+ *
+ * @note The standard deviation is the sample standard deviation (0 for a single simulation). The quantiles are interpolated
+ * linearly between the sorted timesteps up to EXACT_QUANTILE_SAMPLES simulations, and estimated with P² beyond that.
+ *
+ * @param output_stream Stream where the data will be written.
+*/
+void print_set_statistics(FILE *output_stream)
+{
+    double variance = set_statistics.count > 1 ? set_statistics.squared_differences / (set_statistics.count - 1) : 0;
+    double sorted_samples[EXACT_QUANTILE_SAMPLES];
+    int num_samples = set_statistics.count < EXACT_QUANTILE_SAMPLES ? set_statistics.count : EXACT_QUANTILE_SAMPLES;
+
+    memcpy(sorted_samples, set_statistics.first_samples, sizeof(double) * num_samples);
+    qsort(sorted_samples, num_samples, sizeof(double), compare_doubles);
+
+    fprintf(output_stream, "%ld %.4lf %.4lf %d %d", set_statistics.count, set_statistics.mean, sqrt(variance), set_statistics.minimum,
+            set_statistics.maximum);
+    for(int quantile = 0; quantile < NUM_QUANTILES; quantile++)
+    {
+        if(set_statistics.count > EXACT_QUANTILE_SAMPLES)
+            fprintf(output_stream, " %.2lf", set_statistics.quantiles[quantile].heights[2]);
+        else
+            fprintf(output_stream, " %.2lf", exact_quantile(sorted_samples, num_samples, quantile_probabilities[quantile]));
+    }
+    fprintf(output_stream, "\n");
+}
+
+/**
+ * Prints the line of a simulation set whose simulations weren't run, as no simulations followed by -1 in every column.
+ *
+ * @param output_stream Stream where the data will be written.
+*/
+void print_inaccessible_set_statistics(FILE *output_stream)
+{
+    fprintf(output_stream, "0");
+    for(int column = 0; column < 4 + NUM_QUANTILES; column++)
+        fprintf(output_stream, " -1");
+    fprintf(output_stream, "\n");
+}
+
+/* ---------------- ---------------- ---------------- ---------------- ---------------- */
+/* ---------------- ---------------- STATIC FUNCTIONS ---------------- ---------------- */
+/* ---------------- ---------------- ---------------- ---------------- ---------------- */
+
+/**
+ * Prepares a P² estimator from the first samples of a sequence, placing each marker at the sample closest to its desired position.
+ *
+ * @param estimator The estimator.
+ * @param probability Probability of the estimated quantile, between 0 and 1.
+ * @param sorted_samples The first samples, in increasing order.
+ * @param num_samples Number of samples, at least P2_MARKERS.
+*/
+static void start_p2_estimator(P2_Estimator *estimator, double probability, const double *sorted_samples, int num_samples)
+{
+    double marker_probabilities[P2_MARKERS] = {0, probability / 2, probability, (1 + probability) / 2, 1};
+
+    estimator->probability = probability;
+
+    for(int marker = 0; marker < P2_MARKERS; marker++)
+    {
+        estimator->increments[marker] = marker_probabilities[marker];
+        estimator->desired_positions[marker] = 1 + (num_samples - 1) * marker_probabilities[marker];
+
+        // Positions are kept strictly increasing, leaving room for the markers to the right.
+        double position = round(estimator->desired_positions[marker]);
+        if(position > num_samples - (P2_MARKERS - 1 - marker))
+            position = num_samples - (P2_MARKERS - 1 - marker);
+        if(marker > 0 && position <= estimator->positions[marker - 1])
+            position = estimator->positions[marker - 1] + 1;
+
+        estimator->positions[marker] = position;
+        estimator->heights[marker] = sorted_samples[(int) position - 1];
+    }
+}
+
+/**
+ * Adds a sample to a P² estimator, already started with start_p2_estimator.
+ *
+ * @param estimator The estimator.
+ * @param sample The sample.
+*/
+static void add_p2_sample(P2_Estimator *estimator, double sample)
+{
+    double *heights = estimator->heights;
+    double *positions = estimator->positions;
+
+    // Marker cell that holds the sample, moving the extreme markers if it is a new minimum or maximum.
+    int cell;
+    if(sample < heights[0])
+    {
+        heights[0] = sample;
+        cell = 0;
+    }
+    else if(sample >= heights[P2_MARKERS - 1])
+    {
+        heights[P2_MARKERS - 1] = sample;
+        cell = P2_MARKERS - 2;
+    }
+    else
+    {
+        cell = 0;
+        while(sample >= heights[cell + 1])
+            cell++;
+    }
+
+    for(int marker = cell + 1; marker < P2_MARKERS; marker++)
+        positions[marker]++;
+    for(int marker = 0; marker < P2_MARKERS; marker++)
+        estimator->desired_positions[marker] += estimator->increments[marker];
+
+    // The middle markers that are a position or more away from their desired positions are moved by one.
+    for(int marker = 1; marker < P2_MARKERS - 1; marker++)
+    {
+        double offset = estimator->desired_positions[marker] - positions[marker];
+        if((offset >= 1 && positions[marker + 1] - positions[marker] > 1) || (offset <= -1 && positions[marker - 1] - positions[marker] < -1))
+        {
+            int direction = offset > 0 ? 1 : -1;
+            double height = adjusted_height(estimator, marker, direction);
+
+            if(heights[marker - 1] < height && height < heights[marker + 1])
+                heights[marker] = height;
+            else // Linear formula, when the parabolic one breaks the order of the markers.
+                heights[marker] += direction * (heights[marker + direction] - heights[marker]) / (positions[marker + direction] - positions[marker]);
+
+            positions[marker] += direction;
+        }
+    }
+}
+
+/**
+ * Returns the quantile of a set of samples, interpolated linearly between the samples around the position probability * (n - 1).
+ *
+ * @param sorted_samples The samples, in increasing order.
+ * @param num_samples Number of samples.
+ * @param probability Probability of the quantile, between 0 and 1.
+ * @return The quantile, or 0 without samples.
+*/
+static double exact_quantile(const double *sorted_samples, int num_samples, double probability)
+{
+    if(num_samples == 0)
+        return 0;
+
+    double position = probability * (num_samples - 1);
+    int lower = (int) position;
+    if(lower >= num_samples - 1)
+        return sorted_samples[num_samples - 1];
+
+    return sorted_samples[lower] + (position - lower) * (sorted_samples[lower + 1] - sorted_samples[lower]);
+}
+
+/**
+ * Calculates the new height of a middle marker with the piecewise-parabolic (P²) formula.
+ *
+ * @param estimator The estimator.
+ * @param marker Index of the marker (1 to P2_MARKERS - 2).
+ * @param direction 1 or -1, the position change of the marker.
+ * @return The new height of the marker.
+*/
+static double adjusted_height(const P2_Estimator *estimator, int marker, int direction)
+{
+    const double *heights = estimator->heights;
+    const double *positions = estimator->positions;
+
+    return heights[marker] + direction / (positions[marker + 1] - positions[marker - 1]) *
+           ((positions[marker] - positions[marker - 1] + direction) * (heights[marker + 1] - heights[marker]) / (positions[marker + 1] - positions[marker]) +
+            (positions[marker + 1] - positions[marker] - direction) * (heights[marker] - heights[marker - 1]) / (positions[marker] - positions[marker - 1]));
+}
+
+/**
+ * Compares two doubles, for qsort.
+ *
+ * @param first Pointer to the first double.
+ * @param second Pointer to the second double.
+ * @return A negative value, zero or a positive value, if the first double is smaller than, equal to or greater than the second.
+*/
+static int compare_doubles(const void *first, const void *second)
+{
+    double first_value = *(const double *) first, second_value = *(const double *) second;
+
+    return (first_value > second_value) - (first_value < second_value);
+}
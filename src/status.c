@@ -0,0 +1,114 @@
+/*
+   File: status.c
+   Author: Daniel Gonçalves
+   Date: 2026-10-18
+   Description: This module writes a status file when the process receives SIGUSR1: the simulation set, simulation and timestep being run, the pedestrians remaining, the work counters and, with --profile, the time of each phase. The signal handler only sets a flag; the file is written by the main thread at the next timestep (or floor field pass), so the output and the random draws of the run are not affected.
+*/
+
+#include<stdio.h>
+#include<string.h>
+#include<signal.h>
+#include<unistd.h>
+
+#include"../headers/status.h"
+#include"../headers/profile.h"
+#include"../headers/initialization.h"
+#include"../headers/cli_processing.h"
+#include"../headers/shared_resources.h"
+
+Run_Status run_status;
+volatile sig_atomic_t status_requested = 0;
+
+static void handle_status_signal(int signal_number);
+
+/**
+ * Installs the SIGUSR1 handler, so the status of a detached run can be inspected with kill -USR1 PID.
+ *
+ * @note SA_RESTART keeps the reads and writes of the program from being interrupted by the signal.
+ *
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+*/
+Function_Status install_status_handler()
+{
+    memset(&run_status, 0, sizeof(Run_Status));
+    run_status.activity = "floor field";
+    run_status.set_quantity = 1;
+    run_status.num_replicas = 1;
+    run_status.start = read_profile_clock();
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(struct sigaction));
+    action.sa_handler = handle_status_signal;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+
+    if(sigaction(SIGUSR1, &action, NULL) == -1)
+    {
+        fprintf(stderr, "It was not possible to install the SIGUSR1 handler.\n");
+        return FAILURE;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * Writes the status file (given with --status-file, in the output directory). The file is written under a temporary name
+ * and then renamed, so a reader never sees a partial status.
+ *
+ * @param timestep Timesteps already run in the current simulation, or -1 outside the simulations.
+ * @param pedestrians_remaining Pedestrians still in the environment (summed over the replicas with --batch), or -1.
+ * @param pending_work Work counters not yet added to work_counters (as the ones of the stripes of the parallel engine), or NULL.
+*/
+void write_status_file(int timestep, long pedestrians_remaining, const Work_Counters *pending_work)
+{
+    status_requested = 0; // Cleared first, so a signal received while writing asks for a new status file.
+
+    char complete_path[300];
+    char temporary_path[310];
+    sprintf(complete_path, "%s%s", output_path, cli_args.status_filename);
+    sprintf(temporary_path, "%s.tmp", complete_path);
+
+    FILE *status_file = fopen(temporary_path, "w");
+    if(status_file == NULL)
+    {
+        fprintf(stderr, "It was not possible to open the status file.\n");
+        return;
+    }
+
+    fprintf(status_file, "pid: %d\n", (int) getpid());
+    fprintf(status_file, "elapsed: %.3lf s\n", (read_profile_clock() - run_status.start) / 1e9);
+    fprintf(status_file, "activity: %s\n", run_status.activity);
+    fprintf(status_file, "simulation set: %d/%d\n", run_status.set_index + 1, run_status.set_quantity);
+
+    if(timestep >= 0)
+    {
+        if(run_status.num_replicas > 1)
+            fprintf(status_file, "simulations: %d-%d/%d (seeds %d-%d)\n", run_status.simulation + 1, run_status.simulation + run_status.num_replicas,
+                    cli_args.num_simulations, run_status.seed, run_status.seed + run_status.num_replicas - 1);
+        else
+            fprintf(status_file, "simulation: %d/%d (seed %d)\n", run_status.simulation + 1, cli_args.num_simulations, run_status.seed);
+        fprintf(status_file, "timestep: %d\n", timestep);
+        fprintf(status_file, "pedestrians remaining: %ld\n", pedestrians_remaining);
+    }
+
+    print_profile_status(status_file, pending_work);
+
+    fclose(status_file);
+    if(rename(temporary_path, complete_path) == -1)
+        fprintf(stderr, "It was not possible to write the status file.\n");
+}
+
+/* ---------------- ---------------- ---------------- ---------------- ---------------- */
+/* ---------------- ---------------- STATIC FUNCTIONS ---------------- ---------------- */
+/* ---------------- ---------------- ---------------- ---------------- ---------------- */
+
+/**
+ * Asks for a status file. Only sets a flag of type sig_atomic_t, which is async-signal-safe.
+ *
+ * @param signal_number Number of the received signal (SIGUSR1).
+*/
+static void handle_status_signal(int signal_number)
+{
+    (void) signal_number;
+    status_requested = 1;
+}
@@ -0,0 +1,181 @@
+/*
+   File: telemetry.c
+   Author: Daniel Gonçalves
+   Date: 2026-10-18
+   Description: This module reports the progress of the run, enabled by --telemetry: simulation sets, replicas and pedestrian-steps per second, an estimate of the remaining time and the peak resident memory. The report is refreshed every --telemetry-interval seconds, in place on a terminal or as one line per refresh otherwise.
+*/
+
+#include<stdio.h>
+#include<string.h>
+#include<unistd.h>
+#include<sys/resource.h>
+
+#include"../headers/profile.h"
+#include"../headers/telemetry.h"
+#include"../headers/initialization.h"
+#include"../headers/cli_processing.h"
+#include"../headers/shared_resources.h"
+
+Telemetry telemetry;
+
+static void print_telemetry_line(uint64_t now, bool is_final);
+static double get_run_progress();
+static void format_duration(char *buffer, double seconds);
+
+/**
+ * Opens the telemetry stream (the file given with --telemetry, in the output directory, or stderr) and starts the clock.
+ *
+ * @param set_quantity Number of simulation sets of the run.
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+*/
+Function_Status start_telemetry(int set_quantity)
+{
+    if(!cli_args.telemetry)
+        return SUCCESS;
+
+    memset(&telemetry, 0, sizeof(Telemetry));
+
+    if(strcmp(cli_args.telemetry_filename, "") != 0)
+    {
+        char complete_path[300];
+        sprintf(complete_path, "%s%s", output_path, cli_args.telemetry_filename);
+
+        telemetry.stream = fopen(complete_path, "w");
+        if(telemetry.stream == NULL)
+        {
+            fprintf(stderr, "It was not possible to open the telemetry file.\n");
+            return FAILURE;
+        }
+    }
+    else
+    {
+        telemetry.stream = stderr;
+        telemetry.is_terminal = isatty(fileno(stderr));
+    }
+
+    telemetry.set_quantity = set_quantity;
+    telemetry.start = telemetry.last_report = read_profile_clock();
+    telemetry.next_report = telemetry.start + (uint64_t) (cli_args.telemetry_interval * 1e9);
+
+    return SUCCESS;
+}
+
+/**
+ * Refreshes the report if --telemetry-interval seconds have passed since the last refresh. Called by the engines at every
+ * timestep (and by the iterative solver at every pass), so it only reads the clock in most calls.
+*/
+void update_telemetry()
+{
+    uint64_t now = read_profile_clock();
+    if(now < telemetry.next_report || telemetry.stream == NULL)
+        return;
+
+    print_telemetry_line(now, false);
+    telemetry.next_report = now + (uint64_t) (cli_args.telemetry_interval * 1e9);
+}
+
+/**
+ * Prints the final report, with the rates averaged over the whole run, and closes the telemetry stream.
+*/
+void finish_telemetry()
+{
+    if(!cli_args.telemetry || telemetry.stream == NULL)
+        return;
+
+    print_telemetry_line(read_profile_clock(), true);
+    if(telemetry.is_terminal)
+        fprintf(telemetry.stream, "\n");
+
+    if(telemetry.stream != stderr)
+        fclose(telemetry.stream);
+    telemetry.stream = NULL;
+}
+
+/* ---------------- ---------------- ---------------- ---------------- ---------------- */
+/* ---------------- ---------------- STATIC FUNCTIONS ---------------- ---------------- */
+/* ---------------- ---------------- ---------------- ---------------- ---------------- */
+
+/**
+ * Prints a line of the report. The rates are measured since the last refresh, or over the whole run in the final line.
+ * The estimate of the remaining time uses a moving average of the progress rate.
+ *
+ * @param now Current clock reading.
+ * @param is_final Indicates if this is the last line of the run.
+*/
+static void print_telemetry_line(uint64_t now, bool is_final)
+{
+    double elapsed = (now - telemetry.start) / 1e9;
+    double interval = is_final ? elapsed : (now - telemetry.last_report) / 1e9;
+    if(interval <= 0)
+        interval = 1e-9;
+
+    double progress = get_run_progress();
+    double progress_rate = (progress - telemetry.last_progress) / interval;
+    telemetry.progress_rate = telemetry.last_report == telemetry.start ? progress_rate :
+                              TELEMETRY_RATE_SMOOTHING * progress_rate + (1 - TELEMETRY_RATE_SMOOTHING) * telemetry.progress_rate;
+
+    char remaining_time[32] = "--";
+    if(is_final)
+        format_duration(remaining_time, 0);
+    else if(telemetry.progress_rate > 0)
+        format_duration(remaining_time, (1 - progress) / telemetry.progress_rate);
+
+    char elapsed_time[32];
+    format_duration(elapsed_time, elapsed);
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage); // ru_maxrss is given in kilobytes on Linux.
+
+    long sets = is_final ? telemetry.sets : telemetry.sets - telemetry.last_sets;
+    long replicas = is_final ? telemetry.replicas : telemetry.replicas - telemetry.last_replicas;
+    long pedestrian_steps = is_final ? telemetry.pedestrian_steps : telemetry.pedestrian_steps - telemetry.last_pedestrian_steps;
+
+    fprintf(telemetry.stream, "%s%s | sets %ld/%d (%.2lf/s) | replicas %ld (%.2lf/s) | pedestrian-steps %ld (%.3e/s) | ETA %s | peak RSS %.1lf MB%s",
+            telemetry.is_terminal ? "\r\033[2K" : "", elapsed_time, telemetry.sets, telemetry.set_quantity, sets / interval,
+            telemetry.replicas, replicas / interval, telemetry.pedestrian_steps, pedestrian_steps / interval, remaining_time,
+            usage.ru_maxrss / 1024.0, telemetry.is_terminal ? "" : "\n");
+    fflush(telemetry.stream);
+
+    telemetry.last_report = now;
+    telemetry.last_progress = progress;
+    telemetry.last_sets = telemetry.sets;
+    telemetry.last_replicas = telemetry.replicas;
+    telemetry.last_pedestrian_steps = telemetry.pedestrian_steps;
+}
+
+/**
+ * Calculates the fraction of the run already done, counting the finalized replicas of the current simulation set.
+ *
+ * @return The fraction, between 0 and 1.
+*/
+static double get_run_progress()
+{
+    if(telemetry.set_quantity <= 0)
+        return 0;
+
+    double set_fraction = cli_args.num_simulations > 0 ? (double) telemetry.replicas_in_set / cli_args.num_simulations : 0;
+    if(set_fraction > 1)
+        set_fraction = 1;
+
+    double progress = (telemetry.sets + set_fraction) / telemetry.set_quantity;
+
+    return progress < 1 ? progress : 1;
+}
+
+/**
+ * Writes a duration as hours, minutes and seconds (e.g. 1h02m03s, 2m03s or 3s).
+ *
+ * @param buffer String where the duration will be written (at least 32 characters).
+ * @param seconds Duration, in seconds.
+*/
+static void format_duration(char *buffer, double seconds)
+{
+    long total = seconds < 1e9 ? (long) (seconds + 0.5) : 999999999L;
+
+    if(total >= 3600)
+        sprintf(buffer, "%ldh%02ldm%02lds", total / 3600, total / 60 % 60, total % 60);
+    else if(total >= 60)
+        sprintf(buffer, "%ldm%02lds", total / 60, total % 60);
+    else
+        sprintf(buffer, "%lds", total);
+}
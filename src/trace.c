@@ -0,0 +1,129 @@
+/*
+   File: trace.c
+   Author: Daniel Gonçalves
+   Date: 2026-10-18
+   Description: This module writes the timeline of the run, enabled by --trace, as a trace-event JSON file (array format), which can be opened by chrome://tracing and by Perfetto. Spans are written as soon as they end, by the thread that ran them.
+*/
+
+#include<stdio.h>
+#include<string.h>
+#include<unistd.h>
+
+#include"../headers/trace.h"
+#include"../headers/initialization.h"
+#include"../headers/cli_processing.h"
+#include"../headers/shared_resources.h"
+
+long trace_events = 0;
+
+static FILE *trace_file = NULL;
+static uint64_t trace_start; // Clock reading that corresponds to the timestamp 0 of the trace.
+static int trace_pid;
+
+static bool claim_trace_event();
+
+/**
+ * Creates the trace file in the output directory and writes the name of the process and of the main thread.
+ *
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+*/
+Function_Status start_trace()
+{
+    if(!cli_args.trace)
+        return SUCCESS;
+
+    char complete_path[300];
+    sprintf(complete_path, "%s%s", output_path, cli_args.trace_filename);
+
+    trace_file = fopen(complete_path, "w");
+    if(trace_file == NULL)
+    {
+        fprintf(stderr, "It was not possible to open the trace file.\n");
+        return FAILURE;
+    }
+
+    trace_start = read_profile_clock();
+    trace_pid = (int) getpid();
+    trace_events = 0;
+
+    // Each event after this one starts with a comma, so events written by different threads never need to be joined.
+    fprintf(trace_file, "[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":0,\"args\":{\"name\":\"varas\"}}", trace_pid);
+    name_trace_thread(0);
+
+    return SUCCESS;
+}
+
+/**
+ * Writes a complete span, from the given start until now.
+ *
+ * @note Each event is written by a single fprintf, which locks the stream, so spans can be written by any thread.
+ *
+ * @param name Name of the span.
+ * @param category Category of the span (set, replica, floor field, output or timestep).
+ * @param thread_index Thread of the parallel engine that ran the span (0 for the main thread).
+ * @param start Clock reading at the beginning of the span (see trace_clock).
+ * @param argument_name Name of a single argument shown with the span, or NULL.
+ * @param argument_value Value of the argument.
+*/
+void write_trace_span(const char *name, const char *category, int thread_index, uint64_t start, const char *argument_name, long argument_value)
+{
+    if(trace_file == NULL)
+        return;
+
+    uint64_t end = read_profile_clock();
+    if(!claim_trace_event())
+        return;
+
+    if(argument_name != NULL)
+        fprintf(trace_file, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3lf,\"dur\":%.3lf,\"pid\":%d,\"tid\":%d,\"args\":{\"%s\":%ld}}",
+                name, category, (start - trace_start) / 1e3, (end - start) / 1e3, trace_pid, thread_index, argument_name, argument_value);
+    else
+        fprintf(trace_file, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3lf,\"dur\":%.3lf,\"pid\":%d,\"tid\":%d}",
+                name, category, (start - trace_start) / 1e3, (end - start) / 1e3, trace_pid, thread_index);
+}
+
+/**
+ * Names the track of a thread of the parallel engine (the thread 0 is the main thread).
+ *
+ * @param thread_index Index of the thread.
+*/
+void name_trace_thread(int thread_index)
+{
+    if(trace_file == NULL || !claim_trace_event())
+        return;
+
+    fprintf(trace_file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}", trace_pid, thread_index, thread_index);
+}
+
+/**
+ * Ends the list of events and closes the trace file. A note is added if events were dropped by TRACE_EVENT_LIMIT.
+ *
+ * @note A trace file left without its closing bracket (as when the program fails) can still be opened.
+*/
+void finish_trace()
+{
+    if(trace_file == NULL)
+        return;
+
+    if(trace_events > TRACE_EVENT_LIMIT)
+        fprintf(trace_file, ",\n{\"name\":\"trace truncated after %d events\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%.3lf,\"pid\":%d,\"tid\":0}",
+                TRACE_EVENT_LIMIT, (read_profile_clock() - trace_start) / 1e3, trace_pid);
+
+    fprintf(trace_file, "\n]\n");
+    fclose(trace_file);
+    trace_file = NULL;
+}
+
+/* ---------------- ---------------- ---------------- ---------------- ---------------- */
+/* ---------------- ---------------- STATIC FUNCTIONS ---------------- ---------------- */
+/* ---------------- ---------------- ---------------- ---------------- ---------------- */
+
+/**
+ * Claims the right to write one more event, keeping the trace within TRACE_EVENT_LIMIT events.
+ *
+ * @return bool, where True indicates that the event can be written and False that it must be dropped.
+*/
+static bool claim_trace_event()
+{
+    return __atomic_fetch_add(&trace_events, 1, __ATOMIC_RELAXED) < TRACE_EVENT_LIMIT;
+}
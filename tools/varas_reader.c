@@ -0,0 +1,458 @@
+/*
+   File: varas_reader.c
+   Author: Daniel Gonçalves
+   Date: 2026-10-18
+   Description: Reader of the binary output of the simulator (--output-format 4). Converts a binary file to the text of the output formats 2 (timesteps) and 3 (heatmaps), byte for byte as the simulator would have written them, or to CSV, and prints a summary of its header. The layout of the files is described in headers/binary_output.h.
+   Usage: varas_reader.exe BINARY-FILE [--format=2|3|timesteps-csv|heatmap-csv|info] [--output=FILE]
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<stdint.h>
+#include<stdbool.h>
+#include<inttypes.h>
+
+#include"../headers/binary_output.h"
+
+enum Reader_Format {
+    READER_TIMESTEPS = 2,
+    READER_HEATMAP = 3,
+    READER_TIMESTEPS_CSV,
+    READER_HEATMAP_CSV,
+    READER_INFO
+};
+
+typedef struct{
+    int flags;
+    int lines;
+    int columns;
+    int num_simulations;
+    char *command;
+    uint64_t environment_hash;
+}Binary_Header;
+
+typedef struct{
+    int set_position;
+    bool is_inaccessible;
+    int num_exits;
+    int num_exit_integers;
+    int32_t *exits; // The width of each exit followed by the line and column of its cells.
+    int num_replicas;
+    int32_t *timesteps;
+    int32_t *heatmap; // Visits of each cell, line by line. Only read for accessible sets.
+}Set_Record;
+
+static const char *input_filename = NULL;
+static const char *output_filename = NULL;
+static enum Reader_Format format = READER_TIMESTEPS;
+
+static Function_Status parse_options(int argc, char **argv);
+static Function_Status read_header(FILE *binary_file, Binary_Header *header);
+static int read_set(FILE *binary_file, const Binary_Header *header, Set_Record *record);
+static Function_Status read_integers(FILE *binary_file, int32_t *destination, long quantity);
+static void print_set(FILE *output_file, const Binary_Header *header, const Set_Record *record);
+static void print_exits(FILE *output_file, const Set_Record *record);
+
+int main(int argc, char **argv)
+{
+    if(parse_options(argc, argv) == FAILURE)
+        return EXIT_FAILURE;
+
+    FILE *binary_file = fopen(input_filename, "rb");
+    if(binary_file == NULL)
+    {
+        fprintf(stderr, "It was not possible to open the binary file: %s.\n", input_filename);
+        return EXIT_FAILURE;
+    }
+
+    FILE *output_file = stdout;
+    if(output_filename != NULL)
+    {
+        output_file = fopen(output_filename, "w");
+        if(output_file == NULL)
+        {
+            fprintf(stderr, "It was not possible to open the output file: %s.\n", output_filename);
+            fclose(binary_file);
+            return EXIT_FAILURE;
+        }
+    }
+
+    Binary_Header header;
+    if(read_header(binary_file, &header) == FAILURE)
+        return EXIT_FAILURE;
+
+    Set_Record record = {0};
+    record.timesteps = malloc(sizeof(int32_t) * header.num_simulations);
+    record.heatmap = malloc(sizeof(int32_t) * (size_t) header.lines * header.columns);
+    if(record.timesteps == NULL || record.heatmap == NULL)
+    {
+        fprintf(stderr, "Failure in the allocation of a simulation set of %d x %d cells.\n", header.lines, header.columns);
+        return EXIT_FAILURE;
+    }
+
+    if(format == READER_TIMESTEPS || format == READER_HEATMAP)
+        fprintf(output_file, "%s\n--------------------------------------------------------------\n\n", header.command);
+    else if(format == READER_TIMESTEPS_CSV)
+        fprintf(output_file, "set,replica,timesteps\n");
+    else if(format == READER_HEATMAP_CSV)
+        fprintf(output_file, "set,line,column,visits,mean_visits\n");
+
+    int num_sets = 0, num_inaccessible_sets = 0;
+    long num_replicas = 0;
+    int status;
+    while((status = read_set(binary_file, &header, &record)) == 1)
+    {
+        num_sets++;
+        num_inaccessible_sets += record.is_inaccessible;
+        num_replicas += record.num_replicas;
+        print_set(output_file, &header, &record);
+    }
+
+    if(format == READER_INFO)
+    {
+        fprintf(output_file, "Command: %s\n", header.command);
+        fprintf(output_file, "Environment: %d x %d cells, hash %016" PRIx64 ".\n", header.lines, header.columns, header.environment_hash);
+        fprintf(output_file, "Simulation sets: %d (%d with inaccessible exits), %d simulations per set, %ld replicas.\n", num_sets,
+                num_inaccessible_sets, header.num_simulations, num_replicas);
+        fprintf(output_file, "Heatmaps: %s.\n", header.flags & BINARY_COMPRESSED ? "compressed" : "not compressed");
+    }
+
+    fclose(binary_file);
+    if(output_file != stdout)
+        fclose(output_file);
+    free(record.exits);
+    free(record.timesteps);
+    free(record.heatmap);
+    free(header.command);
+
+    return status == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * Reads the arguments of the reader: the binary file and the options, given as --name=value.
+ *
+ * @param argc Number of arguments.
+ * @param argv Arguments of the program.
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+*/
+static Function_Status parse_options(int argc, char **argv)
+{
+    for(int argument_index = 1; argument_index < argc; argument_index++)
+    {
+        char *argument = argv[argument_index];
+
+        if(strncmp(argument, "--format=", 9) == 0)
+        {
+            char *value = argument + 9;
+            if(strcmp(value, "2") == 0)
+                format = READER_TIMESTEPS;
+            else if(strcmp(value, "3") == 0)
+                format = READER_HEATMAP;
+            else if(strcmp(value, "timesteps-csv") == 0)
+                format = READER_TIMESTEPS_CSV;
+            else if(strcmp(value, "heatmap-csv") == 0)
+                format = READER_HEATMAP_CSV;
+            else if(strcmp(value, "info") == 0)
+                format = READER_INFO;
+            else
+            {
+                fprintf(stderr, "Invalid format: %s. The formats are 2, 3, timesteps-csv, heatmap-csv and info.\n", value);
+                return FAILURE;
+            }
+        }
+        else if(strncmp(argument, "--output=", 9) == 0)
+            output_filename = argument + 9;
+        else if(strncmp(argument, "--", 2) == 0)
+        {
+            fprintf(stderr, "Unknown option: %s.\n", argument);
+            return FAILURE;
+        }
+        else if(input_filename == NULL)
+            input_filename = argument;
+        else
+        {
+            fprintf(stderr, "Only one binary file can be read, but %s was also given.\n", argument);
+            return FAILURE;
+        }
+    }
+
+    if(input_filename == NULL)
+    {
+        fprintf(stderr, "Usage: varas_reader.exe BINARY-FILE [--format=2|3|timesteps-csv|heatmap-csv|info] [--output=FILE]\n");
+        return FAILURE;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * Reads and validates the header of a binary file.
+ *
+ * @param binary_file The binary file, at its beginning.
+ * @param header Where the fields of the header are stored.
+ * @return Function_Status: FAILURE (0) or SUCCESS (1).
+*/
+static Function_Status read_header(FILE *binary_file, Binary_Header *header)
+{
+    char magic[BINARY_MAGIC_LENGTH];
+    int32_t fields[6];
+
+    if(fread(magic, 1, BINARY_MAGIC_LENGTH, binary_file) != BINARY_MAGIC_LENGTH || memcmp(magic, BINARY_MAGIC, BINARY_MAGIC_LENGTH) != 0)
+    {
+        fprintf(stderr, "%s is not a binary output of the simulator.\n", input_filename);
+        return FAILURE;
+    }
+
+    if(read_integers(binary_file, fields, 6) == FAILURE)
+        return FAILURE;
+
+    if(fields[0] != BINARY_VERSION)
+    {
+        fprintf(stderr, "Version %d of the binary output isn't supported (only version %d).\n", fields[0], BINARY_VERSION);
+        return FAILURE;
+    }
+
+    header->flags = fields[1];
+    header->lines = fields[2];
+    header->columns = fields[3];
+    header->num_simulations = fields[4];
+    if(header->lines <= 0 || header->columns <= 0 || header->num_simulations <= 0 || fields[5] < 0)
+    {
+        fprintf(stderr, "The header of %s is corrupted.\n", input_filename);
+        return FAILURE;
+    }
+
+    header->command = malloc(fields[5] + 1);
+    if(header->command == NULL || fread(header->command, 1, fields[5], binary_file) != (size_t) fields[5] ||
+       fread(&header->environment_hash, sizeof(uint64_t), 1, binary_file) != 1)
+    {
+        fprintf(stderr, "The header of %s is truncated.\n", input_filename);
+        return FAILURE;
+    }
+    header->command[fields[5]] = '\0';
+
+    return SUCCESS;
+}
+
+/**
+ * Reads the record of the next simulation set, decoding its heatmap.
+ *
+ * @param binary_file The binary file, at the beginning of a record or at its end.
+ * @param header Header of the file.
+ * @param record Where the simulation set is stored. Its lists must hold the simulations and cells given by the header.
+ * @return 1 if a record was read, 0 at the end of the file or -1 if the record is corrupted.
+*/
+static int read_set(FILE *binary_file, const Binary_Header *header, Set_Record *record)
+{
+    int32_t fields[4];
+
+    if(fread(fields, sizeof(int32_t), 1, binary_file) != 1)
+        return 0;
+
+    if(fields[0] != BINARY_RECORD_SET || read_integers(binary_file, fields + 1, 3) == FAILURE)
+    {
+        fprintf(stderr, "A record of %s is corrupted.\n", input_filename);
+        return -1;
+    }
+    record->set_position = fields[1];
+    record->is_inaccessible = fields[2] != 0;
+    record->num_exits = fields[3];
+
+    // The exits are read one width (and its cells) at a time.
+    record->num_exit_integers = 0;
+    for(int exit_index = 0; exit_index < record->num_exits; exit_index++)
+    {
+        int32_t width;
+        if(read_integers(binary_file, &width, 1) == FAILURE)
+            return -1;
+        if(width <= 0 || width > (long) header->lines * header->columns)
+        {
+            fprintf(stderr, "The exits of a simulation set of %s are corrupted.\n", input_filename);
+            return -1;
+        }
+
+        int32_t *exits = realloc(record->exits, sizeof(int32_t) * (record->num_exit_integers + 1 + 2 * width));
+        if(exits == NULL)
+        {
+            fprintf(stderr, "Failure in the allocation of the exits of a simulation set.\n");
+            return -1;
+        }
+        record->exits = exits;
+        record->exits[record->num_exit_integers++] = width;
+        if(read_integers(binary_file, record->exits + record->num_exit_integers, 2 * width) == FAILURE)
+            return -1;
+        record->num_exit_integers += 2 * width;
+    }
+
+    int32_t num_replicas;
+    if(read_integers(binary_file, &num_replicas, 1) == FAILURE || num_replicas < 0 || num_replicas > header->num_simulations ||
+       read_integers(binary_file, record->timesteps, num_replicas) == FAILURE)
+    {
+        fprintf(stderr, "The timesteps of a simulation set of %s are corrupted.\n", input_filename);
+        return -1;
+    }
+    record->num_replicas = num_replicas;
+
+    if(record->is_inaccessible)
+        return 1;
+
+    long num_cells = (long) header->lines * header->columns;
+    for(long first_cell = 0; first_cell < num_cells; first_cell += HEATMAP_BLOCK_CELLS)
+    {
+        int block_cells = num_cells - first_cell < HEATMAP_BLOCK_CELLS ? num_cells - first_cell : HEATMAP_BLOCK_CELLS;
+        int32_t block_fields[2];
+        static int32_t block[2 * HEATMAP_BLOCK_CELLS];
+
+        if(read_integers(binary_file, block_fields, 2) == FAILURE || block_fields[1] < 0 || block_fields[1] > 2 * HEATMAP_BLOCK_CELLS ||
+           read_integers(binary_file, block, block_fields[1]) == FAILURE)
+        {
+            fprintf(stderr, "A heatmap block of %s is corrupted.\n", input_filename);
+            return -1;
+        }
+
+        int decoded_cells = 0;
+        if(block_fields[0] == BLOCK_RAW && block_fields[1] == block_cells)
+        {
+            memcpy(record->heatmap + first_cell, block, sizeof(int32_t) * block_cells);
+            decoded_cells = block_cells;
+        }
+        else if(block_fields[0] == BLOCK_RUNS && block_fields[1] % 2 == 0)
+        {
+            for(int run = 0; run < block_fields[1]; run += 2)
+            {
+                if(block[run] <= 0 || block[run] > block_cells - decoded_cells)
+                {
+                    fprintf(stderr, "A heatmap block of %s is corrupted.\n", input_filename);
+                    return -1;
+                }
+
+                for(int cell = 0; cell < block[run]; cell++)
+                    record->heatmap[first_cell + decoded_cells++] = block[run + 1];
+            }
+        }
+
+        if(decoded_cells != block_cells)
+        {
+            fprintf(stderr, "A heatmap block of %s doesn't have %d cells.\n", input_filename, block_cells);
+            return -1;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * Reads 32-bit integers from the binary file.
+ *
+ * @param binary_file The binary file.
+ * @param destination Where the integers are stored.
+ * @param quantity Number of integers to be read.
+ * @return Function_Status: FAILURE (0), if the file ends before them, or SUCCESS (1).
+*/
+static Function_Status read_integers(FILE *binary_file, int32_t *destination, long quantity)
+{
+    if(quantity > 0 && fread(destination, sizeof(int32_t), quantity, binary_file) != (size_t) quantity)
+    {
+        fprintf(stderr, "%s is truncated.\n", input_filename);
+        return FAILURE;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * Prints a simulation set in the chosen format. The text formats reproduce print_simulation_set_information, the "#1 " flag,
+ * print_placeholder, the timesteps and print_heatmap of the simulator.
+ *
+ * @param output_file Stream where the data will be written.
+ * @param header Header of the binary file.
+ * @param record The simulation set.
+*/
+static void print_set(FILE *output_file, const Binary_Header *header, const Set_Record *record)
+{
+    switch(format)
+    {
+        case READER_TIMESTEPS:
+            if(header->flags & BINARY_SIMULATION_SET_INFO)
+                print_exits(output_file, record);
+
+            if(record->is_inaccessible)
+            {
+                for(int replica = 0; replica < header->num_simulations; replica++)
+                    fprintf(output_file, "%d ", -1);
+            }
+            else
+            {
+                if((header->flags & BINARY_SINGLE_EXIT_FLAG) && record->num_exits == 1)
+                    fprintf(output_file, "#1 ");
+                for(int replica = 0; replica < record->num_replicas; replica++)
+                    fprintf(output_file, "%d ", record->timesteps[replica]);
+            }
+            fprintf(output_file, "\n");
+            break;
+        case READER_HEATMAP:
+            if(header->flags & BINARY_SIMULATION_SET_INFO)
+                print_exits(output_file, record);
+
+            if(record->is_inaccessible)
+            {
+                fprintf(output_file, "At least one exit from the simulation set is inaccessible.\n");
+                break;
+            }
+
+            for(int i = 0; i < header->lines; i++)
+            {
+                for(int h = 0; h < header->columns; h++)
+                    fprintf(output_file, "%.2lf ", (double) record->heatmap[(long) i * header->columns + h] / (double) header->num_simulations);
+                fprintf(output_file, "\n");
+            }
+            fprintf(output_file, "\n");
+            break;
+        case READER_TIMESTEPS_CSV:
+            if(record->is_inaccessible)
+            {
+                for(int replica = 0; replica < header->num_simulations; replica++)
+                    fprintf(output_file, "%d,%d,-1\n", record->set_position, replica + 1);
+            }
+            for(int replica = 0; replica < record->num_replicas; replica++)
+                fprintf(output_file, "%d,%d,%d\n", record->set_position, replica + 1, record->timesteps[replica]);
+            break;
+        case READER_HEATMAP_CSV:
+            // Only the visited cells are written.
+            for(long cell = 0; ! record->is_inaccessible && cell < (long) header->lines * header->columns; cell++)
+            {
+                if(record->heatmap[cell] != 0)
+                    fprintf(output_file, "%d,%ld,%ld,%d,%.2lf\n", record->set_position, cell / header->columns, cell % header->columns,
+                            record->heatmap[cell], (double) record->heatmap[cell] / (double) header->num_simulations);
+            }
+            break;
+        case READER_INFO:
+            break;
+    }
+}
+
+/**
+ * Prints the exits of a simulation set, as print_simulation_set_information does.
+ *
+ * @param output_file Stream where the data will be written.
+ * @param record The simulation set.
+*/
+static void print_exits(FILE *output_file, const Set_Record *record)
+{
+    int position = 0;
+
+    fprintf(output_file, "Simulation set:");
+    for(int exit_index = 0; exit_index < record->num_exits; exit_index++)
+    {
+        char separator = exit_index == record->num_exits - 1 ? '.' : ',';
+        int width = record->exits[position++];
+
+        for(int cell_index = 0; cell_index < width; cell_index++)
+        {
+            fprintf(output_file, " %d %d%c", record->exits[position], record->exits[position + 1], cell_index == width - 1 ? separator : '+');
+            position += 2;
+        }
+    }
+    fprintf(output_file, "\n");
+}
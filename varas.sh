@@ -1,3 +1,3 @@
 #!/bin/bash
 
-gcc -o build/varas.exe src/*.c -lm -Wall && ./build/varas.exe "$@"
\ No newline at end of file
+gcc -O2 -o build/varas.exe src/*.c -lm -pthread -Wall && ./build/varas.exe "$@"
\ No newline at end of file
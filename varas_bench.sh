@@ -0,0 +1,190 @@
+#!/bin/bash
+
+# Builds the program and runs a fixed-seed benchmark suite over synthetic environments (grid sizes, crowd sizes, exit counts
+# and toggle combinations), writing the results to output/bench/ as CSV, one line per scenario.
+# Usage: ./varas_bench.sh [--full] [--repeats=N] [--filter=PATTERN]
+#        ./varas_bench.sh --compare BASELINE.csv CANDIDATE.csv
+# The quick suite (default) takes a few minutes; --full adds environments up to 4096x4096.
+# Each scenario is run N times (default is 3) and the run with the median time is reported. The timesteps and
+# pedestrian-steps of a scenario only depend on its seed, so a difference between two commits means their behavior changed.
+
+# Prints the provided text in the given color.
+# $1 Sequence code of the chosen color.
+# $2 The string to be printed.
+print_in_color()
+{
+    echo -e "$1$2\033[0m"
+}
+
+# Writes an auxiliary file with a single simulation set, with exits of 2 cells spread evenly over the top and bottom walls.
+# $1 Number of lines.
+# $2 Number of columns.
+# $3 Number of exits.
+# $4 Name of the auxiliary file.
+write_auxiliary_file()
+{
+    awk -v lines="$1" -v columns="$2" -v exits="$3" 'BEGIN {
+        set = "";
+        top_exits = int((exits + 1) / 2);
+        for(exit_index = 0; exit_index < exits; exit_index++)
+        {
+            wall = exit_index % 2;
+            line = wall == 0 ? 0 : lines - 1;
+            wall_exits = wall == 0 ? top_exits : exits - top_exits;
+            column = int((int(exit_index / 2) + 1) * columns / (wall_exits + 1));
+            if(column < 1)
+                column = 1;
+            if(column > columns - 3)
+                column = columns - 3;
+            if(set != "")
+                set = set ", ";
+            set = set line " " column "+ " line " " column + 1;
+        }
+        print set ".";
+    }' > "auxiliary/$4"
+}
+
+# Prints the value of a field of the profile or memory reports.
+# $1 Report file.
+# $2 awk program that prints the field.
+read_report()
+{
+    awk "$2" "$1" 2> /dev/null
+}
+
+# Compares two result files, printing the ratio candidate / baseline of the rates, of the floor field time and of the memory,
+# and flagging the scenarios whose timesteps differ.
+# $1 Baseline CSV.
+# $2 Candidate CSV.
+compare_results()
+{
+    awk -F, 'FNR == 1 { next }
+        NR == FNR { steps[$2] = $10; rate[$2] = $14; field[$2] = $15; memory[$2] = $16; next }
+        {
+            if(!($2 in rate))
+                next;
+            if(!header)
+            {
+                printf "%-28s %14s %14s %12s %s\n", "scenario", "ped-upd/s", "field time", "peak alloc", "";
+                header = 1;
+            }
+            note = steps[$2] != $10 ? "timesteps differ (" steps[$2] " -> " $10 ")" : "";
+            # The comparisons are in parentheses, as printf would take > as a redirection.
+            printf "%-28s %13.3fx %13.3fx %11.3fx %s\n", $2, (rate[$2] > 0 ? $14 / rate[$2] : 0),
+                   (field[$2] > 0 ? $15 / field[$2] : 0), (memory[$2] > 0 ? $16 / memory[$2] : 0), note;
+        }' "$1" "$2"
+}
+
+if [ "$1" == "--compare" ]; then
+    if [ $# -ne 3 ]; then
+        echo "Usage: ./varas_bench.sh --compare BASELINE.csv CANDIDATE.csv"
+        exit 1
+    fi
+    compare_results "$2" "$3"
+    exit 0
+fi
+
+tier="quick"
+repeats=3
+filter=""
+for argument in "$@"; do
+    case "$argument" in
+        --full) tier="full" ;;
+        --repeats=*) repeats=${argument#*=} ;;
+        --filter=*) filter=${argument#*=} ;;
+        *) echo "Unknown argument: $argument"; exit 1 ;;
+    esac
+done
+
+threads=$(nproc)
+[ "$threads" -gt 4 ] && threads=4
+
+# name:LINESxCOLUMNS:PEDESTRIANS:EXITS:SIMULATIONS:OPTIONS (options separated by spaces).
+scenarios=(
+    "tiny:16x20:50:1:40:"
+    "tiny_x_movement:16x20:50:1:40:--allow-x-movement"
+    "tiny_immediate:16x20:50:1:40:--immediate-exit --always-to-lowest"
+    "small:64x64:800:2:10:"
+    "small_dijkstra:64x64:800:2:10:--floor-field-solver=2"
+    "small_corners:64x64:800:2:10:--avoid-corner-movement"
+    "small_dense:64x64:2400:2:10:"
+    "small_batch:64x64:800:2:16:--batch=8"
+    "medium:256x256:6000:4:2:--floor-field-solver=2"
+    "medium_exits_16:256x256:6000:16:2:--floor-field-solver=2"
+    "medium_iterative:256x256:6000:4:2:"
+    "medium_threads:256x256:6000:4:2:--floor-field-solver=2 --threads=$threads"
+    "medium_batch:256x256:6000:4:8:--floor-field-solver=2 --batch=8"
+    "medium_tiled:256x256:6000:4:2:--floor-field-solver=2 --grid-layout=2"
+)
+if [ "$tier" == "full" ]; then
+    scenarios+=(
+        "large:1024x1024:100000:8:1:--floor-field-solver=2"
+        "large_threads:1024x1024:100000:8:1:--floor-field-solver=2 --threads=$threads"
+        "large_compressed:1024x1024:100000:8:1:--floor-field-solver=2 --exit-fields=3"
+        "huge:4096x4096:400000:16:1:--floor-field-solver=2 --exit-fields=2"
+    )
+fi
+
+gcc -O2 -o build/varas.exe src/*.c -lm -pthread -Wall || exit 1
+
+commit=$(git rev-parse --short HEAD 2> /dev/null || echo "unknown")
+[ -n "$(git status --porcelain --untracked-files=no 2> /dev/null)" ] && commit="$commit-dirty"
+cpu=$(awk -F': ' '/model name/ { print $2; exit }' /proc/cpuinfo | tr -d ',')
+
+mkdir -p output/bench
+results="output/bench/bench_${commit}_${tier}.csv"
+auxiliary_name="varas_bench.txt"
+
+echo "commit,scenario,lines,columns,pedestrians,exits,simulations,options,run_s,timesteps,pedestrian_steps,simulation_s,steps_per_s,pedestrian_updates_per_s,field_s,peak_alloc_mb,peak_rss_mb,cpu" > "$results"
+
+print_in_color "\033[0;32m" "Varas Benchmark Suite ($tier, commit $commit)!"
+printf "%-22s %-10s %-8s %-6s %-10s %-12s %-14s %-10s %-10s\n" "scenario" "grid" "peds" "exits" "time (s)" "steps/s" "ped-upd/s" "field (s)" "RSS (MB)"
+
+for scenario in "${scenarios[@]}"; do
+    IFS=':' read -r name dimensions num_pedestrians num_exits num_simulations options <<< "$scenario"
+    if [ -n "$filter" ] && [[ "$name" != *$filter* ]]; then
+        continue
+    fi
+
+    lines=${dimensions%%x*}
+    columns=${dimensions##*x}
+    write_auxiliary_file "$lines" "$columns" "$num_exits" "$auxiliary_name"
+
+    runs=()
+    for (( run = 0; run < repeats; run++ )); do
+        # shellcheck disable=SC2086 # The options are split on purpose.
+        ./build/varas.exe -m5 -l"$lines" -c"$columns" -a"$auxiliary_name" -obench_output.txt -O2 -p"$num_pedestrians" \
+            -s"$num_simulations" --seed=1 --profile=bench_profile.txt --mem-report=bench_memory.txt $options > /dev/null 2>&1
+        if [ $? -ne 0 ]; then
+            print_in_color "\033[0;31m" "The scenario $name failed."
+            continue 2
+        fi
+
+        run_s=$(read_report output/bench_profile.txt '/^Profile:/ { print $2 }')
+        timesteps=$(read_report output/bench_profile.txt '/^Profile:/ { print $4 }')
+        pedestrian_steps=$(read_report output/bench_profile.txt '/^Profile:/ { print $6 }')
+        field_s=$(read_report output/bench_profile.txt '/^floor field/ { print $3 }')
+        peak_alloc=$(read_report output/bench_memory.txt '/^Memory:/ { print $4 }')
+        peak_rss=$(read_report output/bench_memory.txt '/^Memory:/ { print $(NF - 1) }')
+        runs+=("$run_s $timesteps $pedestrian_steps ${field_s:-0} $peak_alloc $peak_rss")
+    done
+
+    # The run with the median time.
+    read -r run_s timesteps pedestrian_steps field_s peak_alloc peak_rss <<< "$(printf "%s\n" "${runs[@]}" | sort -g | awk '{ line[NR] = $0 } END { print line[int((NR + 1) / 2)] }')"
+
+    awk -v commit="$commit" -v name="$name" -v lines="$lines" -v columns="$columns" -v peds="$num_pedestrians" -v exits="$num_exits" \
+        -v simulations="$num_simulations" -v options="$options" -v run_s="$run_s" -v steps="$timesteps" -v ped_steps="$pedestrian_steps" \
+        -v field_s="$field_s" -v peak_alloc="$peak_alloc" -v peak_rss="$peak_rss" -v cpu="$cpu" -v results="$results" 'BEGIN {
+            simulation_s = run_s - field_s;
+            if(simulation_s <= 0)
+                simulation_s = 1e-9;
+            printf "%s,%s,%d,%d,%d,%d,%d,%s,%.3f,%d,%d,%.3f,%.1f,%.1f,%.3f,%.3f,%.3f,%s\n", commit, name, lines, columns, peds, exits,
+                   simulations, options, run_s, steps, ped_steps, simulation_s, steps / simulation_s, ped_steps / simulation_s, field_s,
+                   peak_alloc, peak_rss, cpu >> results;
+            printf "%-22s %-10s %-8d %-6d %-10.3f %-12.1f %-14.4g %-10.3f %-10.1f\n", name, lines "x" columns, peds, exits, run_s,
+                   steps / simulation_s, ped_steps / simulation_s, field_s, peak_rss;
+        }'
+done
+
+rm -f "auxiliary/$auxiliary_name" output/bench_output.txt output/bench_profile.txt output/bench_memory.txt
+print_in_color "\033[0;34m" "Results written to $results."
@@ -0,0 +1,275 @@
+#!/bin/bash
+
+# Verifies that the engines and options that must not change the results of the simulation still reproduce the golden
+# outputs in tests/equivalence/, recorded by the regular execution on the scenarios of the Varas figures (varas_experiments.sh)
+# and on dense crowds where many X movements are blocked.
+# Usage: ./varas_equivalence.sh [--engine=PATTERN] [--scenario=PATTERN]
+#        ./varas_equivalence.sh --update
+# Engines that use the same random draws as the regular execution must reproduce the timesteps and heatmaps exactly. Engines
+# with their own random number generators (--threads and --batch) are compared by a two-sample Kolmogorov-Smirnov test over the
+# timesteps of all replicas of a scenario, and their heatmaps by heatmap_test. The script exits with status 1 if any comparison fails, so a new engine is only
+# made selectable once it is added to the list below and passes.
+# --update rewrites the golden outputs with the current build, after a change that is meant to alter the results.
+
+# Prints the provided text in the given color.
+# $1 Sequence code of the chosen color.
+# $2 The string to be printed.
+print_in_color()
+{
+    echo -e "$1$2\033[0m"
+}
+
+# Runs a scenario and writes its output, without the header (the full command), to the given file.
+# Engines with -O4 write the binary output, which is converted to the text of the given format by the reader.
+# $1 Options of the scenario.
+# $2 Output format (O2 for the timesteps, O3 for the heatmaps).
+# $3 Options of the engine.
+# $4 File where the output is written.
+run_scenario()
+{
+    if [[ " $3 " == *" -O4 "* ]]; then
+        # shellcheck disable=SC2086 # The options are split on purpose.
+        ./build/varas.exe $1 $3 -oequivalence_output.bin > /dev/null 2>&1 || return 1
+        ./build/varas_reader.exe output/equivalence_output.bin --format="${2#O}" --output=output/equivalence_output.txt || return 1
+    else
+        # shellcheck disable=SC2086
+        ./build/varas.exe $1 -"$2" $3 -oequivalence_output.txt > /dev/null 2>&1 || return 1
+    fi
+    tail -n +4 output/equivalence_output.txt > "$4"
+}
+
+# Two-sample Kolmogorov-Smirnov test over the timesteps of two -O2 outputs (inaccessible sets, printed as -1, are ignored).
+# Prints the statistic D and its critical value for a significance level of 0.001, and fails if D exceeds it.
+# $1 Golden output.
+# $2 Output of the engine.
+ks_test()
+{
+    awk 'NR == FNR { for(i = 1; i <= NF; i++) if($i >= 0) { golden[$i]++; num_golden++; update_range($i) } next }
+         { for(i = 1; i <= NF; i++) if($i >= 0) { candidate[$i]++; num_candidate++; update_range($i) } }
+         function update_range(value) {
+             if(!has_range || value < minimum) minimum = value;
+             if(!has_range || value > maximum) maximum = value;
+             has_range = 1;
+         }
+         END {
+             if(num_golden == 0 || num_candidate == 0)
+             {
+                 printf "no replicas";
+                 exit 1;
+             }
+             # The timesteps are integers, so the empirical distributions only change at integer values.
+             for(value = minimum; value <= maximum; value++)
+             {
+                 golden_cumulative += golden[value] / num_golden;
+                 candidate_cumulative += candidate[value] / num_candidate;
+                 difference = golden_cumulative - candidate_cumulative;
+                 if(difference < 0)
+                     difference = -difference;
+                 if(difference > statistic)
+                     statistic = difference;
+             }
+             critical = 1.949 * sqrt((num_golden + num_candidate) / (num_golden * num_candidate));
+             printf "D = %.4f, critical = %.4f, %d vs %d replicas", statistic, critical, num_golden, num_candidate;
+             exit (statistic > critical);
+         }' "$1" "$2"
+}
+
+# Compares the heatmaps (-O3) of an engine with their own random number generators with the golden heatmaps. Each value is the
+# mean number of visits of a cell per replica, so the difference of the means of each visited cell is divided by its standard
+# error, as if the visits were Poisson counts, and the root mean square of these deviations is taken over all cells. The visits
+# are not Poisson counts, so the deviation is only compared with the one of the null golden output (the regular execution at
+# the seed HEATMAP_NULL_SEED, an independent sample of the same distribution), and fails if it exceeds it HEATMAP_TOLERANCE times.
+# $1 Golden output.
+# $2 Null golden output.
+# $3 Output of the engine.
+# $4 Number of replicas of each simulation set.
+heatmap_test()
+{
+    awk -v replicas="$4" -v tolerance="$HEATMAP_TOLERANCE" '
+         FNR == 1 { file++; set = 1; line = 0 }
+         NF == 0 { set++; line = 0; next }
+         {
+             line++;
+             cells[file] += NF;
+             for(h = 1; h <= NF; h++)
+             {
+                 if(file == 1)
+                 {
+                     golden[set, line, h] = $h;
+                     continue;
+                 }
+                 if(golden[set, line, h] == 0 && $h == 0)
+                     continue;
+                 deviation = (golden[set, line, h] - $h) / sqrt((golden[set, line, h] + $h) / replicas);
+                 squared_sum[file] += deviation * deviation;
+                 visited[file]++;
+             }
+         }
+         END {
+             if(cells[1] != cells[2] || cells[1] != cells[3])
+             {
+                 printf "%d vs %d cells", cells[1], cells[3];
+                 exit 1;
+             }
+             null_deviation = visited[2] > 0 ? sqrt(squared_sum[2] / visited[2]) : 0;
+             deviation = visited[3] > 0 ? sqrt(squared_sum[3] / visited[3]) : 0;
+             printf "deviation = %.2f, null = %.2f, %d replicas", deviation, null_deviation, replicas;
+             exit (deviation > tolerance * null_deviation);
+         }' "$1" "$2" "$3"
+}
+
+# name:FORMATS:OPTIONS. The heatmaps (O3) of the scenario with thousands of simulation sets aren't stored. The
+# dense_x_blocking scenario (the widest doors, where blocking X movements slows the evacuation the most) doesn't allow X
+# movements and has many replicas, so the statistical tests also cover the blocking rules of the engines.
+scenarios=(
+    "fig_3:O2 O3:-m5 -l16 -c20 -avaras_section_3.txt -p50 -s20 --allow-x-movement"
+    "fig_4:O2 O3:-m5 -l16 -c20 -avaras_section_3.txt -p50 -s20 --diagonal=1 --allow-x-movement"
+    "fig_5:O2 O3:-m5 -l16 -c20 -avaras_section_3.txt -p50 -s20 --diagonal=2 --allow-x-movement"
+    "fig_6:O2 O3:-m5 -l16 -c20 -avaras_door_width.txt -p100 -s20 --allow-x-movement"
+    "fig_6_blocked_x:O2 O3:-m5 -l16 -c20 -avaras_door_width.txt -p100 -s20"
+    "fig_7:O2 O3:-m5 -l16 -c20 -avaras_door_width.txt -p100 -s20 --varas-fig7 --allow-x-movement"
+    "fig_12:O2 O3:-m3 -evaras_classroom_with_obstacles.txt -avaras_optimal_location.txt -s10 --allow-x-movement"
+    "fig_13:O2 O3:-m3 -evaras_classroom_without_obstacles.txt -avaras_door_width.txt -s10 --allow-x-movement"
+    "fig_14:O2 O3:-m3 -evaras_classroom_with_obstacles.txt -avaras_double_doors.txt -s10 --allow-x-movement"
+    "fig_14_corners:O2 O3:-m3 -evaras_classroom_with_obstacles.txt -avaras_double_doors.txt -s10 --avoid-corner-movement"
+    "fig_15:O2:-m3 -evaras_classroom_with_obstacles.txt -avaras_optimal_location-door_combination.txt -s2 --allow-x-movement"
+    "fig_17a:O2 O3:-m3 -evaras_classroom_2_with_obstacles.txt -avaras_optimal_location_2.txt -s10 --allow-x-movement"
+    "fig_17b:O2 O3:-m3 -evaras_classroom_2_with_obstacles.txt -avaras_double_doors.txt -s10 --allow-x-movement"
+    "lowest_immediate_exit:O2 O3:-m3 -evaras_classroom_2_with_obstacles.txt -avaras_double_doors.txt -s10 --always-to-lowest --immediate-exit"
+    "dense_x_blocking:O2 O3:-m5 -l16 -c20 -avaras_door_width.txt -p250 -s300 --sets=10-14"
+)
+
+# name:COMPARISON:OPTIONS. The comparison is exact (with the golden outputs), ks (with the golden outputs) or
+# same=ENGINE (exact, with the outputs of an engine listed before).
+engines=(
+    "reference:exact:"
+    "dijkstra:exact:--floor-field-solver=2"
+    "exit_fields_drop:exact:--exit-fields=2"
+    "exit_fields_compress:exact:--exit-fields=3"
+    "tiled:exact:--grid-layout=2"
+    "huge_pages:exact:--grid-backend=2"
+    "file_backed:exact:--grid-backend=3"
+    "binary_output:exact:-O4"
+    "binary_output_compressed:exact:-O4 --compress-output"
+    "threads_1:ks:--threads=1"
+    "threads_2:same=threads_1:--threads=2"
+    "threads_no_reorder:same=threads_1:--threads=2 --reorder-interval=0"
+    "batch:ks:--batch=4"
+)
+
+golden_directory="tests/equivalence"
+HEATMAP_NULL_SEED=1000000 # Far from the default seed, as the simulations of a set use consecutive seeds.
+HEATMAP_TOLERANCE=1.5
+update=false
+engine_filter=""
+scenario_filter=""
+for argument in "$@"; do
+    case "$argument" in
+        --update) update=true ;;
+        --engine=*) engine_filter=${argument#*=} ;;
+        --scenario=*) scenario_filter=${argument#*=} ;;
+        *) echo "Unknown argument: $argument"; exit 1 ;;
+    esac
+done
+
+gcc -O2 -o build/varas.exe src/*.c -lm -pthread -Wall || exit 1
+gcc -O2 -o build/varas_reader.exe tools/varas_reader.c -Wall || exit 1
+
+if [ "$update" == true ]; then
+    mkdir -p "$golden_directory"
+    print_in_color "\033[0;32m" "Recording the golden outputs in $golden_directory."
+    for scenario in "${scenarios[@]}"; do
+        IFS=':' read -r name formats options <<< "$scenario"
+        for format in $formats; do
+            if ! run_scenario "$options" "$format" "" "$golden_directory/$name.$format.txt"; then
+                print_in_color "\033[0;31m" "The scenario $name failed."
+                exit 1
+            fi
+
+            if [ "$format" == "O3" ] && ! run_scenario "$options" "$format" "--seed=$HEATMAP_NULL_SEED" "$golden_directory/$name.$format.null.txt"; then
+                print_in_color "\033[0;31m" "The scenario $name failed at the seed $HEATMAP_NULL_SEED."
+                exit 1
+            fi
+        done
+    done
+    rm -f output/equivalence_output.txt
+    exit 0
+fi
+
+print_in_color "\033[0;32m" "Varas Equivalence Tests!"
+failures=0
+checks=0
+
+for engine in "${engines[@]}"; do
+    IFS=':' read -r engine_name comparison engine_options <<< "$engine"
+    if [ -n "$engine_filter" ] && [[ "$engine_name" != *$engine_filter* ]]; then
+        continue
+    fi
+
+    print_in_color "\033[0;34m" "Engine $engine_name ($comparison${engine_options:+, $engine_options})."
+    engine_directory="output/equivalence/$engine_name"
+    mkdir -p "$engine_directory"
+
+    for scenario in "${scenarios[@]}"; do
+        IFS=':' read -r name formats options <<< "$scenario"
+        if [ -n "$scenario_filter" ] && [[ "$name" != *$scenario_filter* ]]; then
+            continue
+        fi
+
+        for format in $formats; do
+            golden="$golden_directory/$name.$format.txt"
+            output="$engine_directory/$name.$format.txt"
+            if [ ! -f "$golden" ]; then
+                print_in_color "\033[0;31m" "  $name.$format: there is no golden output (run with --update)."
+                failures=$((failures + 1))
+                continue
+            fi
+
+            checks=$((checks + 1))
+            if ! run_scenario "$options" "$format" "$engine_options" "$output"; then
+                print_in_color "\033[0;31m" "  $name.$format: the program failed."
+                failures=$((failures + 1))
+                continue
+            fi
+
+            case "$comparison" in
+                exact)
+                    cmp -s "$golden" "$output" && result="identical" || result="differs from $golden" ;;
+                same=*)
+                    expected="output/equivalence/${comparison#same=}/$name.$format.txt"
+                    if [ ! -f "$expected" ]; then
+                        print_in_color "\033[0;33m" "  $name.$format: skipped, ${comparison#same=} wasn't run."
+                        checks=$((checks - 1))
+                        continue
+                    fi
+                    cmp -s "$expected" "$output" && result="identical" || result="differs from $expected" ;;
+                ks)
+                    if [ "$format" == "O3" ]; then
+                        [[ " $options" =~ \ -s([0-9]+) ]] && replicas=${BASH_REMATCH[1]}
+                        result=$(heatmap_test "$golden" "$golden_directory/$name.$format.null.txt" "$output" "$replicas") &&
+                            result="equivalent ($result)" || result="not equivalent ($result)"
+                    else
+                        result=$(ks_test "$golden" "$output") && result="equivalent ($result)" || result="not equivalent ($result)"
+                    fi ;;
+            esac
+
+            if [[ "$result" == identical* || "$result" == equivalent* ]]; then
+                echo "  $name.$format: $result."
+            else
+                print_in_color "\033[0;31m" "  $name.$format: $result."
+                failures=$((failures + 1))
+            fi
+        done
+    done
+done
+
+rm -f output/equivalence_output.txt output/equivalence_output.bin
+
+if [ $failures -gt 0 ]; then
+    print_in_color "\033[0;31m" "$failures of $checks comparisons failed. The outputs are in output/equivalence/."
+    exit 1
+fi
+
+rm -rf output/equivalence
+
+print_in_color "\033[0;32m" "All $checks comparisons passed."
@@ -0,0 +1,35 @@
+#!/bin/bash
+
+# Builds and runs the microbenchmarks of the hot kernels (benchmarks/microbench.c), each timed in isolation on a synthetic
+# environment, and appends the results to output/bench/microbench_COMMIT.csv.
+# Usage: ./varas_microbench.sh [--lines=N] [--columns=N] [--pedestrians=N] [--exits=N] [--repetitions=N] [--warm-up=N]
+#                              [--seed=N] [--kernel=PATTERN]
+# The defaults are a 256x256 environment with 3000 pedestrians and 4 exits, 50 repetitions and 5 warm-up runs.
+
+# Prints the provided text in the given color.
+# $1 Sequence code of the chosen color.
+# $2 The string to be printed.
+print_in_color()
+{
+    echo -e "$1$2\033[0m"
+}
+
+# The kernels are linked with every module except the main function of the program.
+sources=$(ls src/*.c | grep -v "src/main.c")
+# shellcheck disable=SC2086 # The sources are split on purpose.
+gcc -O2 -o build/varas_microbench.exe benchmarks/microbench.c $sources -lm -pthread -Wall || exit 1
+
+commit=$(git rev-parse --short HEAD 2> /dev/null || echo "unknown")
+[ -n "$(git status --porcelain --untracked-files=no 2> /dev/null)" ] && commit="$commit-dirty"
+
+mkdir -p output/bench
+results="output/bench/microbench_${commit}.csv"
+[ -f "$results" ] || echo "kernel,lines,columns,pedestrians,exits,repetitions,median_us,p10_us,p90_us,p99_us,min_us,median_ns_per_item" > "$results"
+
+print_in_color "\033[0;32m" "Varas Microbenchmarks (commit $commit)!"
+./build/varas_microbench.exe --csv="$results" "$@"
+status=$?
+
+rm -f environments/microbench_environment.txt
+[ $status -eq 0 ] && print_in_color "\033[0;34m" "Results appended to $results."
+exit $status
@@ -0,0 +1,79 @@
+#!/bin/bash
+
+# Runs a single simulation on large automatically created environments and reports the time per timestep.
+# Usage: ./varas_scale_benchmark.sh [LINESxCOLUMNS:PEDESTRIANS ...]
+# Example (million-pedestrian scale): ./varas_scale_benchmark.sh 10000x10000:1000000
+
+# Prints the provided text in the given color.
+# $1 Sequence code of the chosen color.
+# $2 The string to be printed.
+print_in_color()
+{
+    echo -e "$1$2\033[0m"
+}
+
+# Writes an auxiliary file with a single simulation set, with exits of 4 cells every 100 cells of the top and bottom walls.
+# $1 Number of lines.
+# $2 Number of columns.
+# $3 Name of the auxiliary file.
+write_auxiliary_file()
+{
+    awk -v lines="$1" -v columns="$2" 'BEGIN {
+        set = "";
+        for(wall = 0; wall < 2; wall++)
+        {
+            line = wall == 0 ? 0 : lines - 1;
+            for(column = 50; column + 4 < columns - 1; column += 100)
+            {
+                if(set != "")
+                    set = set ", ";
+                set = set line " " column "+ " line " " column + 1 "+ " line " " column + 2 "+ " line " " column + 3;
+            }
+        }
+        if(set == "")
+            set = "0 1";
+        print set ".";
+    }' > "auxiliary/$3"
+}
+
+scales=("$@")
+if [ ${#scales[@]} -eq 0 ]; then
+    scales=("500x500:25000" "1000x1000:100000" "2000x2000:400000")
+fi
+
+gcc -O2 -o build/varas.exe src/*.c -lm -pthread -Wall || exit 1
+
+auxiliary_name="varas_scale_benchmark.txt"
+output_name="varas_scale_benchmark.txt"
+print_in_color "\033[0;32m" "Varas Scale Benchmark!"
+printf "%-12s %-12s %-10s %-10s %-12s %-14s %-10s\n" "cells" "pedestrians" "timesteps" "time (s)" "ms/timestep" "ns/ped/step" "peak (MB)"
+
+for scale in "${scales[@]}"; do
+    dimensions=${scale%%:*}
+    num_pedestrians=${scale##*:}
+    lines=${dimensions%%x*}
+    columns=${dimensions##*x}
+
+    write_auxiliary_file "$lines" "$columns" "$auxiliary_name"
+
+    start=$(date +%s.%N)
+    ./build/varas.exe -m5 -l"$lines" -c"$columns" -a"$auxiliary_name" -o"$output_name" -O2 -p"$num_pedestrians" \
+        --floor-field-solver=2 > /dev/null 2>&1 &
+    pid=$!
+    peak_kb=0
+    while kill -0 $pid 2> /dev/null; do
+        # VmHWM never decreases, so the last sample is the peak resident memory (up to the sampling interval).
+        sample=$(awk '/VmHWM/ { print $2 }' /proc/$pid/status 2> /dev/null)
+        [ -n "$sample" ] && peak_kb=$sample
+        sleep 0.2
+    done
+    wait $pid
+    end=$(date +%s.%N)
+
+    timesteps=$(awk 'NF { last = $NF } END { print last }' "output/$output_name")
+    awk -v cells="$((lines * columns))" -v peds="$num_pedestrians" -v steps="$timesteps" -v start="$start" -v end="$end" -v peak_kb="$peak_kb" \
+        'BEGIN { time = end - start; printf "%-12d %-12d %-10d %-10.2f %-12.3f %-14.1f %-10.1f\n",
+                 cells, peds, steps, time, 1000 * time / steps, 1e9 * time / (steps * peds), peak_kb / 1024 }'
+done
+
+rm -f "auxiliary/$auxiliary_name" "output/$output_name"
@@ -0,0 +1,145 @@
+#!/bin/bash
+
+# Measures how a fixed experiment (the door combination sweep of the Varas figure 15, at a reduced number of simulations)
+# scales with the threads of the parallel engine (--threads) and with processes that each run a range of its simulation sets
+# (--sets). Reports the speedup over the regular execution, the efficiency, the idle time of each worker and whether the
+# results are identical to the ones of the regular execution and of a single worker. The results are written to
+# output/bench/scaling_COMMIT.csv, one line per configuration.
+# Usage: ./varas_thread_scaling.sh [--max-workers=N] [--simulations=N]
+# The default is one to nproc workers (at least 2), with 2 simulations per simulation set.
+# With --threads, the idle time of a thread is the time it waited for the other threads at the barriers between the phases
+# (from the --profile report). With processes, it is the time between the end of its range and the end of the slowest one.
+
+# Prints the provided text in the given color.
+# $1 Sequence code of the chosen color.
+# $2 The string to be printed.
+print_in_color()
+{
+    echo -e "$1$2\033[0m"
+}
+
+# Prints the difference, in seconds, between two readings of date +%s.%N.
+# $1 Start.
+# $2 End.
+elapsed()
+{
+    awk -v start="$1" -v end="$2" 'BEGIN { printf "%.3f", end - start }'
+}
+
+# Prints the line of results and appends it to the CSV file.
+# $1 Mode (serial, threads or processes).
+# $2 Number of workers.
+# $3 Time, in seconds.
+# $4 Time of a single worker of the same mode, in seconds.
+# $5 Idle time of each worker, as a percentage of the time, separated by spaces.
+# $6 yes if the results are identical to the ones of the regular execution.
+# $7 yes if the results are identical to the ones of a single worker of the same mode.
+report()
+{
+    awk -v commit="$commit" -v mode="$1" -v workers="$2" -v time="$3" -v serial_time="$serial_time" -v one_worker_time="$4" \
+        -v idle="$5" -v identical_serial="$6" -v identical_one="$7" -v cpu="$cpu" -v results="$results" 'BEGIN {
+            speedup = time > 0 ? serial_time / time : 0;
+            num_idle = split(idle, idle_shares, " ");
+            idle_sum = 0;
+            idle_max = 0;
+            for(worker = 1; worker <= num_idle; worker++)
+            {
+                idle_sum += idle_shares[worker];
+                if(idle_shares[worker] > idle_max)
+                    idle_max = idle_shares[worker];
+            }
+            idle_mean = num_idle > 0 ? idle_sum / num_idle : 0;
+            sub(/ +$/, "", idle);
+            gsub(" ", ";", idle);
+            # The comparisons are in parentheses, as printf would take > as a redirection.
+            printf "%s,%s,%d,%.3f,%.3f,%.3f,%.3f,%.1f,%.1f,%s,%s,%s,%s\n", commit, mode, workers, time, speedup, speedup / workers,
+                   (time > 0 ? one_worker_time / time : 0), idle_mean, idle_max, idle, identical_serial, identical_one, cpu >> results;
+            printf "%-10s %-8d %-10.3f %-9.2f %-11.1f %-11.1f %-11.1f %-11s %s\n", mode, workers, time, speedup, 100 * speedup / workers,
+                   idle_mean, idle_max, identical_serial, identical_one;
+        }'
+}
+
+max_workers=$(nproc)
+[ "$max_workers" -lt 2 ] && max_workers=2
+num_simulations=2
+for argument in "$@"; do
+    case "$argument" in
+        --max-workers=*) max_workers=${argument#*=} ;;
+        --simulations=*) num_simulations=${argument#*=} ;;
+        *) echo "Unknown argument: $argument"; exit 1 ;;
+    esac
+done
+
+experiment="-m3 -evaras_classroom_with_obstacles.txt -avaras_optimal_location-door_combination.txt -O2 -s$num_simulations --allow-x-movement"
+num_sets=$(awk 'NF { sets++ } END { print sets }' auxiliary/varas_optimal_location-door_combination.txt)
+
+gcc -O2 -o build/varas.exe src/*.c -lm -pthread -Wall || exit 1
+
+commit=$(git rev-parse --short HEAD 2> /dev/null || echo "unknown")
+[ -n "$(git status --porcelain --untracked-files=no 2> /dev/null)" ] && commit="$commit-dirty"
+cpu=$(awk -F': ' '/model name/ { print $2; exit }' /proc/cpuinfo | tr -d ',')
+
+mkdir -p output/bench output/scaling
+results="output/bench/scaling_${commit}.csv"
+echo "commit,mode,workers,time_s,speedup,efficiency,speedup_vs_one_worker,mean_idle_pct,max_idle_pct,idle_pct_per_worker,identical_to_serial,identical_to_one_worker,cpu" > "$results"
+
+print_in_color "\033[0;32m" "Varas Thread Scaling Benchmark (commit $commit, $num_sets simulation sets, $(nproc) processors)!"
+printf "%-10s %-8s %-10s %-9s %-11s %-11s %-11s %-11s %s\n" "mode" "workers" "time (s)" "speedup" "effic. (%)" "idle (%)" "max idle" "= serial" "= 1 worker"
+
+# The outputs are compared without their header, which holds the command line.
+start=$(date +%s.%N)
+# shellcheck disable=SC2086 # The options are split on purpose.
+./build/varas.exe $experiment -oscaling/serial.txt > /dev/null 2>&1 || exit 1
+end=$(date +%s.%N)
+serial_time=$(elapsed "$start" "$end")
+tail -n +4 output/scaling/serial.txt > output/scaling/serial_body.txt
+report "serial" 1 "$serial_time" "$serial_time" "0" "yes" "yes"
+
+for (( workers = 1; workers <= max_workers; workers++ )); do
+    start=$(date +%s.%N)
+    # shellcheck disable=SC2086
+    ./build/varas.exe $experiment --threads=$workers --profile=scaling/threads_profile.txt -oscaling/threads.txt > /dev/null 2>&1 || exit 1
+    end=$(date +%s.%N)
+    time=$(elapsed "$start" "$end")
+    [ $workers -eq 1 ] && one_thread_time=$time
+
+    tail -n +4 output/scaling/threads.txt > output/scaling/threads_body_$workers.txt
+    idle=$(awk '$1 == "thread" { in_threads = 1; next } in_threads && NF == 3 { sub("%", "", $3); printf "%s ", $3 }' output/scaling/threads_profile.txt)
+    cmp -s output/scaling/serial_body.txt output/scaling/threads_body_$workers.txt && identical_serial="yes" || identical_serial="no"
+    cmp -s output/scaling/threads_body_1.txt output/scaling/threads_body_$workers.txt && identical_one="yes" || identical_one="no"
+    report "threads" "$workers" "$time" "$one_thread_time" "$idle" "$identical_serial" "$identical_one"
+done
+
+for (( workers = 1; workers <= max_workers; workers++ )); do
+    pids=()
+    start=$(date +%s.%N)
+    for (( shard = 0; shard < workers; shard++ )); do
+        first_set=$(( shard * num_sets / workers + 1 ))
+        last_set=$(( (shard + 1) * num_sets / workers ))
+        (
+            # shellcheck disable=SC2086
+            ./build/varas.exe $experiment --sets=$first_set-$last_set -oscaling/shard_$shard.txt > /dev/null 2>&1 || exit 1
+            date +%s.%N > output/scaling/shard_$shard.end
+        ) &
+        pids+=($!)
+    done
+
+    for pid in "${pids[@]}"; do
+        wait "$pid" || exit 1
+    done
+    end=$(date +%s.%N)
+    time=$(elapsed "$start" "$end")
+    [ $workers -eq 1 ] && one_process_time=$time
+
+    : > output/scaling/processes_body.txt
+    idle=""
+    for (( shard = 0; shard < workers; shard++ )); do
+        tail -n +4 output/scaling/shard_$shard.txt >> output/scaling/processes_body.txt
+        idle="$idle$(awk -v start="$start" -v end="$end" '{ idle_share = end > start ? 100 * (end - $1) / (end - start) : 0; printf "%.1f ", idle_share }' output/scaling/shard_$shard.end)"
+    done
+    cmp -s output/scaling/serial_body.txt output/scaling/processes_body.txt && identical_serial="yes" || identical_serial="no"
+    report "processes" "$workers" "$time" "$one_process_time" "$idle" "$identical_serial" "$identical_serial"
+done
+
+rm -rf output/scaling
+print_in_color "\033[0;34m" "Results written to $results."